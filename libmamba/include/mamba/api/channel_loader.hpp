@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "mamba/core/error_handling.hpp"
+#include "mamba/core/repodata_prefilter.hpp"
 #include "mamba/solver/libsolv/repo_info.hpp"
 #include "mamba/specs/package_info.hpp"
 #include "mamba/specs/version.hpp"
@@ -97,6 +98,9 @@ namespace mamba
      * @param root_packages When non-empty and use_sharded_repodata is true, use sharded
      *                      repodata to load only reachable packages from these roots (faster for
      *                      install/update).
+     * @param python_minor_version_for_prefilter Python minor used to prefilter shard records.
+     * @param prefilter Prefilter of all the records, from shards or full repodata.
+     *                  Full repodata is filtered once loaded, so that caches stay complete.
      */
     auto load_channels(
         Context& ctx,
@@ -104,9 +108,19 @@ namespace mamba
         solver::libsolv::Database& database,
         MultiPackageCache& package_caches,
         const std::vector<std::string>& root_packages = {},
-        std::optional<specs::Version> python_minor_version_for_prefilter = std::nullopt
+        std::optional<specs::Version> python_minor_version_for_prefilter = std::nullopt,
+        const RepodataPrefilter& prefilter = {}
     ) -> expected_t<void, mamba_aggregated_error>;
 
+    /**
+     * The settings, besides the channels, that change the packages loaded by ``load_channels``.
+     *
+     * Databases loaded from the same channels with the same key have the same packages.
+     */
+    [[nodiscard]] auto
+    channel_loading_key(const Context& ctx, const solver::libsolv::Database& database)
+        -> std::string;
+
     /* Brief Creates channels and mirrors objects,
      * but does not load channels.
      *
@@ -16,6 +16,8 @@ namespace mamba
     const int MAMBA_CLEAN_LOCKS = 1 << 4;
     const int MAMBA_CLEAN_TRASH = 1 << 5;
     const int MAMBA_CLEAN_FORCE_PKGS_DIRS = 1 << 6;
+    /** Move package folders to the trash of their cache and remove them in the background. */
+    const int MAMBA_CLEAN_MOVE_TO_TRASH = 1 << 7;
 
     class Configuration;
     void clean(Configuration& config, int options);
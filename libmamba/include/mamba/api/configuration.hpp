@@ -474,7 +474,19 @@ namespace mamba
 
         std::vector<fs::u8path> m_sources;
         std::vector<fs::u8path> m_valid_sources;
-        std::map<fs::u8path, YAML::Node> m_rc_yaml_nodes_cache;
+        /** The rc files found at each searched location during the current load. */
+        std::map<fs::u8path, std::vector<fs::u8path>> m_rc_locations_cache;
+
+        /** Top level values of a rc file, by key. */
+        using rc_values_index = std::map<std::string, YAML::Node, std::less<>>;
+
+        /**
+         * The non-null values of the rc files parsed during the current load.
+         *
+         * Indexing them once avoids probing every rc file for every configurable, which
+         * dominates loading the configuration with ``YAML::Node::operator[]``.
+         */
+        std::map<fs::u8path, rc_values_index> m_rc_yaml_nodes_cache;
 
         bool m_load_lock = false;
 
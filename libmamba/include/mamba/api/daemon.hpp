@@ -0,0 +1,100 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#ifndef MAMBA_API_DAEMON_HPP
+#define MAMBA_API_DAEMON_HPP
+
+#include <chrono>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json_fwd.hpp>
+
+#include "mamba/api/repoquery.hpp"
+#include "mamba/core/query.hpp"
+#include "mamba/fs/filesystem.hpp"
+#include "mamba/solver/request.hpp"
+#include "mamba/solver/solution.hpp"
+#include "mamba/specs/package_info.hpp"
+
+namespace mamba
+{
+    class Configuration;
+    class Context;
+
+    struct DaemonOptions
+    {
+        /** The socket to listen on, @ref daemon_socket_path if empty. */
+        fs::u8path socket_path = {};
+        /** How often the channels repodata is reloaded. */
+        std::chrono::seconds refresh_interval = std::chrono::minutes(5);
+    };
+
+    inline constexpr int daemon_protocol_version = 2;
+
+    /** The default socket of the daemon for the current user and root prefix. */
+    [[nodiscard]] auto daemon_socket_path(const Context& ctx) -> fs::u8path;
+
+    /**
+     * Run a long-lived process keeping the channels repodata loaded in a solver database.
+     *
+     * The daemon listens on a local Unix socket and answers one JSON request per
+     * connection until interrupted, either a repoquery or the solve of a request.
+     * The socket lives in a directory private to the user, and connections from other
+     * users are rejected.
+     * Requests carry the channel configuration of the client and are rejected when it
+     * differs from the one of the daemon, in which case clients do the work themselves.
+     * The repodata is reloaded in the background, using the subdir cache so that only
+     * the indexes whose cache expired are downloaded again.
+     *
+     * The configuration is loaded by this function.
+     * Only supported on Unix systems.
+     */
+    void run_daemon(Configuration& config, const DaemonOptions& options);
+
+    /**
+     * Send a request to the daemon listening on ``socket_path``.
+     *
+     * Return nothing if no daemon is listening, if the socket or the daemon do not belong to
+     * the current user, or if the communication failed.
+     */
+    [[nodiscard]] auto
+    daemon_request(const fs::u8path& socket_path, const nlohmann::json& request)
+        -> std::optional<nlohmann::json>;
+
+    /**
+     * Run a repoquery in the daemon, writing the result to ``out``.
+     *
+     * Return nothing, without writing anything, if the daemon is not available or cannot
+     * serve this request.
+     * The JSON format is not supported as it is written through the console.
+     */
+    [[nodiscard]] auto daemon_repoquery(
+        const Context& ctx,
+        QueryType type,
+        QueryResultFormat format,
+        const std::vector<std::string>& queries,
+        std::ostream& out
+    ) -> std::optional<bool>;
+
+    /**
+     * Solve a request in the daemon, with the given packages as the installed repository.
+     *
+     * The request is solved as is, with its flags, pins and virtual packages.
+     * Return nothing if the daemon is not available, cannot serve this request, or if the
+     * request is unsolvable, in which case the problems are best explained by a local solve.
+     */
+    [[nodiscard]] auto daemon_solve(
+        const Context& ctx,
+        const solver::Request& request,
+        const std::vector<specs::PackageInfo>& installed,
+        const std::vector<specs::PackageInfo>& virtual_packages
+    ) -> std::optional<solver::Solution>;
+}
+
+#endif
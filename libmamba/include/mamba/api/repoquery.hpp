@@ -4,6 +4,9 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#ifndef MAMBA_API_REPOQUERY_HPP
+#define MAMBA_API_REPOQUERY_HPP
+
 #include <iosfwd>
 #include <string>
 #include <vector>
@@ -40,3 +43,4 @@ namespace mamba
         const std::vector<std::string>& query
     ) -> bool;
 }
+#endif
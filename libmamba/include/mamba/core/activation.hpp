@@ -7,6 +7,7 @@
 #ifndef MAMBA_CORE_ACTIVATION_HPP
 #define MAMBA_CORE_ACTIVATION_HPP
 
+#include <map>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -37,6 +38,44 @@ namespace mamba
         std::vector<fs::u8path> deactivate_scripts;
     };
 
+    /**
+     * The parts of an activation that only depend on the content of a prefix.
+     *
+     * Scripts are listed regardless of their extension, they are filtered for a given shell
+     * when rendering the activation.
+     */
+    struct ActivationPlan
+    {
+        /** Environment variables from ``etc/conda/env_vars.d`` then ``conda-meta/state``. */
+        std::vector<std::pair<std::string, std::string>> env_vars;
+        /** The files of ``etc/conda/env_vars.d``, sorted. */
+        std::vector<fs::u8path> env_vars_files;
+        /** The files of ``etc/conda/activate.d``, sorted. */
+        std::vector<fs::u8path> activate_scripts;
+        /** The files of ``etc/conda/deactivate.d``, reverse sorted. */
+        std::vector<fs::u8path> deactivate_scripts;
+        /** Problems found while reading the environment variables, logged on every load. */
+        std::vector<std::string> warnings;
+    };
+
+    /**
+     * Compute the activation plan of a prefix.
+     *
+     * If @p cache_dir is not empty, the plan is read from and written to a cache file in this
+     * directory.
+     * The cached plan is reused as long as the size and modification time of its inputs are
+     * unchanged, which only requires a few ``stat`` calls.
+     */
+    auto load_activation_plan(const fs::u8path& prefix, const fs::u8path& cache_dir = {})
+        -> ActivationPlan;
+
+    /**
+     * The default directory of the activation plan cache, in the user cache directory.
+     *
+     * Empty, thus disabling the cache, when the user has no cache directory.
+     */
+    auto activation_plan_cache_dir() -> fs::u8path;
+
     class Activator
     {
     public:
@@ -54,6 +93,9 @@ namespace mamba
         virtual std::string shell_extension() = 0;
         virtual std::string shell() = 0;
 
+        /** The activation plan of a prefix, loaded at most once per activator. */
+        const ActivationPlan& get_activation_plan(const fs::u8path& prefix);
+
         std::vector<fs::u8path> get_activate_scripts(const fs::u8path& prefix);
         std::vector<fs::u8path> get_deactivate_scripts(const fs::u8path& prefix);
 
@@ -102,6 +144,7 @@ namespace mamba
         ActivationType m_action;
 
         std::unordered_map<std::string, std::string> m_env;
+        std::map<fs::u8path, ActivationPlan> m_plans;
     };
 
     class PosixActivator : public Activator
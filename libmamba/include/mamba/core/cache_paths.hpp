@@ -14,6 +14,7 @@ namespace mamba::cache_paths
     inline constexpr std::string_view conda_pkgs_relative = "conda/pkgs";
     inline constexpr std::string_view cache_relative = "cache";
     inline constexpr std::string_view cache_shards_relative = "cache/shards";
+    inline constexpr std::string_view cache_pyc_relative = "cache/pyc";
 }  // namespace mamba::cache_paths
 
 #endif
@@ -112,6 +112,7 @@ namespace mamba
         std::optional<std::string> env_lockfile;
 
         bool use_index_cache = false;
+        bool use_solution_cache = false;
         std::size_t local_repodata_ttl = 1;  // take from header
         bool offline = false;
 
@@ -268,6 +269,7 @@ namespace mamba
         std::size_t repodata_shards_ttl = 86400;
         // 0 means: auto (use process-affinity-based concurrency).
         std::size_t repodata_shards_threads = 0;
+        bool use_database_snapshot = false;
 
         // FIXME: Should not be stored here
         // Notice that we cannot build this map directly from mirrored_channels,
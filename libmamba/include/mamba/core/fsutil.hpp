@@ -7,14 +7,16 @@
 #ifndef MAMBA_CORE_FS_UTIL
 #define MAMBA_CORE_FS_UTIL
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <system_error>
+#include <vector>
+
+#include "mamba/fs/filesystem.hpp"
 
 namespace mamba
 {
-    namespace fs
-    {
-        class u8path;
-    }
 
     namespace path
     {
@@ -44,6 +46,50 @@ namespace mamba
          */
         void rename_or_move(const fs::u8path& from, const fs::u8path& to, std::error_code& ec);
 
+        struct DirectoryWalkOptions
+        {
+            /** Directories for which this returns true are neither walked nor counted. */
+            std::function<bool(const fs::u8path&)> skip_directory = {};
+            /** Directories for which this returns true are reported with their total size. */
+            std::function<bool(const fs::u8path&)> collect_directory = {};
+            /** Files for which this returns true are reported with their size. */
+            std::function<bool(const fs::u8path&)> collect_file = {};
+            /** The number of threads walking the directories, all cores if zero. */
+            std::size_t max_threads = 0;
+        };
+
+        struct DirectoryWalkEntry
+        {
+            fs::u8path path;
+            /** The size of the file, or of all the regular files below the directory. */
+            std::uintmax_t size = 0;
+            bool is_directory = false;
+        };
+
+        /**
+         * Walk the directories below ``roots`` in a single pass, on a pool of threads.
+         *
+         * Every directory is listed once, and the sizes of the collected directories are
+         * aggregated from the ones of their subdirectories.
+         * Symbolic links are neither followed nor counted, and directories that cannot be
+         * listed are ignored.
+         * The predicates of ``options`` are called concurrently from the walking threads.
+         *
+         * @return The collected files and directories, sorted by path.
+         */
+        [[nodiscard]] auto
+        walk_directories(const std::vector<fs::u8path>& roots, const DirectoryWalkOptions& options)
+            -> std::vector<DirectoryWalkEntry>;
+
+        /**
+         * Recursively remove ``paths`` on a pool of threads.
+         *
+         * @param max_threads The number of removal threads, all cores if zero.
+         * @return The paths that could not be removed.
+         */
+        [[nodiscard]] auto
+        remove_all_parallel(const std::vector<fs::u8path>& paths, std::size_t max_threads = 0)
+            -> std::vector<fs::u8path>;
     }
 }
 #endif
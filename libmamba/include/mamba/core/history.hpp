@@ -7,6 +7,7 @@
 #ifndef MAMBA_CORE_HISTORY
 #define MAMBA_CORE_HISTORY
 
+#include <cstddef>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -52,9 +53,23 @@ namespace mamba
         std::vector<ParseResult> parse();
         bool parse_comment_line(const std::string& line, UserRequest& req);
         std::vector<UserRequest> get_user_requests();
+
+        /**
+         * Return the user requests following the revision ``revision``.
+         *
+         * The offsets of the revisions are read from the history index, a sidecar file
+         * next to the history file, so that only the requested revisions are parsed.
+         * The index is updated first with the entries appended to the history by other
+         * tools, and rebuilt if the history file was truncated.
+         */
+        std::vector<UserRequest> get_user_requests_after(std::size_t revision);
+
         std::unordered_map<std::string, specs::MatchSpec> get_requested_specs_map();
         void add_entry(const History::UserRequest& entry);
 
+        /** The path of the history index of a history file. */
+        static fs::u8path index_file_path(const fs::u8path& history_file_path);
+
         fs::u8path m_prefix;
         fs::u8path m_history_file_path;
         ChannelContext& m_channel_context;
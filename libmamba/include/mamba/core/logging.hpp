@@ -57,6 +57,7 @@
 #define MAMBA_CORE_LOGGING_HPP
 
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <concepts>
 #include <functional>
@@ -80,8 +81,21 @@
 #undef LOG_ERROR
 #undef LOG_CRITICAL
 
+/** Minimum level of the log records kept in the `LOG_...` macros, as a `mamba::log_level` value.
+
+    Log statements of a lower level are compiled to a constant test which the compiler removes.
+    By default all levels are kept and filtered at runtime.
+*/
+#ifndef MAMBA_LOG_COMPILED_LEVEL
+#define MAMBA_LOG_COMPILED_LEVEL 0
+#endif
+
+// The message is only built, and its operands evaluated, if the level is enabled.
 // clang-format off
-#define LOG(severity)   mamba::logging::MessageLogger(severity).stream()
+#define LOG(severity)                                                                              \
+    !mamba::logging::is_enabled(severity)                                                          \
+        ? static_cast<void>(0)                                                                     \
+        : mamba::logging::details::LogVoidify() & mamba::logging::MessageLogger(severity).stream()
 #define LOG_TRACE       LOG(mamba::log_level::trace)
 #define LOG_DEBUG       LOG(mamba::log_level::debug)
 #define LOG_INFO        LOG(mamba::log_level::info)
@@ -947,6 +961,16 @@ namespace mamba
         */
         auto set_flush_threshold(log_level threshold_level) -> void;
 
+        /** @returns `true` if a log record of the specified level would currently be processed.
+
+            This is a single relaxed atomic load, used by the `LOG_...` macros to skip building
+            the messages of the disabled levels.
+            While the backtrace is enabled, all levels are enabled so that the backtrace history
+            can be replayed.
+            This call is thread-safe but the returned value must be considered immediately obsolete.
+        */
+        [[nodiscard]] inline auto is_enabled(log_level level) noexcept -> bool;
+
         ///////////////////////////////////////////////////////
         // MIGHT DISAPPEAR SOON
         class MessageLogger
@@ -981,6 +1005,18 @@ namespace mamba
 
         namespace details
         {
+            /** Lowest level of the log records which are currently processed. */
+            [[nodiscard]] auto enabled_log_level() noexcept -> const std::atomic<log_level>&;
+
+            /** Turns a `LOG_...` statement into a `void` expression, @see `LOG`. */
+            struct LogVoidify
+            {
+                // Lower precedence than `<<` but higher than `?:`.
+                void operator&(std::ostream&) const noexcept
+                {
+                }
+            };
+
             // NOTE: this looks complicated because it's a workaround for `std::vector`
             // implementations which are not `constexpr` (required by c++20), we defer the vector
             // creation to the moment it's needed. Constexpr constructor is required for a type
@@ -1028,6 +1064,12 @@ namespace mamba::logging
         }
     }
 
+    inline auto is_enabled(log_level level) noexcept -> bool
+    {
+        return (level >= static_cast<log_level>(MAMBA_LOG_COMPILED_LEVEL))
+               and (level >= details::enabled_log_level().load(std::memory_order_relaxed));
+    }
+
     // as thread-safe as handler's implementation
     inline auto log(LogRecord record) -> void
     {
@@ -1045,7 +1087,7 @@ namespace mamba::logging
     // as thread-safe as handler's implementation if set
     inline auto disable_backtrace() -> void
     {
-        call_log_handler_if_existing(&AnyLogHandler::enable_backtrace, 0);
+        enable_backtrace(0);
     }
 
     // as thread-safe as handler's implementation if set
@@ -7,10 +7,19 @@
 #define MAMBA_CORE_LOGGING_TOOLS_HPP
 
 #include <atomic>
+#include <chrono>
 #include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
 #include <deque>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <thread>
 
 #include <fmt/format.h>  // TODO: replace by `<format>` once available on all ci compilers
 
@@ -413,6 +422,185 @@ namespace mamba::logging
 
     static_assert(LogHandler<LogHandler_StdOut>);
 
+    namespace details
+    {
+        /** Bounded lock-free queue with multiple producers and a single consumer.
+
+            Each cell holds a sequence number telling whether it is ready to be written or read
+            (Dmitry Vyukov's bounded queue), so that producers only contend on the write position
+            and never on a lock.
+        */
+        template <std::movable T>
+        class MPSCRingBuffer
+        {
+        public:
+
+            /** The capacity is rounded up to a power of two. */
+            explicit MPSCRingBuffer(std::size_t capacity);
+
+            /** Moves from `value` and returns `true` if there was room, thread-safe. */
+            auto try_push(T& value) -> bool;
+
+            /** Must only be called from one thread at a time. */
+            auto try_pop() -> std::optional<T>;
+
+            [[nodiscard]] auto capacity() const noexcept -> std::size_t;
+
+        private:
+
+            struct Cell
+            {
+                std::atomic<std::size_t> sequence = 0;
+                T value = {};
+            };
+
+            std::unique_ptr<Cell[]> m_cells;
+            std::size_t m_mask = 0;
+            // Separate cache lines for the producers and the consumer
+            alignas(64) std::atomic<std::size_t> m_write_pos = 0;
+            alignas(64) std::size_t m_read_pos = 0;
+        };
+    }
+
+    struct LogHandler_Async_Options  // not nested type because clang and gcc dont like it
+    {
+        /** Number of records waiting for the sink thread, further records are logged
+            synchronously until it catches up.
+        */
+        std::size_t queue_capacity = 4096;
+
+        /** Log records of this level or higher are passed directly to the wrapped handler,
+            after the queued ones, so that they are not delayed.
+        */
+        log_level synchronous_level = log_level::warn;
+    };
+
+    /** `LogHandler` moving the work of another log handler to a background thread.
+
+        Log records are pushed in a lock-free queue consumed by a sink thread which passes
+        them in order to the wrapped handler.
+        Emitting a record is then only the cost of moving it in the queue.
+        All other operations first wait for the queued records to be processed.
+
+        All operations are thread-safe except move operations.
+    */
+    class LogHandler_Async
+    {
+    public:
+
+        using Options = LogHandler_Async_Options;
+
+        /** Constructor taking the wrapped log handler, or a pointer to it, @see `AnyLogHandler`.
+
+            post-condition: `is_started() == false` until `start_log_handler` is called.
+        */
+        template <class T>
+            requires(not std::is_same_v<std::remove_cvref_t<T>, LogHandler_Async>)
+                    and std::constructible_from<AnyLogHandler, T>
+        explicit LogHandler_Async(T&& wrapped, Options options = Options{});
+
+        LogHandler_Async(const LogHandler_Async& other) = delete;
+        LogHandler_Async& operator=(const LogHandler_Async& other) = delete;
+
+        LogHandler_Async(LogHandler_Async&& other) noexcept = default;
+        LogHandler_Async& operator=(LogHandler_Async&& other) noexcept;
+
+        ~LogHandler_Async();
+
+        /** `LogHandler` API implementation, @see mamba::logging::LogHandler for the expected
+           behavior.
+        */
+        ///@{
+        auto start_log_handling(LoggingParams params, std::vector<log_source> sources) -> void;
+        auto stop_log_handling(stop_reason reason) -> void;
+
+        auto set_log_level(log_level new_level) -> void;
+        auto set_params(LoggingParams new_params) -> void;
+
+        auto log(LogRecord record) -> void;
+
+        auto enable_backtrace(size_t record_buffer_size) -> void;
+        auto disable_backtrace() -> void;
+        auto log_backtrace() -> void;
+        auto log_backtrace_no_guards() -> void;
+
+        auto flush(std::optional<log_source> source = {}) -> void;
+
+        auto set_flush_threshold(log_level threshold_level) -> void;
+        ///@}
+
+        /** Waits for all the records logged before this call to be passed to the wrapped
+            handler.
+        */
+        auto wait_for_queue() -> void;
+
+        /** @returns `true` if `start_log_handling` has been called and since that
+            call `stop_log_handling` has not been called yet, `false` otherwise.
+        */
+        auto is_started() const -> bool;
+
+        /** @returns The wrapped log handler, not thread-safe. */
+        auto wrapped() -> AnyLogHandler&;
+
+        /** @returns The options this log handler has been constructed with. */
+        auto get_options() const -> const Options&
+        {
+            return options;
+        }
+
+    private:
+
+        struct Impl
+        {
+            Impl(AnyLogHandler wrapped_, std::size_t capacity);
+
+            AnyLogHandler wrapped;
+            details::MPSCRingBuffer<LogRecord> queue;
+
+            /** Number of records pushed in, and passed out of, the queue. */
+            std::atomic<std::size_t> pushed = 0;
+            std::atomic<std::size_t> processed = 0;
+
+            /** Whether `log` may push records in the queue. */
+            std::atomic<bool> running = false;
+            /** Number of `log` calls which may be pushing a record. */
+            std::atomic<std::size_t> producers = 0;
+            std::atomic<bool> stopping = false;
+            std::atomic<bool> sink_sleeping = false;
+            std::mutex mutex;
+            std::condition_variable records_available;
+            std::condition_variable records_processed;
+            /** Serializes starting and stopping the sink thread. */
+            std::mutex lifecycle_mutex;
+            std::thread sink;
+            /** Id of the sink thread while it runs, readable from any thread. */
+            std::atomic<std::thread::id> sink_id = {};
+
+            auto start_sink() -> void;
+            auto stop_sink(bool process_queue) -> void;
+            /** Body of the sink thread. */
+            auto run_sink() -> void;
+            auto wait_for_queue() -> void;
+            auto wake_sink() -> void;
+        };
+
+        std::unique_ptr<Impl> pimpl;
+        Options options;
+    };
+
+    namespace details
+    {
+        /** Registers a function called when the program exits normally, unless cancelled.
+
+            The functions are called before the destruction of the static objects which
+            were initialized before the registration, so that sink threads can still use them.
+        */
+        auto call_at_exit(const void* key, std::function<void()> func) -> void;
+        auto cancel_call_at_exit(const void* key) -> void;
+    }
+
+    static_assert(LogHandler<LogHandler_Async>);
+
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -727,6 +915,402 @@ namespace mamba::logging
         return pimpl != nullptr;
     }
 
+    //////////////////////////////////////////////////////////////////////////////////////
+
+    template <std::movable T>
+    inline details::MPSCRingBuffer<T>::MPSCRingBuffer(std::size_t capacity)
+    {
+        std::size_t size = 2;
+        while (size < capacity)
+        {
+            size *= 2;
+        }
+        m_cells = std::make_unique<Cell[]>(size);
+        m_mask = size - 1;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    template <std::movable T>
+    inline auto details::MPSCRingBuffer<T>::try_push(T& value) -> bool
+    {
+        auto pos = m_write_pos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            auto& cell = m_cells[pos & m_mask];
+            const auto sequence = cell.sequence.load(std::memory_order_acquire);
+            if (sequence == pos)
+            {
+                // The cell is free, try to claim it
+                if (m_write_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (sequence < pos)
+            {
+                // The cell still holds the value pushed one lap before: the queue is full
+                return false;
+            }
+            else
+            {
+                // Another producer claimed this cell
+                pos = m_write_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    template <std::movable T>
+    inline auto details::MPSCRingBuffer<T>::try_pop() -> std::optional<T>
+    {
+        auto& cell = m_cells[m_read_pos & m_mask];
+        if (cell.sequence.load(std::memory_order_acquire) != m_read_pos + 1)
+        {
+            return std::nullopt;
+        }
+        auto value = std::optional<T>(std::move(cell.value));
+        cell.sequence.store(m_read_pos + m_mask + 1, std::memory_order_release);
+        ++m_read_pos;
+        return value;
+    }
+
+    template <std::movable T>
+    inline auto details::MPSCRingBuffer<T>::capacity() const noexcept -> std::size_t
+    {
+        return m_mask + 1;
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////
+
+    namespace details
+    {
+        struct AtExitCalls
+        {
+            std::mutex mutex;
+            std::map<const void*, std::function<void()>> funcs;
+        };
+
+        inline auto at_exit_calls() -> AtExitCalls&
+        {
+            static AtExitCalls calls;
+            static std::once_flag registered;
+            std::call_once(
+                registered,
+                []
+                {
+                    std::atexit(
+                        []
+                        {
+                            auto funcs = std::map<const void*, std::function<void()>>();
+                            {
+                                auto lock = std::unique_lock(at_exit_calls().mutex);
+                                funcs.swap(at_exit_calls().funcs);
+                            }
+                            for (auto& [key, func] : funcs)
+                            {
+                                func();
+                            }
+                        }
+                    );
+                }
+            );
+            return calls;
+        }
+
+        inline auto call_at_exit(const void* key, std::function<void()> func) -> void
+        {
+            auto& calls = at_exit_calls();
+            auto lock = std::unique_lock(calls.mutex);
+            calls.funcs[key] = std::move(func);
+        }
+
+        inline auto cancel_call_at_exit(const void* key) -> void
+        {
+            auto& calls = at_exit_calls();
+            auto lock = std::unique_lock(calls.mutex);
+            calls.funcs.erase(key);
+        }
+    }
+
+    inline LogHandler_Async::Impl::Impl(AnyLogHandler wrapped_, std::size_t capacity)
+        : wrapped(std::move(wrapped_))
+        , queue(capacity)
+    {
+    }
+
+    inline auto LogHandler_Async::Impl::start_sink() -> void
+    {
+        auto lifecycle_lock = std::lock_guard(lifecycle_mutex);
+        if (sink.joinable())
+        {
+            return;
+        }
+        stopping = false;
+        sink = std::thread([this] { run_sink(); });
+        sink_id = sink.get_id();
+        running = true;
+        // Pass the remaining records to the wrapped handler while it can still use the
+        // static objects it relies on, for instance when `exit` is called.
+        details::call_at_exit(this, [this] { stop_sink(true); });
+    }
+
+    inline auto LogHandler_Async::Impl::stop_sink(bool process_queue) -> void
+    {
+        auto lifecycle_lock = std::lock_guard(lifecycle_mutex);
+        if (not sink.joinable())
+        {
+            return;
+        }
+        details::cancel_call_at_exit(this);
+        // New records are logged synchronously, the ones being pushed must reach the queue
+        // before it is processed for the last time.
+        running = false;
+        while (producers.load() != 0)
+        {
+            std::this_thread::yield();
+        }
+        if (process_queue)
+        {
+            wait_for_queue();
+        }
+        {
+            auto lock = std::unique_lock(mutex);
+            stopping = true;
+        }
+        records_available.notify_one();
+        sink.join();
+        sink_id = std::thread::id();
+    }
+
+    inline auto LogHandler_Async::Impl::run_sink() -> void
+    {
+        using namespace std::chrono_literals;
+
+        std::size_t processed_count = processed.load();
+        while (true)
+        {
+            while (not stopping.load(std::memory_order_acquire))
+            {
+                auto record = queue.try_pop();
+                if (not record)
+                {
+                    break;
+                }
+                wrapped.log(std::move(*record));
+                processed.store(++processed_count, std::memory_order_release);
+            }
+
+            // Notify under the lock so that waiters cannot miss the notification
+            auto lock = std::unique_lock(mutex);
+            records_processed.notify_all();
+            if (stopping.load(std::memory_order_acquire))
+            {
+                return;
+            }
+            if (pushed.load(std::memory_order_acquire) != processed_count)
+            {
+                // A producer claimed a cell but did not fill it yet
+                lock.unlock();
+                std::this_thread::yield();
+                continue;
+            }
+            sink_sleeping = true;
+            // Producers do not lock: a missed notification only delays the sink
+            records_available.wait_for(
+                lock,
+                10ms,
+                [&]
+                {
+                    return stopping.load(std::memory_order_acquire)
+                           or (pushed.load(std::memory_order_acquire) != processed_count);
+                }
+            );
+            sink_sleeping = false;
+        }
+    }
+
+    inline auto LogHandler_Async::Impl::wait_for_queue() -> void
+    {
+        const auto id = sink_id.load();
+        if ((id == std::thread::id()) or (id == std::this_thread::get_id()))
+        {
+            return;
+        }
+
+        const auto target = pushed.load(std::memory_order_acquire);
+        if (processed.load(std::memory_order_acquire) >= target)
+        {
+            return;
+        }
+        wake_sink();
+        auto lock = std::unique_lock(mutex);
+        records_processed.wait(
+            lock,
+            [&] { return processed.load(std::memory_order_acquire) >= target; }
+        );
+    }
+
+    inline auto LogHandler_Async::Impl::wake_sink() -> void
+    {
+        records_available.notify_one();
+    }
+
+    template <class T>
+        requires(not std::is_same_v<std::remove_cvref_t<T>, LogHandler_Async>)
+                and std::constructible_from<AnyLogHandler, T>
+    LogHandler_Async::LogHandler_Async(T&& wrapped, Options options_)
+        : pimpl(
+              std::make_unique<Impl>(
+                  AnyLogHandler(std::forward<T>(wrapped)),
+                  options_.queue_capacity
+              )
+          )
+        , options(std::move(options_))
+    {
+        assert(pimpl->wrapped);
+    }
+
+    inline LogHandler_Async& LogHandler_Async::operator=(LogHandler_Async&& other) noexcept
+    {
+        if (pimpl)
+        {
+            pimpl->stop_sink(true);
+        }
+        pimpl = std::move(other.pimpl);
+        options = std::move(other.options);
+        return *this;
+    }
+
+    inline LogHandler_Async::~LogHandler_Async()
+    {
+        if (pimpl)
+        {
+            pimpl->stop_sink(true);
+        }
+    }
+
+    inline auto
+    LogHandler_Async::start_log_handling(LoggingParams params, std::vector<log_source> sources)
+        -> void
+    {
+        assert(pimpl);
+        pimpl->wrapped.start_log_handling(std::move(params), std::move(sources));
+        pimpl->start_sink();
+    }
+
+    inline auto LogHandler_Async::stop_log_handling(stop_reason reason) -> void
+    {
+        if (not pimpl)
+        {
+            return;
+        }
+        // When exiting the program the wrapped handler might not be usable anymore, the
+        // remaining records were already processed at exit if possible.
+        pimpl->stop_sink(reason != stop_reason::program_exit);
+        pimpl->wrapped.stop_log_handling(reason);
+    }
+
+    inline auto LogHandler_Async::set_log_level(log_level new_level) -> void
+    {
+        assert(pimpl);
+        pimpl->wait_for_queue();
+        pimpl->wrapped.set_log_level(new_level);
+    }
+
+    inline auto LogHandler_Async::set_params(LoggingParams new_params) -> void
+    {
+        assert(pimpl);
+        pimpl->wait_for_queue();
+        pimpl->wrapped.set_params(std::move(new_params));
+    }
+
+    inline auto LogHandler_Async::log(LogRecord record) -> void
+    {
+        assert(pimpl);
+
+        // Announced before checking `running`, so that `stop_sink` waits for this record
+        pimpl->producers.fetch_add(1);
+        const bool queued = (record.level < options.synchronous_level) and pimpl->running.load()
+                            and pimpl->queue.try_push(record);
+        if (queued)
+        {
+            pimpl->pushed.fetch_add(1, std::memory_order_release);
+            if (pimpl->sink_sleeping.load(std::memory_order_relaxed))
+            {
+                pimpl->wake_sink();
+            }
+        }
+        pimpl->producers.fetch_sub(1);
+
+        if (not queued)
+        {
+            // Also when the queue is full, after the queued records to keep them in order
+            pimpl->wait_for_queue();
+            pimpl->wrapped.log(std::move(record));
+        }
+    }
+
+    inline auto LogHandler_Async::enable_backtrace(size_t record_buffer_size) -> void
+    {
+        assert(pimpl);
+        pimpl->wait_for_queue();
+        pimpl->wrapped.enable_backtrace(record_buffer_size);
+    }
+
+    inline auto LogHandler_Async::disable_backtrace() -> void
+    {
+        enable_backtrace(0);
+    }
+
+    inline auto LogHandler_Async::log_backtrace() -> void
+    {
+        assert(pimpl);
+        pimpl->wait_for_queue();
+        pimpl->wrapped.log_backtrace();
+    }
+
+    inline auto LogHandler_Async::log_backtrace_no_guards() -> void
+    {
+        assert(pimpl);
+        pimpl->wait_for_queue();
+        pimpl->wrapped.log_backtrace_no_guards();
+    }
+
+    inline auto LogHandler_Async::flush(std::optional<log_source> source) -> void
+    {
+        assert(pimpl);
+        pimpl->wait_for_queue();
+        pimpl->wrapped.flush(std::move(source));
+    }
+
+    inline auto LogHandler_Async::set_flush_threshold(log_level threshold_level) -> void
+    {
+        assert(pimpl);
+        pimpl->wait_for_queue();
+        pimpl->wrapped.set_flush_threshold(threshold_level);
+    }
+
+    inline auto LogHandler_Async::wait_for_queue() -> void
+    {
+        assert(pimpl);
+        pimpl->wait_for_queue();
+    }
+
+    inline auto LogHandler_Async::is_started() const -> bool
+    {
+        return pimpl and pimpl->running.load();
+    }
+
+    inline auto LogHandler_Async::wrapped() -> AnyLogHandler&
+    {
+        assert(pimpl);
+        return pimpl->wrapped;
+    }
+
 }
 
 #endif
@@ -7,8 +7,12 @@
 #ifndef MAMBA_CORE_PACKAGE_CACHE
 #define MAMBA_CORE_PACKAGE_CACHE
 
+#include <cstdint>
 #include <map>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include "mamba/core/fsutil.hpp"
@@ -112,12 +116,58 @@ namespace mamba
         bool has_valid_tarball(const specs::PackageInfo& s, const ValidationParams& params);
         bool has_valid_extracted_dir(const specs::PackageInfo& s, const ValidationParams& params);
 
+        /**
+         * Validate the extracted directories of several packages concurrently.
+         *
+         * This is equivalent to calling @ref has_valid_extracted_dir on each package.
+         * The valid directories are also recorded in an index of the cache, keyed on the
+         * size and modification time of their ``repodata_record.json`` and on the package
+         * checksums, so that they are not parsed and validated again by later processes.
+         */
+        void validate_extracted_dirs(
+            const std::vector<specs::PackageInfo>& pkgs,
+            const ValidationParams& params
+        );
+
+        /** Name of the index of valid extracted directories, in the ``cache`` directory. */
+        inline static constexpr std::string_view extracted_dirs_index_filename = "extracted_dirs"
+                                                                                 ".json";
+
     private:
 
+        /** What a valid extracted directory was validated against. */
+        struct ExtractedDirVerdict
+        {
+            std::uintmax_t record_size = 0;
+            std::int64_t record_mtime = 0;
+            std::size_t size = 0;
+            std::string sha256;
+            std::string md5;
+            std::string url;
+            int safety_checks = 0;
+            bool extra_safety_checks = false;
+        };
+
+        struct ExtractedDirCheck
+        {
+            bool valid = false;
+            /** The directory relative to the cache, and its verdict if it was validated. */
+            std::string relative_dir;
+            std::optional<ExtractedDirVerdict> verdict;
+        };
+
         void check_writable();
 
+        [[nodiscard]] auto
+        check_extracted_dir(const specs::PackageInfo& s, const ValidationParams& params) const
+            -> ExtractedDirCheck;
+        void load_extracted_dir_verdicts();
+        void write_extracted_dir_verdicts();
+
         std::map<std::string, bool> m_valid_tarballs;
         std::map<std::string, bool> m_valid_extracted_dir;
+        std::unordered_map<std::string, ExtractedDirVerdict> m_extracted_dir_verdicts;
+        bool m_extracted_dir_verdicts_loaded = false;
         Writable m_writable = Writable::UNKNOWN;
         fs::u8path m_path;
     };
@@ -139,6 +189,14 @@ namespace mamba
 
         void clear_query_cache(const specs::PackageInfo& s);
 
+        /**
+         * Validate the extracted directories of all the packages concurrently.
+         *
+         * Later calls to @ref get_extracted_dir_path for these packages do not need to
+         * validate them again.
+         */
+        void validate_extracted_dirs(const std::vector<specs::PackageInfo>& pkgs);
+
     private:
 
         std::vector<PackageCacheData> m_caches;
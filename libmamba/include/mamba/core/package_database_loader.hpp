@@ -7,9 +7,12 @@
 #ifndef MAMBA_CORE_PACKAGE_DATABASE_LOADER_HPP
 #define MAMBA_CORE_PACKAGE_DATABASE_LOADER_HPP
 
+#include <vector>
+
 #include "mamba/core/error_handling.hpp"
 #include "mamba/solver/libsolv/repo_info.hpp"
 #include "mamba/specs/channel.hpp"
+#include "mamba/specs/package_info.hpp"
 
 namespace mamba
 {
@@ -30,6 +33,17 @@ namespace mamba
         const SubdirIndexLoader& subdir_index_loader
     ) -> expected_t<solver::libsolv::RepoInfo>;
 
+    /** The packages of ``prefix`` making up the installed repository, without virtual packages. */
+    auto installed_packages_for_database(const Context& ctx, const PrefixData& prefix)
+        -> std::vector<specs::PackageInfo>;
+
+    /** Set the installed repository from its packages and the virtual packages. */
+    auto load_installed_packages_in_database(
+        solver::libsolv::Database& database,
+        const std::vector<specs::PackageInfo>& pkgs,
+        const std::vector<specs::PackageInfo>& virtual_packages
+    ) -> solver::libsolv::RepoInfo;
+
     auto load_installed_packages_in_database(
         const Context& ctx,
         solver::libsolv::Database& database,
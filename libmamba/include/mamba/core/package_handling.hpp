@@ -7,8 +7,12 @@
 #ifndef MAMBA_CORE_PACKAGE_HANDLING_HPP
 #define MAMBA_CORE_PACKAGE_HANDLING_HPP
 
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
 #include <string>
 #include <system_error>
+#include <utility>
 #include <vector>
 
 #include "mamba/fs/filesystem.hpp"
@@ -59,6 +63,16 @@ namespace mamba
 
     void
     extract_archive(const fs::u8path& file, const fs::u8path& destination, const ExtractOptions& options);
+    /**
+     * Extract an archive as it is read from a stream, such as ``stdin``.
+     *
+     * The stream is not required to be seekable, and must be opened in binary mode.
+     */
+    void extract_archive(
+        std::FILE* stream,
+        const fs::u8path& destination,
+        const ExtractOptions& options
+    );
     void extract_conda(
         const fs::u8path& file,
         const fs::u8path& dest_dir,
@@ -72,6 +86,7 @@ namespace mamba
 
     void
     extract_subproc(const fs::u8path& file, const fs::u8path& dest, const ExtractOptions& options);
+    fs::u8path extract_subproc(const fs::u8path& file, const ExtractOptions& options);
 
     bool transmute(
         const fs::u8path& pkg_file,
@@ -81,6 +96,52 @@ namespace mamba
         const ExtractOptions& options
     );
 
+    /** The ``.conda`` or ``.tar.bz2`` file a package is transmuted to, next to the package. */
+    fs::u8path transmute_target(const fs::u8path& pkg_file);
+
+    struct TransmuteBatchResult
+    {
+        std::size_t converted = 0;
+        /** The packages that could not be transmuted, with the error. */
+        std::vector<std::pair<fs::u8path, std::string>> failures;
+        std::uintmax_t input_bytes = 0;
+        std::uintmax_t output_bytes = 0;
+        std::chrono::duration<double> elapsed{};
+    };
+
+    /**
+     * Split a budget of threads between archives compressed concurrently and the zstd threads
+     * compressing each of them.
+     *
+     * Archives are preferably processed concurrently, the remaining threads are given to zstd
+     * when there are fewer archives than threads.
+     *
+     * @return The number of concurrent archives and the compression threads of each.
+     */
+    std::pair<std::size_t, int>
+    balance_compression_threads(std::size_t n_archives, std::size_t n_threads);
+
+    /**
+     * Transmute packages to the other format, next to each package.
+     *
+     * As for extraction, concurrent conversions of ``.conda`` packages run in subprocesses
+     * since in-process conversions change the working directory.
+     * ``.tar.bz2`` packages are streamed to ``.conda`` and are converted in-process.
+     * A failed conversion does not stop the others, it is reported in the result.
+     *
+     * @param compression_level The compression level, or -1 for the default of the format.
+     * @param compression_threads The compression threads of each package, or 0 to split
+     *        ``n_threads`` with ``balance_compression_threads``.
+     * @param n_threads The number of threads.
+     */
+    TransmuteBatchResult transmute_batch(
+        const std::vector<fs::u8path>& pkg_files,
+        int compression_level,
+        int compression_threads,
+        std::size_t n_threads,
+        const ExtractOptions& options
+    );
+
     bool validate(const fs::u8path& pkg_folder, const ValidationParams& params);
 
 }  // namespace mamba
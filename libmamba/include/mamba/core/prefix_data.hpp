@@ -9,6 +9,7 @@
 
 #include <map>
 #include <string>
+#include <utility>
 
 #include "mamba/core/error_handling.hpp"
 #include "mamba/core/history.hpp"
@@ -49,11 +50,14 @@ namespace mamba
         PrefixData(const fs::u8path& prefix_path, ChannelContext& channel_context, bool no_pip);
 
         void load_site_packages();
+        void add_record(specs::PackageInfo prec);
 
         History m_history;
         package_map m_package_records;
         package_map m_pip_package_records;
         fs::u8path m_prefix_path;
+        // Platform URL of the channels of the records, as resolving channels is costly
+        std::map<std::pair<std::string, std::string>, std::string> m_record_channel_urls;
 
         ChannelContext& m_channel_context;
     };
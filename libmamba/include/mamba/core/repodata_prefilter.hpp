@@ -0,0 +1,112 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#ifndef MAMBA_CORE_REPODATA_PREFILTER_HPP
+#define MAMBA_CORE_REPODATA_PREFILTER_HPP
+
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "mamba/solver/libsolv/repo_info.hpp"
+#include "mamba/specs/package_info.hpp"
+#include "mamba/specs/version.hpp"
+
+namespace mamba
+{
+    namespace solver::libsolv
+    {
+        class Database;
+    }
+
+    /**
+     * Drop repodata records that cannot be installed in the target environment.
+     *
+     * A record is rejected when one of its ``depends``:
+     *   - requires a virtual package (e.g. ``__glibc``, ``__cuda``, ``__osx``) that is missing
+     *     from the given virtual packages, or whose version or build does not match;
+     *   - constrains ``python`` to a range not containing the given python minor version
+     *     (see ``matches_python_minor``).
+     *
+     * Verdicts are cached by dependency string and shared between copies of the prefilter,
+     * so that a dependency found in many records is only evaluated once.
+     * The prefilter can be used concurrently from multiple threads.
+     * A default constructed prefilter accepts everything.
+     */
+    class RepodataPrefilter
+    {
+    public:
+
+        RepodataPrefilter() = default;
+
+        /**
+         * @param python_minor If set, reject records depending on another python minor.
+         * @param virtual_packages If set, reject records depending on virtual packages that
+         *        they do not match.
+         */
+        RepodataPrefilter(
+            std::optional<specs::Version> python_minor,
+            std::optional<std::vector<specs::PackageInfo>> virtual_packages
+        );
+
+        /**
+         * Same as above, with virtual packages that may still be being detected.
+         *
+         * They are waited for the first time a record is evaluated.
+         */
+        RepodataPrefilter(
+            std::optional<specs::Version> python_minor,
+            std::shared_future<std::vector<specs::PackageInfo>> virtual_packages
+        );
+
+        /** Whether the prefilter may reject any record. */
+        [[nodiscard]] auto is_active() const -> bool;
+
+        [[nodiscard]] auto python_minor() const -> const std::optional<specs::Version>&;
+
+        /** A copy of this prefilter also rejecting records depending on another python minor. */
+        [[nodiscard]] auto with_python_minor(std::optional<specs::Version> python_minor) const
+            -> RepodataPrefilter;
+
+        /** A string identifying the prefilter, for instance in cache keys. */
+        [[nodiscard]] auto key() const -> std::string;
+
+        [[nodiscard]] auto accepts_dependency(std::string_view dependency) const -> bool;
+
+        /** Whether a record with the given ``depends`` is kept. */
+        [[nodiscard]] auto accepts_depends(std::span<const std::string> depends) const -> bool;
+
+        /**
+         * Remove the packages rejected by the prefilter from a repository of the database.
+         *
+         * @return The number of packages removed.
+         */
+        auto filter_repo(solver::libsolv::Database& database, solver::libsolv::RepoInfo repo) const
+            -> std::size_t;
+
+    private:
+
+        struct Verdicts
+        {
+            std::mutex mutex;
+            std::unordered_map<std::string, bool> by_dependency;
+        };
+
+        [[nodiscard]] auto evaluate(std::string_view dependency) const -> bool;
+
+        std::optional<specs::Version> m_python_minor;
+        std::optional<std::shared_future<std::vector<specs::PackageInfo>>> m_virtual_packages;
+        std::shared_ptr<Verdicts> m_verdicts = std::make_shared<Verdicts>();
+    };
+}
+#endif
@@ -46,6 +46,14 @@ namespace mamba
         SINKIN = 1 << 2,
     };
 
+    /**
+     * Run a command in an activated prefix.
+     *
+     * On Unix, unless the process is detached, labelled, has redirected streams or a clean
+     * environment, the current process is replaced by the command and the function only returns
+     * on failure.
+     * Otherwise, the command is run through a wrapper script activating the prefix.
+     */
     int run_in_environment(
         const Context& context,
         const fs::u8path& prefix,
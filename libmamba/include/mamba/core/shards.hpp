@@ -15,6 +15,7 @@
 #include <vector>
 
 #include "mamba/core/error_handling.hpp"
+#include "mamba/core/repodata_prefilter.hpp"
 #include "mamba/core/shard_types.hpp"
 #include "mamba/core/subdir_index.hpp"
 #include "mamba/core/thread_utils.hpp"
@@ -38,6 +39,7 @@ namespace mamba
      * ``python`` to a range that does not contain that minor, reducing work for the solver.
      * When that optional is unset, no such filtering is applied and all records in the shard
      * are parsed (python compatibility is left to the solver).
+     * Records are also dropped when they are rejected by the given ``RepodataPrefilter``.
      */
     class Shards
     {
@@ -58,6 +60,8 @@ namespace mamba
          * @param python_minor_version_for_prefilter If set, shard parsing filters out records whose
          *        ``depends`` python constraints are incompatible with this minor; if unset,
          *        no python-minor-based record filtering is performed.
+         * @param shards_ttl_seconds Time to live of the cached shards.
+         * @param prefilter Records rejected by this prefilter are dropped when parsing shards.
          */
         Shards(
             ShardsIndexDict shards_index,
@@ -69,7 +73,8 @@ namespace mamba
             std::size_t download_threads = 0,
             std::optional<std::reference_wrapper<const download::mirror_map>> mirrors = std::nullopt,
             std::optional<specs::Version> python_minor_version_for_prefilter = std::nullopt,
-            std::size_t shards_ttl_seconds = std::numeric_limits<std::size_t>::max()
+            std::size_t shards_ttl_seconds = std::numeric_limits<std::size_t>::max(),
+            RepodataPrefilter prefilter = {}
         );
 
         /** Return the names of all packages available in this shard collection. */
@@ -142,6 +147,9 @@ namespace mamba
          */
         std::optional<specs::Version> m_python_minor_version_for_prefilter;
 
+        /** Prefilter of the parsed records, inactive by default. */
+        RepodataPrefilter m_prefilter;
+
         /** Visited shards, keyed by package name. */
         std::map<std::string, ShardDict> m_visited;
 
@@ -7,21 +7,52 @@
 #ifndef MAMBA_CORE_VIRTUAL_PACKAGES_HPP
 #define MAMBA_CORE_VIRTUAL_PACKAGES_HPP
 
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "mamba/fs/filesystem.hpp"
 #include "mamba/specs/package_info.hpp"
 
 namespace mamba
 {
     class Context;
 
+    /**
+     * The virtual packages of the current system, for the given platform.
+     *
+     * Probing the CUDA driver version runs ``nvidia-smi``, whose result is cached in the user
+     * cache directory, along with a fingerprint of the driver files and kernel release.
+     * The cache is not used when the version is set by ``CONDA_OVERRIDE_CUDA``.
+     */
     std::vector<specs::PackageInfo> get_virtual_packages(const std::string& platform);
 
+    /**
+     * Start probing the virtual packages in a background thread.
+     *
+     * A later call to @ref get_virtual_packages reuses this result rather than blocking on a
+     * new probe, so that it can run concurrently with, for instance, downloading repodata.
+     */
+    void start_virtual_packages_detection();
+
     namespace detail
     {
         std::string cuda_version();
 
+        /** A hash of the files and environment that the CUDA version depends on. */
+        auto cuda_probe_fingerprint() -> std::string;
+
+        /** The cached probe value, if the cache file exists and has the same fingerprint. */
+        auto read_cached_probe(const fs::u8path& file, std::string_view fingerprint)
+            -> std::optional<std::string>;
+
+        void write_cached_probe(
+            const fs::u8path& file,
+            std::string_view fingerprint,
+            std::string_view value
+        );
+
         auto make_virtual_package(
             std::string name,
             std::string subdir,
@@ -14,6 +14,7 @@
 #include <memory>
 #include <optional>
 #include <ranges>
+#include <string>
 #include <string_view>
 #include <vector>
 
@@ -80,6 +81,16 @@ namespace mamba::solver::libsolv
         auto operator=(const Database&) -> Database& = delete;
         auto operator=(Database&&) -> Database&;
 
+        /**
+         * Make an independent copy of the database.
+         *
+         * All repositories, their priorities, the installed repository, and the virtual package
+         * jobs are copied, but not the logger.
+         * The databases can then be used to solve concurrently, for instance in different
+         * threads, since a database must not be used from several threads at once.
+         */
+        [[nodiscard]] auto clone() const -> Database;
+
         [[nodiscard]] auto channel_params() const -> const specs::ChannelResolveParams&;
 
         [[nodiscard]] auto settings() const -> const Settings&;
@@ -149,10 +160,55 @@ namespace mamba::solver::libsolv
 
         void remove_repo(RepoInfo repo);
 
+        /**
+         * Remove the packages of a repository having a dependency rejected by ``keep``.
+         *
+         * Dependencies are shared in the pool, so that each distinct dependency is evaluated
+         * only once, however many packages refer to it.
+         * The ``filter_key`` identifies the filter in the @ref fingerprint.
+         *
+         * @return The number of packages removed.
+         */
+        auto remove_packages_by_dependency(
+            RepoInfo repo,
+            std::string_view filter_key,
+            const std::function<bool(std::string_view)>& keep
+        ) -> std::size_t;
+
         [[nodiscard]] auto repo_count() const -> std::size_t;
 
         [[nodiscard]] auto package_count() const -> std::size_t;
 
+        /**
+         * A hash of the repositories, their priorities and their packages.
+         *
+         * Repositories loaded from repodata are identified by their origin rather than their
+         * content, so that computing the fingerprint stays cheap.
+         * It is meant to identify the inputs of a solve, for instance to cache its solution.
+         */
+        [[nodiscard]] auto fingerprint() const -> std::string;
+
+        /**
+         * Atomically write all repositories to a single snapshot file.
+         *
+         * The snapshot holds the packages as they are once loaded, for instance with pip
+         * added as a Python dependency, as well as the repositories priorities, the installed
+         * repository, and the virtual package jobs.
+         * It is tagged with a ``key`` identifying the inputs of the database, which
+         * @ref add_repos_from_snapshot checks.
+         */
+        auto write_snapshot(const fs::u8path& path, std::string_view key) const
+            -> expected_t<void>;
+
+        /**
+         * Add all repositories from a snapshot written by @ref write_snapshot.
+         *
+         * Fails without modifying the database if the snapshot was written with another
+         * ``key`` or cannot be read.
+         */
+        auto add_repos_from_snapshot(const fs::u8path& path, std::string_view key)
+            -> expected_t<std::vector<RepoInfo>>;
+
         template <typename Func>
         void for_each_package_in_repo(RepoInfo repo, Func&&) const;
 
@@ -0,0 +1,65 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#ifndef MAMBA_SOLVER_LIBSOLV_SOLUTION_CACHE_HPP
+#define MAMBA_SOLVER_LIBSOLV_SOLUTION_CACHE_HPP
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "mamba/fs/filesystem.hpp"
+#include "mamba/solver/libsolv/parameters.hpp"
+#include "mamba/solver/request.hpp"
+#include "mamba/solver/solution.hpp"
+
+namespace mamba::solver::libsolv
+{
+    class Database;
+
+    /**
+     * An on-disk cache of the solutions found by the @ref Solver.
+     *
+     * Solutions are keyed on the request, the MatchSpec parser, and the
+     * @ref Database::fingerprint of the repositories, which covers the repodata origins,
+     * the repository priorities, the virtual packages, and the installed packages.
+     * Loading a solution checks that all of its packages are still in the database and
+     * replaces them with the database packages, so a cache hit gives the same solution as
+     * solving again.
+     */
+    class SolutionCache
+    {
+    public:
+
+        static constexpr int version = 1;
+
+        explicit SolutionCache(fs::u8path cache_dir);
+
+        [[nodiscard]] static auto
+        key(const Database& database, const Request& request, MatchSpecParser ms_parser)
+            -> std::string;
+
+        [[nodiscard]] auto cache_dir() const -> const fs::u8path&;
+
+        /** Load the cached solution for ``key``, if it is valid with the ``database``. */
+        [[nodiscard]] auto load(Database& database, std::string_view key) const
+            -> std::optional<Solution>;
+
+        /**
+         * Atomically store the ``solution`` for ``key``.
+         *
+         * Errors are logged but not reported since this is only a cache.
+         */
+        void store(std::string_view key, const Solution& solution) const;
+
+    private:
+
+        fs::u8path m_cache_dir;
+
+        [[nodiscard]] auto cache_file(std::string_view key) const -> fs::u8path;
+    };
+}
+#endif
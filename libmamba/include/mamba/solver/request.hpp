@@ -10,6 +10,8 @@
 #include <type_traits>
 #include <variant>
 
+#include <nlohmann/json_fwd.hpp>
+
 #include "mamba/specs/match_spec.hpp"
 #include "mamba/util/loop_control.hpp"
 #include "mamba/util/type_traits.hpp"
@@ -87,6 +89,11 @@ namespace mamba::solver
         job_list jobs = {};
     };
 
+    /** Serialize the flags and jobs, specs are written as strings. */
+    void to_json(nlohmann::json& j, const Request& request);
+
+    void from_json(const nlohmann::json& j, Request& request);
+
     template <typename... Item, typename Func>
     void for_each_of(const Request& request, Func&& func)
     {
@@ -12,6 +12,8 @@
 #include <variant>
 #include <vector>
 
+#include <nlohmann/json_fwd.hpp>
+
 #include "mamba/specs/package_info.hpp"
 #include "mamba/util/type_traits.hpp"
 
@@ -110,6 +112,11 @@ namespace mamba::solver
         [[nodiscard]] auto packages_to_omit();
     };
 
+    /** Serialize the solution actions as a JSON array. */
+    void to_json(nlohmann::json& j, const Solution& solution);
+
+    void from_json(const nlohmann::json& j, Solution& solution);
+
     /********************************
      *  Implementation of Solution  *
      ********************************/
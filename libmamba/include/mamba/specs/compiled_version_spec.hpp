@@ -0,0 +1,137 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#ifndef MAMBA_SPECS_COMPILED_VERSION_SPEC_HPP
+#define MAMBA_SPECS_COMPILED_VERSION_SPEC_HPP
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "mamba/specs/error.hpp"
+#include "mamba/specs/version.hpp"
+#include "mamba/specs/version_spec.hpp"
+
+namespace mamba::specs
+{
+    /**
+     * A byte string ordered in the same way as the given version.
+     *
+     * Comparing the keys of two versions as strings gives the same result as comparing the
+     * versions.
+     * In particular, versions comparing equal such as ``1.0`` and ``1.0.0`` have the same key.
+     */
+    [[nodiscard]] auto version_key(const Version& version) -> std::string;
+
+    /**
+     * A VersionSpec compiled into sorted disjoint intervals of version keys.
+     *
+     * Expressions made of comparison operators are compiled exactly, so that finding whether
+     * they contain a version is a binary search over the intervals.
+     * Predicates such as ``=1.2``, ``~=1.2``, or globs do not describe intervals in the
+     * Conda version ordering (for instance ``1dev.2`` starts with ``1.2`` but ``1.1`` does not),
+     * so they are compiled into an enclosing interval inside which the original VersionSpec
+     * is evaluated.
+     */
+    class CompiledVersionSpec
+    {
+    public:
+
+        /**
+         * Compile the VersionSpec parsed from the given string.
+         *
+         * The result is cached by string and shared between calls and threads.
+         */
+        [[nodiscard]] static auto parse_cached(std::string_view str)
+            -> expected_parse_t<std::shared_ptr<const CompiledVersionSpec>>;
+
+        /**
+         * Compile the given VersionSpec, sharing the result with all equal specs.
+         *
+         * The cache is keyed by the string representation of the spec.
+         */
+        [[nodiscard]] static auto compile_cached(const VersionSpec& spec)
+            -> std::shared_ptr<const CompiledVersionSpec>;
+
+        explicit CompiledVersionSpec(VersionSpec spec);
+
+        [[nodiscard]] auto spec() const -> const VersionSpec&;
+
+        /**
+         * True if the spec is compiled exactly.
+         *
+         * In this case, the VersionSpec is never evaluated.
+         */
+        [[nodiscard]] auto is_exact() const -> bool;
+
+        /**
+         * The number of disjoint intervals in the compiled form.
+         */
+        [[nodiscard]] auto interval_count() const -> std::size_t;
+
+        /**
+         * Same as VersionSpec::contains.
+         */
+        [[nodiscard]] auto contains(const Version& point) const -> bool;
+
+        /**
+         * Same as VersionSpec::contains, with the precomputed ``version_key(point)``.
+         */
+        [[nodiscard]] auto contains(const Version& point, std::string_view point_key) const
+            -> bool;
+
+        /**
+         * False if the version with the given key is certainly not contained in the spec.
+         *
+         * This is only a binary search, it does not evaluate the VersionSpec.
+         */
+        [[nodiscard]] auto may_contain(std::string_view point_key) const -> bool;
+
+        /**
+         * Return the indices of the given versions contained in the spec, in increasing order.
+         */
+        [[nodiscard]] auto matching_indices(std::span<const Version> points) const
+            -> std::vector<std::size_t>;
+
+    private:
+
+        enum struct Match : std::uint8_t
+        {
+            none,
+            maybe,
+            all,
+        };
+
+        /** A boundary between two intervals, either before or after the given key. */
+        struct Cut
+        {
+            std::string key;
+            bool after = false;
+        };
+
+        struct Intervals
+        {
+            /** Sorted cuts. */
+            std::vector<Cut> cuts = {};
+            /** The match of the interval before each cut, and the last one after all cuts. */
+            std::vector<Match> matches = {};
+        };
+
+        [[nodiscard]] static auto compile_predicate(const VersionPredicate& pred) -> Intervals;
+        [[nodiscard]] static auto compile_tree(const VersionSpec& spec) -> Intervals;
+        [[nodiscard]] static auto
+        combine(const Intervals& lhs, const Intervals& rhs, util::BoolOperator op) -> Intervals;
+
+        [[nodiscard]] auto match_of(std::string_view point_key) const -> Match;
+
+        VersionSpec m_spec;
+        Intervals m_intervals;
+    };
+}
+#endif
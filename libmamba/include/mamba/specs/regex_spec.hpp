@@ -7,7 +7,7 @@
 #ifndef MAMBA_SPECS_REGEX_SPEC
 #define MAMBA_SPECS_REGEX_SPEC
 
-#include <regex>
+#include <memory>
 #include <string>
 #include <string_view>
 
@@ -20,6 +20,13 @@ namespace mamba::specs
 {
     /**
      * A matcher for regex expression.
+     *
+     * The pattern is compiled when the spec is constructed.
+     * Patterns made of literals and wildcards, the form of most build strings, are matched
+     * without a regex engine, other patterns in the subset used in practice (groups,
+     * alternatives, character classes, repetitions, and a leading negative lookahead) are
+     * matched with an automaton that does not backtrack.
+     * Other ECMAScript patterns fallback to ``std::regex``.
      */
     class RegexSpec
     {
@@ -51,8 +58,7 @@ namespace mamba::specs
         // TODO(C++20): replace by the `= default` implementation of `operator==`
         [[nodiscard]] auto operator==(const RegexSpec& other) const -> bool
         {
-            return m_raw_pattern == other.m_raw_pattern
-                   && m_pattern.flags() == other.m_pattern.flags();
+            return m_raw_pattern == other.m_raw_pattern;
         }
 
         [[nodiscard]] auto operator!=(const RegexSpec& other) const -> bool
@@ -62,8 +68,10 @@ namespace mamba::specs
 
     private:
 
+        struct Matcher;
+
         std::string m_raw_pattern;
-        std::regex m_pattern;
+        std::shared_ptr<const Matcher> m_matcher;
     };
 }
 
@@ -20,6 +20,8 @@
 
 namespace mamba::specs
 {
+    class CompiledVersionSpec;
+
     /**
      * A stateful unary boolean function on the Version space.
      */
@@ -149,6 +151,7 @@ namespace mamba::specs
         friend auto operator==(not_version_glob, not_version_glob) -> bool;
         friend auto operator==(const VersionPredicate& lhs, const VersionPredicate& rhs) -> bool;
         friend struct ::fmt::formatter<VersionPredicate>;
+        friend class CompiledVersionSpec;
     };
 
     auto operator==(const VersionPredicate& lhs, const VersionPredicate& rhs) -> bool;
@@ -263,6 +266,7 @@ namespace mamba::specs
         tree_type m_tree;
 
         friend struct ::fmt::formatter<VersionSpec>;
+        friend class CompiledVersionSpec;
     };
 
     namespace version_spec_literals
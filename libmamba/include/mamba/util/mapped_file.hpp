@@ -0,0 +1,61 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#ifndef MAMBA_UTIL_MAPPED_FILE_HPP
+#define MAMBA_UTIL_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string_view>
+#include <system_error>
+
+#include <tl/expected.hpp>
+
+#include "mamba/fs/filesystem.hpp"
+
+namespace mamba::util
+{
+    /**
+     * A read-only memory mapping of a whole file.
+     *
+     * The content is paged in lazily by the OS, which avoids copying large files in memory
+     * when they only need to be scanned.
+     * Empty files are supported and give an empty view.
+     */
+    class MappedFile
+    {
+    public:
+
+        /**
+         * Map a file in memory.
+         *
+         * In case of error, set the error code @p ec.
+         */
+        static auto try_open(const fs::u8path& path, std::error_code& ec) -> MappedFile;
+
+        static auto try_open(const fs::u8path& path) -> tl::expected<MappedFile, std::error_code>;
+
+        MappedFile(MappedFile&& other) noexcept;
+        auto operator=(MappedFile&& other) noexcept -> MappedFile&;
+
+        /** Unmap the file. */
+        ~MappedFile();
+
+        [[nodiscard]] auto data() const noexcept -> const char*;
+        [[nodiscard]] auto size() const noexcept -> std::size_t;
+        [[nodiscard]] auto view() const noexcept -> std::string_view;
+
+    private:
+
+        const char* m_data = nullptr;
+        std::size_t m_size = 0;
+
+        MappedFile() = default;
+        MappedFile(const char* data, std::size_t size);
+
+        void unmap() noexcept;
+    };
+}
+#endif
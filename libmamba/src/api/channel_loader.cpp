@@ -12,6 +12,8 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include <fmt/format.h>
+
 #include "mamba/api/channel_loader.hpp"
 #include "mamba/core/channel_context.hpp"
 #include "mamba/core/context.hpp"
@@ -19,6 +21,7 @@
 #include "mamba/core/output.hpp"
 #include "mamba/core/package_database_loader.hpp"
 #include "mamba/core/prefix_data.hpp"
+#include "mamba/core/repodata_prefilter.hpp"
 #include "mamba/core/shard_index_loader.hpp"
 #include "mamba/core/shard_traversal.hpp"
 #include "mamba/core/shard_types.hpp"
@@ -29,7 +32,10 @@
 #include "mamba/specs/match_spec.hpp"
 #include "mamba/specs/package_info.hpp"
 #include "mamba/specs/version.hpp"
+#include "mamba/util/build.hpp"
+#include "mamba/util/cryptography.hpp"
 #include "mamba/util/string.hpp"
+#include "mamba/version.hpp"
 
 #include "utils.hpp"
 
@@ -396,6 +402,7 @@ namespace mamba
          * @param priorities Repo priorities aligned with ``subdirs``.
          * @param python_minor_version_for_prefilter Optional python minor for shard record
          *        prefiltering (from ``prepare_solver_context``).
+         * @param prefilter Prefilter of the shard records, in addition to the python minor one.
          * @param expand_shard_roots_from_loaded_shards When true, extend ``root_packages`` from
          *        dependency names in loaded shard records (multi-sharded channel sets only).
          * @return The repo for the requested subdir, or unexpected mamba_error on failure.
@@ -409,6 +416,7 @@ namespace mamba
             std::map<std::string, solver::libsolv::RepoInfo>& loaded_subdirs_with_shards,
             const std::vector<solver::libsolv::Priorities>& priorities,
             std::optional<specs::Version> python_minor_version_for_prefilter,
+            const RepodataPrefilter& prefilter,
             bool expand_shard_roots_from_loaded_shards
         ) -> expected_t<solver::libsolv::RepoInfo>
         {
@@ -486,7 +494,8 @@ namespace mamba
                         normalize_to_affinity_concurrency(static_cast<int>(ctx.repodata_shards_threads)),
                         std::cref(ctx.mirrors),
                         python_minor_version_for_prefilter,
-                        ctx.repodata_shards_ttl
+                        ctx.repodata_shards_ttl,
+                        prefilter
                     );
                     url_to_subdir_idx[sdir_url] = j;
                 }
@@ -573,6 +582,7 @@ namespace mamba
             const SubdirDownloadParams& subdir_params,
             const std::vector<solver::libsolv::Priorities>& priorities,
             std::optional<specs::Version> python_minor_version_for_prefilter,
+            const RepodataPrefilter& prefilter,
             bool expand_shard_roots_from_loaded_shards,
             bool* used_flat_repodata,
             std::optional<std::chrono::steady_clock::time_point>* flat_repodata_started_at
@@ -598,6 +608,13 @@ namespace mamba
                 auto flat_res = load_subdir_in_database(ctx, database, subdir);
                 if (flat_res)
                 {
+                    // Applied once loaded, so that the solv cache keeps all the records.
+                    if (const auto removed = prefilter.filter_repo(database, flat_res.value());
+                        removed > 0)
+                    {
+                        LOG_DEBUG << "Prefilter removed " << removed << " packages from "
+                                  << subdir.name();
+                    }
                     if (used_flat_repodata != nullptr)
                     {
                         *used_flat_repodata = true;
@@ -622,6 +639,7 @@ namespace mamba
                     loaded_subdirs_with_shards,
                     priorities,
                     python_minor_version_for_prefilter,
+                    prefilter,
                     expand_shard_roots_from_loaded_shards
                 );
 
@@ -808,7 +826,8 @@ namespace mamba
             const SubdirDownloadParams& subdir_params,
             bool is_retry,
             std::vector<mamba_error>& error_list,
-            std::optional<specs::Version> python_minor_version_for_prefilter
+            std::optional<specs::Version> python_minor_version_for_prefilter,
+            const RepodataPrefilter& prefilter
         )
         {
             std::map<std::string, solver::libsolv::RepoInfo> loaded_subdirs_with_shards;
@@ -871,6 +890,7 @@ namespace mamba
                     subdir_params,
                     priorities,
                     python_minor_version_for_prefilter,
+                    prefilter,
                     expand_shard_roots_from_loaded_shards,
                     &used_flat_repodata,
                     &flat_repodata_started_at
@@ -1055,6 +1075,96 @@ namespace mamba
             }
         }
 
+        auto file_stamp(const expected_t<fs::u8path>& path) -> std::string
+        {
+            if (!path.has_value())
+            {
+                return "-";
+            }
+            std::error_code ec;
+            const auto size = fs::file_size(path.value(), ec);
+            const auto mtime = fs::last_write_time(path.value(), ec).time_since_epoch().count();
+            return fmt::format("{}|{}|{}", path->string(), size, ec ? 0 : mtime);
+        }
+
+        /**
+         * Key of the database snapshot of the loaded subdirs.
+         *
+         * Returns nothing when the database cannot be restored from a snapshot, for
+         * instance when repodata shards are loaded for specific packages only.
+         */
+        auto database_snapshot_key(
+            const Context& ctx,
+            const solver::libsolv::Database& database,
+            const std::vector<SubdirIndexLoader>& subdirs,
+            const std::vector<solver::libsolv::Priorities>& priorities,
+            const std::vector<std::string>& root_packages,
+            const RepodataPrefilter& prefilter
+        ) -> std::optional<std::string>
+        {
+            const bool use_shards = ctx.use_sharded_repodata && !root_packages.empty();
+            // Solv files are not used on Windows, nor are snapshots
+            if (!ctx.use_database_snapshot || util::on_win || use_shards
+                || (database.repo_count() > 0) || subdirs.empty())
+            {
+                return std::nullopt;
+            }
+
+            auto data = fmt::format(
+                "{}|{}|{}|{}\n",
+                mamba::version(),
+                database.fingerprint(),
+                channel_loading_key(ctx, database),
+                prefilter.key()
+            );
+            for (std::size_t i = 0; i < subdirs.size(); ++i)
+            {
+                const auto& subdir = subdirs[i];
+                if (!subdir.valid_cache_found())
+                {
+                    return std::nullopt;
+                }
+                data += fmt::format(
+                    "{}|{}|{}|{}|{}|{}|{}|{}|{}\n",
+                    subdir.channel_id(),
+                    subdir.metadata().url(),
+                    subdir.metadata().etag(),
+                    subdir.metadata().last_modified(),
+                    priorities[i].priority,
+                    priorities[i].subpriority,
+                    file_stamp(subdir.valid_libsolv_cache_path()),
+                    file_stamp(subdir.valid_json_cache_path()),
+                    subdir.name()
+                );
+            }
+            return util::Sha256Hasher().str_hex_str(data);
+        }
+
+        /**
+         * One snapshot per set of subdirs, replaced when their repodata changes.
+         *
+         * Returns nothing when no package cache is writable.
+         */
+        auto database_snapshot_path(
+            MultiPackageCache& package_caches,
+            const std::vector<SubdirIndexLoader>& subdirs
+        ) -> std::optional<fs::u8path>
+        {
+            const auto pkgs_dir = package_caches.first_writable_path();
+            if (pkgs_dir.empty())
+            {
+                return std::nullopt;
+            }
+            auto names = std::string();
+            for (const auto& subdir : subdirs)
+            {
+                names += subdir.metadata().url();
+                names += '\n';
+            }
+            const auto id = util::Sha256Hasher().str_hex_str(names).substr(0, 16);
+            return pkgs_dir / "cache" / "snapshots" / util::concat(id, ".solvs");
+        }
+
     }  // anonymous namespace
 
     namespace
@@ -1067,7 +1177,8 @@ namespace mamba
             MultiPackageCache& package_caches,
             const std::vector<std::string>& root_packages,
             bool is_retry,
-            std::optional<specs::Version> python_minor_version_for_prefilter
+            std::optional<specs::Version> python_minor_version_for_prefilter,
+            const RepodataPrefilter& prefilter
         )
         {
             std::vector<SubdirIndexLoader> subdirs;
@@ -1106,6 +1217,31 @@ namespace mamba
 
             add_repos_from_pks_dir(ctx, channel_context, database);
 
+            const auto snapshot_key = database_snapshot_key(
+                ctx,
+                database,
+                subdirs,
+                priorities,
+                root_packages,
+                prefilter
+            );
+            const auto snapshot_path = snapshot_key.has_value()
+                                           ? database_snapshot_path(package_caches, subdirs)
+                                           : std::nullopt;
+            if (snapshot_path.has_value())
+            {
+                auto restored = database.add_repos_from_snapshot(*snapshot_path, *snapshot_key);
+                if (restored)
+                {
+                    LOG_INFO << "Restored " << restored->size() << " repositories from snapshot "
+                             << *snapshot_path;
+                    using return_type = expected_t<void, mamba_aggregated_error>;
+                    return error_list.empty() ? return_type()
+                                              : return_type(make_unexpected(std::move(error_list)));
+                }
+                LOG_DEBUG << restored.error().what();
+            }
+
             std::vector<std::string> effective_shard_root_packages(root_packages);
             bool loading_failed = load_all_subdirs(
                 ctx,
@@ -1116,9 +1252,19 @@ namespace mamba
                 subdir_params,
                 is_retry,
                 error_list,
-                python_minor_version_for_prefilter
+                python_minor_version_for_prefilter,
+                prefilter
             );
 
+            if (snapshot_path.has_value() && !loading_failed && error_list.empty())
+            {
+                if (auto written = database.write_snapshot(*snapshot_path, *snapshot_key); !written)
+                {
+                    LOG_DEBUG << "Could not write database snapshot " << *snapshot_path << ": "
+                              << written.error().what();
+                }
+            }
+
             if (loading_failed)
             {
                 bool should_retry = !ctx.offline && !is_retry;
@@ -1133,7 +1279,8 @@ namespace mamba
                         package_caches,
                         root_packages,
                         retry,
-                        python_minor_version_for_prefilter
+                        python_minor_version_for_prefilter,
+                        prefilter
                     );
                 }
                 error_list.emplace_back(
@@ -1153,7 +1300,8 @@ namespace mamba
         solver::libsolv::Database& database,
         MultiPackageCache& package_caches,
         const std::vector<std::string>& root_packages,
-        std::optional<specs::Version> python_minor_version_for_prefilter
+        std::optional<specs::Version> python_minor_version_for_prefilter,
+        const RepodataPrefilter& prefilter
     ) -> expected_t<void, mamba_aggregated_error>
     {
         bool retry = false;
@@ -1164,7 +1312,25 @@ namespace mamba
             package_caches,
             root_packages,
             retry,
-            std::move(python_minor_version_for_prefilter)
+            std::move(python_minor_version_for_prefilter),
+            prefilter
+        );
+    }
+
+    auto channel_loading_key(const Context& ctx, const solver::libsolv::Database& database)
+        -> std::string
+    {
+        const auto& settings = database.settings();
+        return fmt::format(
+            "{}|{}|{}|{}|{}|{}|{}|{}",
+            ctx.add_pip_as_python_dependency,
+            ctx.use_only_tar_bz2,
+            static_cast<int>(ctx.validation_params.verify_artifacts),
+            ctx.mamba_repodata_parsing,
+            static_cast<int>(ctx.channel_priority),
+            ctx.offline,
+            static_cast<int>(settings.matchspec_parser),
+            settings.exclude_newer_timestamp.value_or(0)
         );
     }
 
@@ -4,15 +4,23 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <algorithm>
 #include <iostream>
+#include <set>
+#include <stdexcept>
+#include <thread>
 
 #include "mamba/api/clean.hpp"
 #include "mamba/api/configuration.hpp"
 #include "mamba/core/cache_paths.hpp"
 #include "mamba/core/context.hpp"
+#include "mamba/core/environments_manager.hpp"
+#include "mamba/core/fsutil.hpp"
 #include "mamba/core/package_cache.hpp"
 #include "mamba/core/util.hpp"
+#include "mamba/core/util_scope.hpp"
 #include "mamba/fs/filesystem.hpp"
+#include "mamba/util/random.hpp"
 #include "mamba/util/string.hpp"
 
 #include "../core/progress_bar_impl.hpp"
@@ -35,6 +43,7 @@ namespace mamba
         bool clean_locks = options & MAMBA_CLEAN_LOCKS;
         bool clean_trash = options & MAMBA_CLEAN_TRASH;
         bool clean_force_pkgs_dirs = options & MAMBA_CLEAN_FORCE_PKGS_DIRS;
+        bool clean_move_to_trash = options & MAMBA_CLEAN_MOVE_TO_TRASH;
 
         if (!(clean_all || clean_index || clean_pkgs || clean_tarballs || clean_locks || clean_trash
               || clean_force_pkgs_dirs))
@@ -178,20 +187,6 @@ namespace mamba
             clean_trash_files(ctx.prefix_params.root_prefix, true);
         }
 
-        // globally, collect installed packages
-        std::set<std::string> installed_pkgs;
-        for (auto& env : envs)
-        {
-            for (auto& pkg : fs::directory_iterator(env / "conda-meta"))
-            {
-                if (util::ends_with(pkg.path().string(), ".json"))
-                {
-                    std::string pkg_name = pkg.path().filename().string();
-                    installed_pkgs.insert(pkg_name.substr(0, pkg_name.size() - 5));
-                }
-            }
-        }
-
         auto get_file_size = [](const auto& s) -> std::string
         {
             std::stringstream ss;
@@ -211,136 +206,102 @@ namespace mamba
             return rel_str == cache_dir || util::starts_with(rel_str, cache_dir + "/");
         };
 
-        auto collect_tarballs = [&]()
+        auto is_tarball = [](const fs::u8path& path)
         {
-            std::vector<fs::u8path> res;
-            std::size_t total_size = 0;
-            std::vector<printers::FormattedString> header = { "Package file", "Size" };
-            mamba::printers::Table t(header);
-            t.set_alignment({ printers::alignment::left, printers::alignment::right });
-            t.set_padding({ 2, 4 });
+            const auto filename = path.filename().string();
+            return util::ends_with(filename, ".tar.bz2") || util::ends_with(filename, ".conda");
+        };
 
-            for (const auto& cache_root : cache_roots)
+        // Package folders are removed by moving them to this directory first
+        auto trash_dir = [](const fs::u8path& cache_root) { return cache_root / ".trash"; };
+
+        // globally, collect installed packages, including in the environments known to the
+        // environments manager which may live outside of the root prefix
+        std::set<std::string> installed_pkgs;
+        if (clean_all || clean_pkgs)
+        {
+            std::vector<fs::u8path> conda_meta_dirs;
+            for (auto& env : envs)
+            {
+                conda_meta_dirs.push_back(env / "conda-meta");
+            }
+            for (const auto& env : EnvironmentsManager(ctx).list_all_known_prefixes())
             {
-                if (!fs::exists(cache_root))
+                const auto conda_meta = env / "conda-meta";
+                if (std::find(conda_meta_dirs.begin(), conda_meta_dirs.end(), conda_meta)
+                    == conda_meta_dirs.end())
                 {
-                    continue;
+                    conda_meta_dirs.push_back(conda_meta);
                 }
-                std::string header_line = util::concat("Package cache folder: ", cache_root.string());
-                std::vector<std::vector<printers::FormattedString>> rows;
-                for (auto it = fs::recursive_directory_iterator(cache_root);
-                     it != fs::recursive_directory_iterator();
-                     ++it)
+            }
+
+            const auto records = mamba_fs::walk_directories(
+                conda_meta_dirs,
                 {
-                    const auto& p = *it;
-                    if (p.is_directory())
-                    {
-                        if (is_inside_cache_metadata(p.path(), cache_root))
-                        {
-                            it.disable_recursion_pending();
-                        }
-                        continue;
-                    }
-                    if (!p.is_directory()
-                        && (util::ends_with(p.path().string(), ".tar.bz2")
-                            || util::ends_with(p.path().string(), ".conda")))
-                    {
-                        res.push_back(p.path());
-                        rows.push_back({ p.path().filename().string(), get_file_size(p.file_size()) });
-                        total_size += p.file_size();
-                    }
+                    /* .skip_directory= */ [](const fs::u8path&) { return true; },
+                    /* .collect_directory= */ {},
+                    /* .collect_file= */
+                    [](const fs::u8path& path)
+                    { return util::ends_with(path.filename().string(), ".json"); },
                 }
-                std::sort(
-                    rows.begin(),
-                    rows.end(),
-                    [](const auto& a, const auto& b) { return a[0].s < b[0].s; }
-                );
-                t.add_rows(cache_root.string(), rows);
-            }
-            if (total_size)
+            );
+            for (const auto& record : records)
             {
-                t.add_rows({}, { { "Total size: ", get_file_size(total_size) } });
-                t.print(std::cout);
+                const auto pkg_name = record.path.filename().string();
+                installed_pkgs.insert(pkg_name.substr(0, pkg_name.size() - 5));
             }
-            return res;
-        };
+        }
 
-        if (clean_all || clean_tarballs)
+        // Tarballs and unused package folders are found, along with their size, in a single
+        // walk of each package cache.
+        std::vector<std::vector<mamba_fs::DirectoryWalkEntry>> cache_contents;
+        if (clean_all || clean_tarballs || clean_pkgs)
         {
-            auto to_be_removed = collect_tarballs();
-            if (!ctx.dry_run)
+            for (const auto& cache_root : cache_roots)
             {
-                Console::instance().print("Cleaning tarballs..");
-
-                if (to_be_removed.size() == 0)
-                {
-                    LOG_INFO << "No cached tarballs found";
-                }
-                else if (!ctx.dry_run && Console::prompt("\nRemove tarballs", 'y'))
-                {
-                    for (auto& tbr : to_be_removed)
+                cache_contents.push_back(mamba_fs::walk_directories(
+                    { cache_root },
                     {
-                        fs::remove(tbr);
+                        /* .skip_directory= */
+                        [&](const fs::u8path& path)
+                        {
+                            return is_inside_cache_metadata(path, cache_root)
+                                   || (path == trash_dir(cache_root));
+                        },
+                        /* .collect_directory= */
+                        [&](const fs::u8path& path)
+                        {
+                            // do not remove installed packages
+                            return !installed_pkgs.contains(path.filename().string())
+                                   && fs::exists(path / "info" / "index.json");
+                        },
+                        /* .collect_file= */ is_tarball,
                     }
-                }
+                ));
             }
         }
 
-        auto get_folder_size = [](auto& p)
-        {
-            std::size_t size = 0;
-            for (auto& fp : fs::recursive_directory_iterator(p))
-            {
-                if (!fp.is_symlink() && !fp.is_directory())
-                {
-                    size += fp.file_size();
-                }
-            }
-            return size;
-        };
-
-        auto collect_package_folders = [&]()
+        auto collect = [&](bool directories, const printers::FormattedString& header_name)
         {
             std::vector<fs::u8path> res;
             std::size_t total_size = 0;
-            std::vector<printers::FormattedString> header = { "Package folder", "Size" };
+            std::vector<printers::FormattedString> header = { header_name, "Size" };
             mamba::printers::Table t(header);
             t.set_alignment({ printers::alignment::left, printers::alignment::right });
             t.set_padding({ 2, 4 });
 
-            for (const auto& cache_root : cache_roots)
+            for (std::size_t i = 0; i < cache_contents.size(); ++i)
             {
-                if (!fs::exists(cache_root))
-                {
-                    continue;
-                }
-                std::string header_line = util::concat("Package cache folder: ", cache_root.string());
                 std::vector<std::vector<printers::FormattedString>> rows;
-                for (auto it = fs::recursive_directory_iterator(cache_root);
-                     it != fs::recursive_directory_iterator();
-                     ++it)
+                for (const auto& entry : cache_contents[i])
                 {
-                    const auto& p = *it;
-                    if (!p.is_directory())
-                    {
-                        continue;
-                    }
-                    if (is_inside_cache_metadata(p.path(), cache_root))
-                    {
-                        it.disable_recursion_pending();
-                        continue;
-                    }
-                    if (fs::exists(p.path() / "info" / "index.json"))
+                    if (entry.is_directory == directories)
                     {
-                        if (installed_pkgs.find(p.path().filename().string()) != installed_pkgs.end())
-                        {
-                            // do not remove installed packages
-                            continue;
-                        }
-                        res.push_back(p.path());
-                        std::size_t folder_size = get_folder_size(p);
-                        rows.push_back({ p.path().filename().string(), get_file_size(folder_size) });
-                        total_size += folder_size;
+                        res.push_back(entry.path);
+                        rows.push_back(
+                            { entry.path.filename().string(), get_file_size(entry.size) }
+                        );
+                        total_size += entry.size;
                     }
                 }
                 std::sort(
@@ -348,7 +309,7 @@ namespace mamba
                     rows.end(),
                     [](const auto& a, const auto& b) { return a[0].s < b[0].s; }
                 );
-                t.add_rows(cache_root.string(), rows);
+                t.add_rows(cache_roots[i].string(), rows);
             }
             if (total_size)
             {
@@ -358,9 +319,49 @@ namespace mamba
             return res;
         };
 
+        // The cache root containing ``path``, collected paths may be nested in a subdirectory
+        auto owning_cache_root = [&](const fs::u8path& path)
+        {
+            fs::u8path owner;
+            for (const auto& cache_root : cache_roots)
+            {
+                if (fs::path_has_prefix(path, cache_root)
+                    && (cache_root.native().size() > owner.native().size()))
+                {
+                    owner = cache_root;
+                }
+            }
+            return owner;
+        };
+
+        // Package folders are cleaned first: when they are moved to the trash, they are removed
+        // in the background while the tarballs are cleaned.
+        std::thread pkgs_removal;
+        on_scope_exit join_pkgs_removal{ [&]
+                                         {
+                                             if (pkgs_removal.joinable())
+                                             {
+                                                 pkgs_removal.join();
+                                             }
+                                         } };
+        std::vector<fs::u8path> pkgs_failed;
         if (clean_all || clean_pkgs)
         {
-            auto to_be_removed = collect_package_folders();
+            auto to_be_removed = collect(/* directories= */ true, "Package folder");
+
+            // What an interrupted cleaning left in the trash is removed as well
+            std::vector<fs::u8path> trash_leftovers;
+            for (const auto& cache_root : cache_roots)
+            {
+                if (fs::is_directory(trash_dir(cache_root)))
+                {
+                    for (const auto& p : fs::directory_iterator(trash_dir(cache_root)))
+                    {
+                        trash_leftovers.push_back(p.path());
+                    }
+                }
+            }
+
             if (!ctx.dry_run)
             {
                 Console::instance().print("Cleaning packages..");
@@ -375,17 +376,89 @@ namespace mamba
                             This does not check for packages installed using
                             symlinks back to the package cache.)");
 
-                    if (Console::prompt("\nRemove unused packages", 'y'))
+                    if (!Console::prompt("\nRemove unused packages", 'y'))
+                    {
+                        to_be_removed.clear();
+                        trash_leftovers.clear();
+                    }
+                    else if (clean_move_to_trash)
                     {
+                        // Renaming is immediate, the folders are then removed in the
+                        // background while the cleaning goes on.
                         for (auto& tbr : to_be_removed)
                         {
-                            fs::remove_all(tbr);
+                            const auto trash = trash_dir(owning_cache_root(tbr));
+                            auto target = trash
+                                          / util::concat(
+                                              tbr.filename().string(),
+                                              ".",
+                                              util::generate_random_alphanumeric_string(8)
+                                          );
+                            std::error_code ec;
+                            fs::create_directories(trash, ec);
+                            fs::rename(tbr, target, ec);
+                            if (!ec)
+                            {
+                                tbr = std::move(target);
+                            }
                         }
                     }
                 }
+
+                to_be_removed.insert(
+                    to_be_removed.end(),
+                    trash_leftovers.begin(),
+                    trash_leftovers.end()
+                );
+                auto remove = [&pkgs_failed, paths = std::move(to_be_removed)]
+                { pkgs_failed = mamba_fs::remove_all_parallel(paths); };
+                if (clean_move_to_trash)
+                {
+                    pkgs_removal = std::thread(std::move(remove));
+                }
+                else
+                {
+                    remove();
+                }
+            }
+        }
+
+        std::vector<fs::u8path> tarballs_failed;
+        if (clean_all || clean_tarballs)
+        {
+            auto to_be_removed = collect(/* directories= */ false, "Package file");
+            if (!ctx.dry_run)
+            {
+                Console::instance().print("Cleaning tarballs..");
+
+                if (to_be_removed.size() == 0)
+                {
+                    LOG_INFO << "No cached tarballs found";
+                }
+                else if (!ctx.dry_run && Console::prompt("\nRemove tarballs", 'y'))
+                {
+                    tarballs_failed = mamba_fs::remove_all_parallel(to_be_removed);
+                }
             }
         }
 
+        if (pkgs_removal.joinable())
+        {
+            pkgs_removal.join();
+        }
+        // Each failure was already logged with its reason
+        if (const auto failed_count = pkgs_failed.size() + tarballs_failed.size();
+            failed_count > 0 && !clean_force_pkgs_dirs)
+        {
+            throw std::runtime_error(
+                util::concat(
+                    "Could not remove ",
+                    std::to_string(failed_count),
+                    " cached package folders and tarballs"
+                )
+            );
+        }
+
         if (clean_force_pkgs_dirs)
         {
             for (auto* cache : caches.writable_caches())
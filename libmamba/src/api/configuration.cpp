@@ -1509,6 +1509,17 @@ namespace mamba
                        "minimum between 10 and the number of CPUs available to the process"
                    ));
 
+        insert(Configurable("use_database_snapshot", &m_context.use_database_snapshot)
+                   .group("Repodata")
+                   .set_rc_configurable()
+                   .set_env_var_names()
+                   .description("Restore the loaded channels from a single snapshot file")
+                   .long_description(unindent(R"(
+                        Store the channels, once loaded in the solver, in a snapshot in the
+                        package cache and restore it as a whole when the same channels are
+                        loaded again with unchanged repodata caches and priorities.
+                        Not used with sharded repodata or on Windows.)")));
+
         // Network
         insert(Configurable("cacert_path", std::string(""))
                    .group("Network")
@@ -1682,6 +1693,16 @@ namespace mamba
                    .set_env_var_names()
                    .description("A list of package specs to pin for every environment resolution"));
 
+        insert(Configurable("use_solution_cache", &m_context.use_solution_cache)
+                   .group("Solver")
+                   .set_rc_configurable()
+                   .set_env_var_names()
+                   .description("Reuse the solution of an identical request")
+                   .long_description(unindent(R"(
+                        Store solutions in the package cache and reuse them, skipping the
+                        solver, when the same request is made against the same repodata,
+                        channel priorities, virtual packages, and installed packages.)")));
+
         insert(Configurable("freeze_installed", false)
                    .group("Solver")
                    .description("Freeze already installed dependencies"));
@@ -1875,6 +1896,16 @@ namespace mamba
                    .set_env_var_names()
                    .description("Defines if PYC files will be compiled or not"));
 
+        insert(Configurable("pyc_cache", &m_context.link_params.pyc_cache)
+                   .group("Extract, Link & Install")
+                   .set_rc_configurable()
+                   .set_env_var_names()
+                   .description("Share compiled PYC files across environments")
+                   .long_description(unindent(R"(
+                        Store the PYC files compiled for noarch python packages in the package
+                        cache, keyed by the hash of their source and the Python version, and
+                        link them into new environments instead of compiling them again.)")));
+
         insert(
             Configurable("skip_run_link_scripts", &m_context.link_params.skip_run_link_scripts)
                 .group("Extract, Link & Install")
@@ -2392,6 +2423,7 @@ namespace mamba
     {
         m_sources.clear();
         m_valid_sources.clear();
+        m_rc_locations_cache.clear();
         m_rc_yaml_nodes_cache.clear();
     }
 
@@ -2517,13 +2549,26 @@ namespace mamba
         {
             if (!m_rc_yaml_nodes_cache.count(s))
             {
-                auto node = load_rc_file(s);
+                const auto node = load_rc_file(s);
                 if (node.IsNull())
                 {
                     continue;
                 }
 
-                m_rc_yaml_nodes_cache.insert({ s, node });
+                auto index = rc_values_index();
+                if (node.IsMap())
+                {
+                    for (const auto& item : node)
+                    {
+                        if (!item.first.IsScalar() || item.second.IsNull())
+                        {
+                            continue;
+                        }
+                        // As with ``node[key]``, the first duplicated key is used
+                        index.try_emplace(item.first.as<std::string>(), item.second);
+                    }
+                }
+                m_rc_yaml_nodes_cache.insert({ s, std::move(index) });
             }
             m_valid_sources.push_back(s);
         }
@@ -2542,13 +2587,11 @@ namespace mamba
 
                 for (const auto& source : m_valid_sources)
                 {
-                    auto yaml = m_rc_yaml_nodes_cache[source];
-                    if (!yaml[key] || yaml[key].IsNull())
+                    const auto& index = m_rc_yaml_nodes_cache[source];
+                    if (const auto value = index.find(key); value != index.cend())
                     {
-                        continue;
+                        c.set_rc_yaml_value(value->second, util::shrink_home(source.string()));
                     }
-
-                    c.set_rc_yaml_value(yaml[key], util::shrink_home(source.string()));
                 }
             }
         }
@@ -2561,18 +2604,30 @@ namespace mamba
 
         for (const fs::u8path& l : possible_rc_paths)
         {
-            if (detail::is_config_file(l))
+            // Locations are searched again for every rc level of the same load
+            if (auto it = m_rc_locations_cache.find(l); it != m_rc_locations_cache.end())
+            {
+                sources.insert(sources.end(), it->second.cbegin(), it->second.cend());
+                continue;
+            }
+
+            auto& found = m_rc_locations_cache[l];
+            // A single stat per location, most of them do not exist
+            std::error_code ec;
+            const auto status = fs::status(l, ec);
+            if (fs::exists(status) && !fs::is_directory(status)
+                && detail::has_config_name(l.string()))
             {
-                sources.push_back(l);
+                found.push_back(l);
                 LOG_TRACE << "Configuration found at '" << l.string() << "'";
             }
-            else if (fs::is_directory(l))
+            else if (fs::is_directory(status))
             {
                 for (fs::u8path p : fs::directory_iterator(l))
                 {
                     if (detail::is_config_file(p))
                     {
-                        sources.push_back(p);
+                        found.push_back(p);
                         LOG_TRACE << "Configuration found at '" << p.string() << "'";
                     }
                     else
@@ -2588,6 +2643,7 @@ namespace mamba
                     LOG_TRACE << "Configuration not found at '" << l.string() << "'";
                 }
             }
+            sources.insert(sources.end(), found.cbegin(), found.cend());
         }
 
         return sources;
@@ -0,0 +1,765 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <variant>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include "mamba/api/channel_loader.hpp"
+#include "mamba/api/configuration.hpp"
+#include "mamba/api/daemon.hpp"
+#include "mamba/core/channel_context.hpp"
+#include "mamba/core/context.hpp"
+#include "mamba/core/error_handling.hpp"
+#include "mamba/core/output.hpp"
+#include "mamba/core/package_cache.hpp"
+#include "mamba/core/package_database_loader.hpp"
+#include "mamba/core/thread_utils.hpp"
+#include "mamba/core/util_scope.hpp"
+#include "mamba/solver/libsolv/database.hpp"
+#include "mamba/solver/libsolv/solver.hpp"
+#include "mamba/solver/libsolv/unsolvable.hpp"
+#include "mamba/util/cryptography.hpp"
+#include "mamba/util/environment.hpp"
+
+#include "utils.hpp"
+
+namespace mamba
+{
+    namespace
+    {
+        /** The part of the configuration that the daemon and its clients must share. */
+        auto daemon_environment(const Context& ctx) -> nlohmann::json
+        {
+            // The settings of the database loaded by the daemon, without any repository
+            const auto database = solver::libsolv::Database(
+                {},
+                solver_database_settings(ctx.experimental_matchspec_parsing)
+            );
+            return {
+                { "channels", ctx.channels },
+                { "custom_channels", ctx.custom_channels },
+                { "custom_multichannels", ctx.custom_multichannels },
+                { "channel_alias", ctx.channel_alias },
+                { "platform", ctx.platform },
+                { "experimental_matchspec_parsing", ctx.experimental_matchspec_parsing },
+                { "channel_loading", channel_loading_key(ctx, database) },
+            };
+        }
+
+        auto make_request(const Context& ctx, std::string_view command) -> nlohmann::json
+        {
+            return {
+                { "version", daemon_protocol_version },
+                { "command", command },
+                { "environment", daemon_environment(ctx) },
+            };
+        }
+
+        auto error_reply(std::string_view message) -> nlohmann::json
+        {
+            return { { "status", "error" }, { "message", message } };
+        }
+
+#ifndef _WIN32
+#ifdef MSG_NOSIGNAL
+        constexpr int send_flags = MSG_NOSIGNAL;
+#else
+        constexpr int send_flags = 0;
+#endif
+
+        /** Do not get killed by ``SIGPIPE`` when the peer goes away. */
+        void ignore_sigpipe([[maybe_unused]] int fd)
+        {
+#ifdef SO_NOSIGPIPE
+            int on = 1;
+            ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+        }
+
+        /** How long the daemon waits for a client to send its request or read the reply. */
+        constexpr auto server_io_timeout = std::chrono::seconds(10);
+        /** How long a client waits for the daemon to answer. */
+        constexpr auto client_io_timeout = std::chrono::seconds(60);
+        /** Connections served concurrently, the others wait in the listen backlog. */
+        constexpr std::size_t max_connections = 16;
+
+        void set_send_timeout(int fd, std::chrono::seconds timeout)
+        {
+            auto tv = ::timeval{};
+            tv.tv_sec = static_cast<decltype(tv.tv_sec)>(timeout.count());
+            ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        }
+
+        /** Whether the process on the other end of the socket runs as the current user. */
+        auto is_peer_current_user(int fd) -> bool
+        {
+#if defined(__linux__)
+            auto cred = ::ucred{};
+            auto len = static_cast<::socklen_t>(sizeof(cred));
+            if (::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0)
+            {
+                return false;
+            }
+            return cred.uid == ::getuid();
+#else
+            auto uid = ::uid_t{};
+            auto gid = ::gid_t{};
+            if (::getpeereid(fd, &uid, &gid) != 0)
+            {
+                return false;
+            }
+            return uid == ::getuid();
+#endif
+        }
+
+        /**
+         * Whether only the current user can create or replace files in ``dir``.
+         *
+         * Symbolic links are not followed, so that they cannot redirect to another directory.
+         */
+        auto is_private_directory(const fs::u8path& dir) -> bool
+        {
+            struct ::stat st = {};
+            if (::lstat(dir.string().c_str(), &st) != 0)
+            {
+                return false;
+            }
+            return S_ISDIR(st.st_mode) && (st.st_uid == ::getuid()) && ((st.st_mode & 0077) == 0);
+        }
+
+        /** Create the directory of the socket, only accessible to the current user. */
+        void make_private_directory(const fs::u8path& dir)
+        {
+            std::error_code ec;
+            fs::create_directories(dir.parent_path(), ec);
+            if ((::mkdir(dir.string().c_str(), 0700) != 0) && (errno != EEXIST))
+            {
+                throw mamba_error(
+                    fmt::format("Could not create '{}': {}", dir.string(), std::strerror(errno)),
+                    mamba_error_code::internal_failure
+                );
+            }
+            if (!is_private_directory(dir))
+            {
+                throw mamba_error(
+                    fmt::format(
+                        "Daemon socket directory '{}' must be a directory owned by the current "
+                        "user and only accessible to them",
+                        dir.string()
+                    ),
+                    mamba_error_code::incorrect_usage
+                );
+            }
+        }
+
+        /** Owning wrapper around a file descriptor. */
+        class FileDescriptor
+        {
+        public:
+
+            explicit FileDescriptor(int fd = -1)
+                : m_fd(fd)
+            {
+            }
+
+            FileDescriptor(const FileDescriptor&) = delete;
+            auto operator=(const FileDescriptor&) -> FileDescriptor& = delete;
+
+            FileDescriptor(FileDescriptor&& other) noexcept
+                : m_fd(std::exchange(other.m_fd, -1))
+            {
+            }
+
+            auto operator=(FileDescriptor&& other) noexcept -> FileDescriptor&
+            {
+                std::swap(m_fd, other.m_fd);
+                return *this;
+            }
+
+            ~FileDescriptor()
+            {
+                if (m_fd >= 0)
+                {
+                    ::close(m_fd);
+                }
+            }
+
+            [[nodiscard]] auto get() const -> int
+            {
+                return m_fd;
+            }
+
+            [[nodiscard]] auto valid() const -> bool
+            {
+                return m_fd >= 0;
+            }
+
+        private:
+
+            int m_fd;
+        };
+
+        auto make_address(const fs::u8path& socket_path) -> std::optional<::sockaddr_un>
+        {
+            auto address = ::sockaddr_un{};
+            address.sun_family = AF_UNIX;
+            const auto path = socket_path.string();
+            if (path.size() >= sizeof(address.sun_path))
+            {
+                return std::nullopt;
+            }
+            std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+            return address;
+        }
+
+        auto connect_to(const fs::u8path& socket_path) -> FileDescriptor
+        {
+            const auto address = make_address(socket_path);
+            if (!address.has_value())
+            {
+                return FileDescriptor();
+            }
+            auto fd = FileDescriptor(::socket(AF_UNIX, SOCK_STREAM, 0));
+            if (!fd.valid())
+            {
+                return fd;
+            }
+            ignore_sigpipe(fd.get());
+            const auto* addr = reinterpret_cast<const ::sockaddr*>(&address.value());
+            if (::connect(fd.get(), addr, sizeof(::sockaddr_un)) != 0)
+            {
+                return FileDescriptor();
+            }
+            return fd;
+        }
+
+        auto write_all(int fd, std::string_view data) -> bool
+        {
+            while (!data.empty())
+            {
+                const auto n = ::send(fd, data.data(), data.size(), send_flags);
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    return false;
+                }
+                data.remove_prefix(static_cast<std::size_t>(n));
+            }
+            return true;
+        }
+
+        /** Read until the peer half-closes the connection, giving up after ``timeout``. */
+        auto read_all(int fd, std::chrono::seconds timeout) -> std::optional<std::string>
+        {
+            using clock = std::chrono::steady_clock;
+            const auto deadline = clock::now() + timeout;
+            auto data = std::string();
+            char buffer[65536];
+            while (true)
+            {
+                const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(
+                    deadline - clock::now()
+                );
+                if (remaining.count() <= 0)
+                {
+                    return std::nullopt;
+                }
+                auto pfd = ::pollfd{ fd, POLLIN, 0 };
+                const auto ready = ::poll(&pfd, 1, static_cast<int>(remaining.count()));
+                if (ready < 0 && errno != EINTR)
+                {
+                    return std::nullopt;
+                }
+                if (ready <= 0)
+                {
+                    continue;
+                }
+                const auto n = ::recv(fd, buffer, sizeof(buffer), 0);
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    return std::nullopt;
+                }
+                if (n == 0)
+                {
+                    return data;
+                }
+                data.append(buffer, static_cast<std::size_t>(n));
+            }
+        }
+
+        class Daemon
+        {
+        public:
+
+            Daemon(Context& ctx, const DaemonOptions& options)
+                : m_ctx(ctx)
+                , m_options(options)
+                , m_environment(daemon_environment(ctx))
+                , m_database(load_database())
+            {
+            }
+
+            void serve(int listen_fd)
+            {
+                auto refresher = std::thread([this] { refresh_loop(); });
+                on_scope_exit stop_refresher{ [&]
+                                              {
+                                                  {
+                                                      auto lock = std::lock_guard(m_refresh_mutex);
+                                                      m_stop = true;
+                                                  }
+                                                  m_refresh_cv.notify_all();
+                                                  refresher.join();
+                                              } };
+
+                on_scope_exit wait_connections{ [&] { wait_for_connections(0); } };
+
+                while (!is_sig_interrupted())
+                {
+                    auto pfd = ::pollfd{ listen_fd, POLLIN, 0 };
+                    // Wake up regularly to check for interruptions
+                    if (::poll(&pfd, 1, 500) <= 0)
+                    {
+                        continue;
+                    }
+                    auto client = FileDescriptor(::accept(listen_fd, nullptr, nullptr));
+                    if (!client.valid())
+                    {
+                        continue;
+                    }
+                    if (!is_peer_current_user(client.get()))
+                    {
+                        LOG_WARNING << "Daemon rejected a connection from another user";
+                        continue;
+                    }
+                    ignore_sigpipe(client.get());
+                    set_send_timeout(client.get(), server_io_timeout);
+
+                    // Only this thread adds connections
+                    wait_for_connections(max_connections - 1);
+                    {
+                        auto lock = std::lock_guard(m_connections_mutex);
+                        ++m_connections;
+                    }
+                    // A slow client must not hold up the others
+                    std::thread(
+                        [this, fd = std::move(client)]() mutable
+                        {
+                            try
+                            {
+                                handle_connection(std::move(fd));
+                            }
+                            catch (const std::exception& e)
+                            {
+                                LOG_DEBUG << "Daemon could not handle connection: " << e.what();
+                            }
+                            auto lock = std::lock_guard(m_connections_mutex);
+                            --m_connections;
+                            m_connections_cv.notify_all();
+                        }
+                    ).detach();
+                }
+            }
+
+        private:
+
+            using Database = solver::libsolv::Database;
+
+            Context& m_ctx;
+            DaemonOptions m_options;
+            nlohmann::json m_environment;
+
+            std::mutex m_database_mutex;
+            Database m_database;
+
+            std::mutex m_refresh_mutex;
+            std::condition_variable m_refresh_cv;
+            bool m_stop = false;
+
+            std::mutex m_connections_mutex;
+            std::condition_variable m_connections_cv;
+            std::size_t m_connections = 0;
+
+            /** Wait until at most ``count`` connections are being served. */
+            void wait_for_connections(std::size_t count)
+            {
+                auto lock = std::unique_lock(m_connections_mutex);
+                m_connections_cv.wait(lock, [&] { return m_connections <= count; });
+            }
+
+            auto load_database() -> Database
+            {
+                auto channel_context = ChannelContext::make_conda_compatible(m_ctx);
+                // Same matchspec parser as a local repoquery, so that results do not depend
+                // on whether a daemon is running
+                auto db = make_solver_database(
+                    m_ctx.experimental_matchspec_parsing,
+                    channel_context
+                );
+                MultiPackageCache package_caches(m_ctx.pkgs_dirs, m_ctx.validation_params);
+                // Without root packages, the full repodata is loaded, even for sharded channels
+                auto exp_load = load_channels(m_ctx, channel_context, db, package_caches);
+                if (!exp_load)
+                {
+                    throw std::runtime_error(exp_load.error().what());
+                }
+                return db;
+            }
+
+            void refresh_loop()
+            {
+                auto lock = std::unique_lock(m_refresh_mutex);
+                const auto stopped = [&] { return m_stop; };
+                while (!m_refresh_cv.wait_for(lock, m_options.refresh_interval, stopped))
+                {
+                    lock.unlock();
+                    try
+                    {
+                        // Loading happens outside of the lock so that requests are still served
+                        auto db = load_database();
+                        auto db_lock = std::lock_guard(m_database_mutex);
+                        m_database = std::move(db);
+                        LOG_INFO << "Daemon repodata reloaded";
+                    }
+                    catch (const std::exception& e)
+                    {
+                        LOG_WARNING << "Daemon could not reload repodata: " << e.what();
+                    }
+                    lock.lock();
+                }
+            }
+
+            void handle_connection(FileDescriptor client)
+            {
+                const int fd = client.get();
+                auto reply = nlohmann::json();
+                if (auto data = read_all(fd, server_io_timeout))
+                {
+                    try
+                    {
+                        reply = handle_request(nlohmann::json::parse(data.value()));
+                    }
+                    catch (const std::exception& e)
+                    {
+                        reply = error_reply(e.what());
+                    }
+                }
+                else
+                {
+                    reply = error_reply("Could not read request");
+                }
+                // Replace invalid UTF-8 rather than throwing, messages may come from the system
+                using error_handler_t = nlohmann::json::error_handler_t;
+                const auto dumped = reply.dump(-1, ' ', false, error_handler_t::replace);
+                if (!write_all(fd, dumped))
+                {
+                    LOG_DEBUG << "Daemon could not send reply";
+                }
+            }
+
+            auto handle_request(const nlohmann::json& request) -> nlohmann::json
+            {
+                if (request.at("version").get<int>() != daemon_protocol_version)
+                {
+                    return error_reply("Unsupported protocol version");
+                }
+                if (request.at("environment") != m_environment)
+                {
+                    return error_reply("Channel configuration differs from the daemon's");
+                }
+
+                const auto command = request.at("command").get<std::string>();
+                if (command == "repoquery")
+                {
+                    return handle_repoquery(request);
+                }
+                if (command == "solve")
+                {
+                    return handle_solve(request);
+                }
+                return error_reply(fmt::format(R"(Unknown command "{}")", command));
+            }
+
+            auto handle_repoquery(const nlohmann::json& request) -> nlohmann::json
+            {
+                const auto type = query_type_parse(request.at("type").get<std::string>());
+                const auto format = static_cast<QueryResultFormat>(request.at("format").get<int>());
+                if (format == QueryResultFormat::Json)
+                {
+                    return error_reply("JSON output is not supported");
+                }
+                const auto queries = request.at("queries").get<std::vector<std::string>>();
+
+                auto out = std::ostringstream();
+                auto lock = std::lock_guard(m_database_mutex);
+                const bool found = make_repoquery(
+                    m_database,
+                    type,
+                    format,
+                    queries,
+                    request.at("show_all_builds").get<bool>(),
+                    m_ctx.graphics_params,
+                    out
+                );
+                return { { "status", "ok" }, { "found", found }, { "output", out.str() } };
+            }
+
+            auto handle_solve(const nlohmann::json& request) -> nlohmann::json
+            {
+                const auto solver_request = request.at("request").get<solver::Request>();
+                using package_list = std::vector<specs::PackageInfo>;
+                const auto installed = request.at("installed").get<package_list>();
+                const auto virtual_packages = request.at("virtual_packages").get<package_list>();
+
+                // The installed packages of the client must not leak into other requests
+                auto db = [&]
+                {
+                    auto lock = std::lock_guard(m_database_mutex);
+                    return m_database.clone();
+                }();
+                load_installed_packages_in_database(db, installed, virtual_packages);
+
+                auto outcome = solver::libsolv::Solver().solve(
+                    db,
+                    solver_request,
+                    solver_matchspec_parser(m_ctx)
+                );
+                if (!outcome)
+                {
+                    return error_reply(outcome.error().what());
+                }
+                if (std::holds_alternative<solver::libsolv::UnSolvable>(outcome.value()))
+                {
+                    return { { "status", "unsolvable" } };
+                }
+                return {
+                    { "status", "ok" },
+                    { "solution", std::get<solver::Solution>(outcome.value()) },
+                };
+            }
+        };
+
+        auto listen_on(const fs::u8path& socket_path) -> FileDescriptor
+        {
+            const auto address = make_address(socket_path);
+            if (!address.has_value())
+            {
+                throw mamba_error(
+                    fmt::format("Daemon socket path is too long: '{}'", socket_path.string()),
+                    mamba_error_code::incorrect_usage
+                );
+            }
+
+            if (connect_to(socket_path).valid())
+            {
+                throw mamba_error(
+                    fmt::format("A daemon is already listening on '{}'", socket_path.string()),
+                    mamba_error_code::incorrect_usage
+                );
+            }
+            make_private_directory(socket_path.parent_path());
+            // Leftover from a daemon that did not exit cleanly
+            std::error_code ec;
+            fs::remove(socket_path, ec);
+
+            auto fd = FileDescriptor(::socket(AF_UNIX, SOCK_STREAM, 0));
+            const auto* addr = reinterpret_cast<const ::sockaddr*>(&address.value());
+            // Only the current user may talk to the daemon, this is also checked on connection
+            const auto previous_mask = ::umask(0077);
+            const bool bound = fd.valid() && (::bind(fd.get(), addr, sizeof(::sockaddr_un)) == 0);
+            ::umask(previous_mask);
+            if (!bound || (::listen(fd.get(), SOMAXCONN) != 0))
+            {
+                throw mamba_error(
+                    fmt::format(
+                        "Could not listen on '{}': {}",
+                        socket_path.string(),
+                        std::strerror(errno)
+                    ),
+                    mamba_error_code::internal_failure
+                );
+            }
+            return fd;
+        }
+#endif
+    }
+
+    auto daemon_socket_path(const Context& ctx) -> fs::u8path
+    {
+        auto runtime_dir = util::get_env("XDG_RUNTIME_DIR");
+        const auto base = fs::u8path(runtime_dir.value_or(fs::temp_directory_path().string()));
+#ifndef _WIN32
+        const auto user = ::getuid();
+#else
+        const auto user = util::get_env("USERNAME").value_or("");
+#endif
+        // Short enough to fit in a socket address.
+        // The directory is private to the user, since the temporary directory may be shared.
+        const auto key = fmt::format("{}|{}", user, ctx.prefix_params.root_prefix.string());
+        const auto id = util::Sha256Hasher().str_hex_str(key).substr(0, 16);
+        return base / fmt::format("mamba-daemon-{}", user) / fmt::format("{}.sock", id);
+    }
+
+    void run_daemon(Configuration& config, const DaemonOptions& options)
+    {
+#ifndef _WIN32
+        config.load();
+        auto& ctx = config.context();
+
+        auto opts = options;
+        if (opts.socket_path.empty())
+        {
+            opts.socket_path = daemon_socket_path(ctx);
+        }
+
+        auto listen_fd = listen_on(opts.socket_path);
+        on_scope_exit remove_socket{ [&]
+                                     {
+                                         std::error_code ec;
+                                         fs::remove(opts.socket_path, ec);
+                                     } };
+        auto daemon = Daemon(ctx, opts);
+
+        Console::stream() << "Daemon listening on " << opts.socket_path.string() << std::endl;
+        daemon.serve(listen_fd.get());
+#else
+        static_cast<void>(config);
+        static_cast<void>(options);
+        throw mamba_error(
+            "The daemon is not supported on Windows",
+            mamba_error_code::incorrect_usage
+        );
+#endif
+    }
+
+    auto daemon_request(const fs::u8path& socket_path, const nlohmann::json& request)
+        -> std::optional<nlohmann::json>
+    {
+#ifndef _WIN32
+        // Do not trust a socket that another user could have created
+        if (!is_private_directory(socket_path.parent_path()))
+        {
+            return std::nullopt;
+        }
+        auto fd = connect_to(socket_path);
+        if (!fd.valid())
+        {
+            return std::nullopt;
+        }
+        if (!is_peer_current_user(fd.get()))
+        {
+            LOG_WARNING << "Ignoring daemon socket '" << socket_path.string()
+                        << "' owned by another user";
+            return std::nullopt;
+        }
+        set_send_timeout(fd.get(), client_io_timeout);
+        if (!write_all(fd.get(), request.dump()) || (::shutdown(fd.get(), SHUT_WR) != 0))
+        {
+            return std::nullopt;
+        }
+        auto data = read_all(fd.get(), client_io_timeout);
+        if (!data.has_value())
+        {
+            return std::nullopt;
+        }
+        auto reply = nlohmann::json::parse(data.value(), nullptr, /* allow_exceptions= */ false);
+        if (reply.is_discarded())
+        {
+            return std::nullopt;
+        }
+        if (reply.value("status", "") == "error")
+        {
+            LOG_DEBUG << "Daemon could not serve request: " << reply.value("message", "");
+        }
+        return reply;
+#else
+        static_cast<void>(socket_path);
+        static_cast<void>(request);
+        return std::nullopt;
+#endif
+    }
+
+    auto daemon_repoquery(
+        const Context& ctx,
+        QueryType type,
+        QueryResultFormat format,
+        const std::vector<std::string>& queries,
+        std::ostream& out
+    ) -> std::optional<bool>
+    {
+        if (format == QueryResultFormat::Json)
+        {
+            return std::nullopt;
+        }
+        auto request = make_request(ctx, "repoquery");
+        request["type"] = enum_name(type);
+        request["format"] = static_cast<int>(format);
+        request["queries"] = queries;
+        request["show_all_builds"] = ctx.output_params.verbosity > 0;
+
+        const auto reply = daemon_request(daemon_socket_path(ctx), request);
+        if (!reply.has_value() || (reply->value("status", "") != "ok"))
+        {
+            return std::nullopt;
+        }
+        out << reply->at("output").get<std::string>();
+        return reply->at("found").get<bool>();
+    }
+
+    auto daemon_solve(
+        const Context& ctx,
+        const solver::Request& request,
+        const std::vector<specs::PackageInfo>& installed,
+        const std::vector<specs::PackageInfo>& virtual_packages
+    ) -> std::optional<solver::Solution>
+    {
+        auto daemon_req = make_request(ctx, "solve");
+        daemon_req["request"] = request;
+        daemon_req["installed"] = installed;
+        daemon_req["virtual_packages"] = virtual_packages;
+
+        const auto reply = daemon_request(daemon_socket_path(ctx), daemon_req);
+        if (!reply.has_value() || (reply->value("status", "") != "ok"))
+        {
+            return std::nullopt;
+        }
+        try
+        {
+            return reply->at("solution").get<solver::Solution>();
+        }
+        catch (const std::exception& e)
+        {
+            LOG_DEBUG << "Invalid solution from daemon: " << e.what();
+            return std::nullopt;
+        }
+    }
+}
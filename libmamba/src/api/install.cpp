@@ -12,6 +12,7 @@
 
 #include "mamba/api/channel_loader.hpp"
 #include "mamba/api/configuration.hpp"
+#include "mamba/api/daemon.hpp"
 #include "mamba/api/install.hpp"
 #include "mamba/core/channel_context.hpp"
 #include "mamba/core/context.hpp"
@@ -23,6 +24,7 @@
 #include "mamba/core/package_database_loader.hpp"
 #include "mamba/core/pinning.hpp"
 #include "mamba/core/transaction.hpp"
+#include "mamba/core/virtual_packages.hpp"
 #include "mamba/download/downloader.hpp"
 #include "mamba/fs/filesystem.hpp"
 #include "mamba/specs/match_spec.hpp"
@@ -583,6 +585,142 @@ namespace mamba
             auto& no_env = config.at("no_env").value<bool>();
 
             validate_target_prefix_and_channels(ctx, create_env);
+
+            const auto make_request = [&](PrefixData& prefix_data)
+            {
+                auto request = create_install_request(
+                    prefix_data,
+                    raw_specs,
+                    InstallRequestOptions{
+                        .freeze_installed = freeze_installed,
+                        .prefix_data_interoperability = ctx.prefix_data_interoperability,
+                    }
+                );
+                add_pins_to_request(request, ctx, prefix_data, raw_specs, no_pin, no_py_pin);
+                return request;
+            };
+
+            const auto print_pins = [](const solver::Request& request)
+            {
+                auto out = Console::stream();
+                print_request_pins_to(request, out);
+                // Console stream prints on destruction
+            };
+
+            const auto execute = [&](solver::libsolv::Database db,
+                                     PrefixData& prefix_data,
+                                     const solver::Request& request,
+                                     const solver::libsolv::Solver::Outcome& outcome,
+                                     MultiPackageCache& package_caches)
+            {
+                std::vector<LockFile> locks;
+
+                for (auto& c : ctx.pkgs_dirs)
+                {
+                    locks.push_back(LockFile(c));
+                }
+
+                Console::instance().set_json_output_success(true);
+
+                auto trans = make_transaction_from_solution(
+                    ctx,
+                    std::move(db),
+                    request,
+                    outcome,
+                    package_caches
+                );
+
+                Console::stream();
+                bool transaction_accepted = execute_transaction(
+                    trans,
+                    ctx,
+                    channel_context,
+                    prefix_data,
+                    /* before_execute= */
+                    [&]()
+                    {
+                        if (create_env && !ctx.dry_run)
+                        {
+                            detail::create_target_directory(ctx, ctx.prefix_params.target_prefix);
+                        }
+                        detail::populate_state_file(
+                            ctx.prefix_params.target_prefix,
+                            env_vars,
+                            no_env
+                        );
+                    },
+                    /* after_execute= */
+                    [&]()
+                    {
+                        if (create_env && !ctx.dry_run)
+                        {
+                            print_activation_message(ctx);
+                        }
+                    },
+                    /* on_abort= */
+                    [&]()
+                    {
+                        // Aborting new env creation
+                        // but the directory was already created because of
+                        // `store_platform_config` call
+                        // => Remove the created directory
+                        if (remove_prefix_on_failure
+                            && fs::is_directory(ctx.prefix_params.target_prefix))
+                        {
+                            fs::remove_all(ctx.prefix_params.target_prefix);
+                        }
+                    }
+                );
+                const auto other_specs = config.at("others_pkg_mgrs_specs")
+                                             .value<std::vector<detail::other_pkg_mgr_spec>>();
+                execute_other_pkg_managers_if_needed(
+                    transaction_accepted,
+                    ctx.dry_run,
+                    other_specs,
+                    ctx,
+                    pip::Update::No
+                );
+            };
+
+            // A dry run only needs a solution, which a running daemon computes from its warm
+            // database so that the channels are not loaded here.
+            // Unsolvable requests are solved again locally to explain the problems.
+            if (ctx.dry_run && !is_retry)
+            {
+                populate_context_channels_from_specs(raw_specs, ctx);
+                auto maybe_prefix_data = PrefixData::create(
+                    ctx.prefix_params.target_prefix,
+                    channel_context
+                );
+                if (maybe_prefix_data)
+                {
+                    auto& prefix_data = maybe_prefix_data.value();
+                    const auto installed = installed_packages_for_database(ctx, prefix_data);
+                    const auto virtual_packages = get_virtual_packages(ctx.platform);
+                    auto request = make_request(prefix_data);
+                    if (auto solution = daemon_solve(ctx, request, installed, virtual_packages))
+                    {
+                        LOG_INFO << "Request solved by the daemon";
+                        print_pins(request);
+                        // The transaction only needs the installed packages
+                        auto db = make_solver_database(
+                            ctx.experimental_matchspec_parsing,
+                            channel_context
+                        );
+                        load_installed_packages_in_database(db, installed, virtual_packages);
+                        MultiPackageCache package_caches(ctx.pkgs_dirs, ctx.validation_params);
+                        execute(
+                            std::move(db),
+                            prefix_data,
+                            request,
+                            solver::libsolv::Solver::Outcome{ std::move(solution).value() },
+                            package_caches
+                        );
+                        return;
+                    }
+                }
+            }
+
             auto [db, package_caches] = prepare_solver_context(
                 ctx,
                 channel_context,
@@ -593,22 +731,10 @@ namespace mamba
 
             auto prefix_data = load_prefix_data_and_installed(ctx, channel_context, db);
 
-            auto request = create_install_request(
-                prefix_data,
-                raw_specs,
-                InstallRequestOptions{ .freeze_installed = freeze_installed,
-                                       .prefix_data_interoperability = ctx.prefix_data_interoperability }
-            );
-
-            add_pins_to_request(request, ctx, prefix_data, raw_specs, no_pin, no_py_pin);
-
-            {
-                auto out = Console::stream();
-                print_request_pins_to(request, out);
-                // Console stream prints on destruction
-            }
+            auto request = make_request(prefix_data);
+            print_pins(request);
 
-            auto outcome = solve_request_with_status(ctx.experimental_matchspec_parsing, db, request);
+            auto outcome = solve_request_with_status(ctx, db, request);
 
             if (handle_unsolvable_with_retry(
                     outcome,
@@ -647,61 +773,7 @@ namespace mamba
                 return;
             }
 
-            std::vector<LockFile> locks;
-
-            for (auto& c : ctx.pkgs_dirs)
-            {
-                locks.push_back(LockFile(c));
-            }
-
-            Console::instance().set_json_output_success(true);
-
-            auto trans = make_transaction_from_solution(ctx, std::move(db), request, outcome, package_caches);
-
-            Console::stream();
-            bool transaction_accepted = execute_transaction(
-                trans,
-                ctx,
-                channel_context,
-                prefix_data,
-                /* before_execute= */
-                [&]()
-                {
-                    if (create_env && !ctx.dry_run)
-                    {
-                        detail::create_target_directory(ctx, ctx.prefix_params.target_prefix);
-                    }
-                    detail::populate_state_file(ctx.prefix_params.target_prefix, env_vars, no_env);
-                },
-                /* after_execute= */
-                [&]()
-                {
-                    if (create_env && !ctx.dry_run)
-                    {
-                        print_activation_message(ctx);
-                    }
-                },
-                /* on_abort= */
-                [&]()
-                {
-                    // Aborting new env creation
-                    // but the directory was already created because of `store_platform_config` call
-                    // => Remove the created directory
-                    if (remove_prefix_on_failure && fs::is_directory(ctx.prefix_params.target_prefix))
-                    {
-                        fs::remove_all(ctx.prefix_params.target_prefix);
-                    }
-                }
-            );
-            const auto other_specs = config.at("others_pkg_mgrs_specs")
-                                         .value<std::vector<detail::other_pkg_mgr_spec>>();
-            execute_other_pkg_managers_if_needed(
-                transaction_accepted,
-                ctx.dry_run,
-                other_specs,
-                ctx,
-                pip::Update::No
-            );
+            execute(std::move(db), prefix_data, request, outcome, package_caches);
         }
     }
 
@@ -1224,7 +1296,9 @@ namespace mamba
                 throw std::runtime_error(maybe_prefix_data.error().what());
             }
             PrefixData& prefix_data = maybe_prefix_data.value();
-            const auto user_requests = prefix_data.history().get_user_requests();
+            const auto user_requests = prefix_data.history().get_user_requests_after(
+                target_revision
+            );
 
             PackageDiff pkg_diff = PackageDiff::from_revision(user_requests, target_revision);
             auto removed_pkg_diff = pkg_diff.removed_pkg_diff;
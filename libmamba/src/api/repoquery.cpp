@@ -8,6 +8,7 @@
 
 #include "mamba/api/channel_loader.hpp"
 #include "mamba/api/configuration.hpp"
+#include "mamba/api/daemon.hpp"
 #include "mamba/api/repoquery.hpp"
 #include "mamba/core/channel_context.hpp"
 #include "mamba/core/package_cache.hpp"
@@ -38,14 +39,7 @@ namespace mamba
             return {};
         }
 
-        auto repoquery_init(
-            Context& ctx,
-            Configuration& config,
-            QueryType type,
-            QueryResultFormat format,
-            bool use_local,
-            const std::vector<std::string>& queries
-        )
+        void repoquery_load_config(Configuration& config)
         {
             config.at("use_target_prefix_fallback").set_value(true);
             config.at("use_default_prefix_fallback").set_value(true);
@@ -55,7 +49,16 @@ namespace mamba
                     MAMBA_ALLOW_EXISTING_PREFIX | MAMBA_ALLOW_MISSING_PREFIX | MAMBA_ALLOW_NOT_ENV_PREFIX
                 );
             config.load();
+        }
 
+        auto repoquery_init(
+            Context& ctx,
+            QueryType type,
+            QueryResultFormat format,
+            bool use_local,
+            const std::vector<std::string>& queries
+        )
+        {
             auto channel_context = ChannelContext::make_conda_compatible(ctx);
             solver::libsolv::Database db{
                 channel_context.params(),
@@ -217,7 +220,18 @@ namespace mamba
     )
     {
         auto& ctx = config.context();
-        auto db = repoquery_init(ctx, config, type, format, use_local, queries);
+        repoquery_load_config(config);
+
+        if (!use_local)
+        {
+            // A running daemon already has the channels loaded
+            if (auto found = daemon_repoquery(ctx, type, format, queries, std::cout))
+            {
+                return found.value();
+            }
+        }
+
+        auto db = repoquery_init(ctx, type, format, use_local, queries);
         return make_repoquery(
             db,
             type,
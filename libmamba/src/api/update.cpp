@@ -186,7 +186,7 @@ namespace mamba
                 // Console stream prints on destruction
             }
 
-            auto outcome = solve_request_with_status(ctx.experimental_matchspec_parsing, db, request);
+            auto outcome = solve_request_with_status(ctx, db, request);
 
             if (handle_unsolvable_with_retry(
                     outcome,
@@ -7,6 +7,8 @@
 #include <cctype>
 #include <chrono>
 #include <fstream>
+#include <future>
+#include <optional>
 #include <unordered_set>
 
 #include <fmt/color.h>
@@ -28,11 +30,14 @@
 #include "mamba/core/package_cache.hpp"
 #include "mamba/core/package_database_loader.hpp"
 #include "mamba/core/prefix_data.hpp"
+#include "mamba/core/repodata_prefilter.hpp"
 #include "mamba/core/transaction.hpp"
 #include "mamba/core/util.hpp"
 #include "mamba/core/util_os.hpp"
+#include "mamba/core/virtual_packages.hpp"
 #include "mamba/fs/filesystem.hpp"
 #include "mamba/solver/libsolv/database.hpp"
+#include "mamba/solver/libsolv/solution_cache.hpp"
 #include "mamba/solver/request.hpp"
 #include "mamba/specs/match_spec.hpp"
 #include "mamba/specs/version_spec.hpp"
@@ -289,7 +294,7 @@ namespace mamba
             fmt::join(deps, ", ")
         );
 
-        fmt::print(LOG_INFO, "Calling: {}", fmt::join(command, " "));
+        LOG_INFO << fmt::format("Calling: {}", fmt::join(command, " "));
 
         auto [status, ec] = reproc::run(wrapped_command, options);
         assert_reproc_success(options, status, ec);
@@ -483,11 +488,40 @@ namespace mamba
     }
 
     solver::libsolv::Solver::Outcome solve_request_with_status(
-        bool experimental_matchspec_parsing,
+        const Context& ctx,
         solver::libsolv::Database& db,
         const solver::Request& request
     )
     {
+        const auto ms_parser = solver_matchspec_parser(ctx);
+
+        auto cache = std::optional<solver::libsolv::SolutionCache>();
+        auto cache_key = std::string();
+        if (ctx.use_solution_cache)
+        {
+            MultiPackageCache package_caches(ctx.pkgs_dirs, ctx.validation_params);
+            // No writable package cache, do not fall back on the working directory
+            if (const auto pkgs_dir = package_caches.first_writable_path(); !pkgs_dir.empty())
+            {
+                cache.emplace(pkgs_dir / "cache" / "solutions");
+                cache_key = solver::libsolv::SolutionCache::key(db, request, ms_parser);
+            }
+        }
+        if (cache.has_value())
+        {
+            if (auto solution = cache->load(db, cache_key))
+            {
+                if (Console::can_report_status())
+                {
+                    Console::instance().print_in_place(
+                        fmt::format("{:<85} {:>20}", "Resolving Environment", "✔ Cached"),
+                        true
+                    );
+                }
+                return { std::move(solution).value() };
+            }
+        }
+
         if (Console::can_report_status())
         {
             Console::instance().print_in_place(
@@ -495,15 +529,7 @@ namespace mamba
             );
         }
         const auto started_at = std::chrono::steady_clock::now();
-        auto outcome = solver::libsolv::Solver()
-                           .solve(
-                               db,
-                               request,
-                               experimental_matchspec_parsing
-                                   ? solver::libsolv::MatchSpecParser::Mamba
-                                   : solver::libsolv::MatchSpecParser::Mixed
-                           )
-                           .value();
+        auto outcome = solver::libsolv::Solver().solve(db, request, ms_parser).value();
         if (Console::can_report_status())
         {
             Console::instance().print_in_place(
@@ -515,6 +541,14 @@ namespace mamba
                 true
             );
         }
+
+        if (cache.has_value())
+        {
+            if (const auto* solution = std::get_if<solver::Solution>(&outcome))
+            {
+                cache->store(cache_key, *solution);
+            }
+        }
         return outcome;
     }
 
@@ -523,15 +557,27 @@ namespace mamba
     {
         solver::libsolv::Database db{
             channel_context.params(),
-            {
-                experimental_matchspec_parsing ? solver::libsolv::MatchSpecParser::Mamba
-                                               : solver::libsolv::MatchSpecParser::Libsolv,
-            },
+            solver_database_settings(experimental_matchspec_parsing),
         };
         add_logger_to_database(db);
         return db;
     }
 
+    solver::libsolv::MatchSpecParser solver_matchspec_parser(const Context& ctx)
+    {
+        return ctx.experimental_matchspec_parsing ? solver::libsolv::MatchSpecParser::Mamba
+                                                  : solver::libsolv::MatchSpecParser::Mixed;
+    }
+
+    solver::libsolv::Database::Settings
+    solver_database_settings(bool experimental_matchspec_parsing)
+    {
+        return {
+            experimental_matchspec_parsing ? solver::libsolv::MatchSpecParser::Mamba
+                                           : solver::libsolv::MatchSpecParser::Libsolv,
+        };
+    }
+
     void configure_common_prefix_fallbacks(Configuration& config, bool create_base)
     {
         if (create_base)
@@ -574,6 +620,8 @@ namespace mamba
         bool no_py_pin
     )
     {
+        // Probing CUDA may take a while, overlap it with loading the repodata
+        start_virtual_packages_detection();
         populate_context_channels_from_specs(raw_specs, ctx);
         auto db = make_solver_database(ctx.experimental_matchspec_parsing, channel_context);
 
@@ -624,13 +672,36 @@ namespace mamba
             return specs::Version::parse(std::string(fallback_python_minor)).value();
         }();
 
+        // Unlike the python minor used for shards, the prefilter of all records only uses
+        // constraints that no solution can violate: the explicitly requested python minor and
+        // the virtual packages.
+        // It is disabled on retry so that unsolvable problems are explained in full.
+        const auto prefilter = [&]() -> RepodataPrefilter
+        {
+            if (is_retry)
+            {
+                return {};
+            }
+            auto python_minor = std::optional<specs::Version>();
+            if (!no_py_pin)
+            {
+                python_minor = extract_requested_python_minor(raw_specs);
+            }
+            auto virtual_packages = std::async(
+                std::launch::async,
+                [platform = ctx.platform] { return get_virtual_packages(platform); }
+            );
+            return { std::move(python_minor), virtual_packages.share() };
+        }();
+
         auto maybe_load = load_channels(
             ctx,
             channel_context,
             db,
             package_caches,
             root_packages,
-            python_minor_version_for_prefilter
+            python_minor_version_for_prefilter,
+            prefilter
         );
 
         if (!maybe_load)
@@ -678,9 +749,8 @@ namespace mamba
             retry_fn();
             return true;
         }
-        unsolvable->explain_problems_to(
+        LOG_ERROR << unsolvable->explain_problems(
             db,
-            LOG_ERROR,
             {
                 /* .unavailable= */ palette.failure,
                 /* .available= */ palette.success,
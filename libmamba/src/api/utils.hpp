@@ -113,13 +113,22 @@ namespace mamba
 
     /**
      * Solve a request and render the solver status through the current console.
+     *
+     * The solution is reused from the solution cache when ``use_solution_cache`` is set.
      */
     solver::libsolv::Solver::Outcome solve_request_with_status(
-        bool experimental_matchspec_parsing,
+        const Context& ctx,
         solver::libsolv::Database& db,
         const solver::Request& request
     );
 
+    /** The matchspec parser used to solve requests in ``solve_request_with_status``. */
+    [[nodiscard]] solver::libsolv::MatchSpecParser solver_matchspec_parser(const Context& ctx);
+
+    /** The settings of the databases created by ``make_solver_database``. */
+    [[nodiscard]] solver::libsolv::Database::Settings
+    solver_database_settings(bool experimental_matchspec_parsing);
+
     /**
      * Create a libsolv database configured for the current matching behavior.
      */
@@ -4,6 +4,14 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <chrono>
+#include <fstream>
+#include <optional>
+#include <string_view>
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
 #include "mamba/core/activation.hpp"
 #include "mamba/core/context.hpp"
 #include "mamba/core/output.hpp"
@@ -11,7 +19,9 @@
 #include "mamba/core/util.hpp"
 #include "mamba/core/util_os.hpp"
 #include "mamba/util/build.hpp"
+#include "mamba/util/cryptography.hpp"
 #include "mamba/util/environment.hpp"
+#include "mamba/util/random.hpp"
 #include "mamba/util/string.hpp"
 
 namespace mamba
@@ -20,9 +30,337 @@ namespace mamba
     {
         fs::u8path PREFIX_STATE_FILE = fs::u8path("conda-meta") / "state";
         fs::u8path PACKAGE_ENV_VARS_DIR = fs::u8path("etc") / "conda" / "env_vars.d";
+        fs::u8path PACKAGE_ACTIVATE_DIR = fs::u8path("etc") / "conda" / "activate.d";
+        fs::u8path PACKAGE_DEACTIVATE_DIR = fs::u8path("etc") / "conda" / "deactivate.d";
         std::string CONDA_ENV_VARS_UNSET_VAR = "***unset***";  // NOLINT(runtime/string)
+
+        // Format version of the activation plan cache files
+        constexpr std::string_view ACTIVATION_PLAN_CACHE_VERSION = "2";
     }  // namespace
 
+    /*********************************
+     * ActivationPlan implementation *
+     *********************************/
+
+    namespace
+    {
+        void
+        add_path_stamp(std::string& stamp, fs::file_time_type& latest, const fs::u8path& path)
+        {
+            std::error_code ec;
+            const auto status = fs::status(path, ec);
+            if (ec || !fs::exists(status))
+            {
+                stamp += util::concat(path.string(), "|-\n");
+                return;
+            }
+            const auto size = fs::is_regular_file(status) ? fs::file_size(path, ec) : 0;
+            const auto mtime = fs::last_write_time(path, ec);
+            latest = std::max(latest, mtime);
+            const auto count = mtime.time_since_epoch().count();
+            stamp += fmt::format("{}|{}|{}\n", path.string(), size, count);
+        }
+
+        /**
+         * Identify the inputs of a plan.
+         *
+         * Adding or removing scripts changes the modification time of their directory.
+         * Package env vars files are stamped individually since they can be edited in place.
+         * The latest modification time of the inputs is written to @p latest.
+         */
+        auto activation_plan_stamp(
+            const fs::u8path& prefix,
+            const std::vector<fs::u8path>& env_vars_files,
+            fs::file_time_type& latest
+        ) -> std::string
+        {
+            auto stamp = util::concat(ACTIVATION_PLAN_CACHE_VERSION, "\n");
+            latest = fs::file_time_type::min();
+            add_path_stamp(stamp, latest, prefix / PREFIX_STATE_FILE);
+            add_path_stamp(stamp, latest, prefix / PACKAGE_ENV_VARS_DIR);
+            add_path_stamp(stamp, latest, prefix / PACKAGE_ACTIVATE_DIR);
+            add_path_stamp(stamp, latest, prefix / PACKAGE_DEACTIVATE_DIR);
+            for (const auto& f : env_vars_files)
+            {
+                add_path_stamp(stamp, latest, f);
+            }
+            return stamp;
+        }
+
+        std::vector<std::pair<std::string, std::string>> read_environment_vars(
+            const fs::u8path& prefix,
+            const std::vector<fs::u8path>& env_var_files,
+            std::vector<std::string>& warnings
+        )
+        {
+            fs::u8path env_vars_file = prefix / PREFIX_STATE_FILE;
+
+            nlohmann::ordered_map<std::string, std::string> env_vars;
+
+            // # First get env vars from packages
+            for (auto& f : env_var_files)
+            {
+                auto fin = open_ifstream(f);
+                nlohmann::ordered_json j;
+                try
+                {
+                    fin >> j;
+                    for (auto it = j.begin(); it != j.end(); ++it)
+                    {
+                        env_vars[util::to_upper(it.key())] = it.value();
+                    }
+                }
+                catch (nlohmann::json::exception& error)
+                {
+                    warnings.push_back(
+                        util::concat("Could not read JSON at ", f.string(), ": ", error.what())
+                    );
+                }
+            }
+
+            // Then get env vars from environment specification
+            if (fs::exists(env_vars_file))
+            {
+                auto fin = open_ifstream(env_vars_file);
+                try
+                {
+                    nlohmann::ordered_json j;
+                    fin >> j;
+                    if (j.contains("env_vars"))
+                    {
+                        auto& prefix_state_env_vars = j["env_vars"];
+                        for (auto it = prefix_state_env_vars.begin();
+                             it != prefix_state_env_vars.end();
+                             ++it)
+                        {
+                            if (env_vars.find(it.key()) != env_vars.end())
+                            {
+                                warnings.emplace_back(
+                                    "Duplicate env vars detected. Vars from the "
+                                    "environment will overwrite those from packages"
+                                );
+                                warnings.push_back(
+                                    util::concat("Variable ", it.key(), " duplicated")
+                                );
+                            }
+                            env_vars[util::to_upper(it.key())] = it.value();
+                        }
+                    }
+                }
+                catch (nlohmann::json::exception& error)
+                {
+                    warnings.push_back(util::concat(
+                        "Could not read JSON at ",
+                        env_vars_file.string(),
+                        ": ",
+                        error.what()
+                    ));
+                }
+            }
+            return { env_vars.begin(), env_vars.end() };
+        }
+
+        auto paths_to_json(const std::vector<fs::u8path>& paths) -> nlohmann::json
+        {
+            auto out = nlohmann::json::array();
+            for (const auto& p : paths)
+            {
+                out.push_back(p.string());
+            }
+            return out;
+        }
+
+        auto paths_from_json(const nlohmann::json& j, std::vector<fs::u8path>& paths) -> bool
+        {
+            if (!j.is_array())
+            {
+                return false;
+            }
+            for (const auto& p : j)
+            {
+                if (!p.is_string())
+                {
+                    return false;
+                }
+                paths.emplace_back(p.get<std::string>());
+            }
+            return true;
+        }
+
+        auto read_cached_activation_plan(const fs::u8path& file, const fs::u8path& prefix)
+            -> std::optional<ActivationPlan>
+        {
+            auto f = std::ifstream(file.std_path());
+            if (!f)
+            {
+                return std::nullopt;
+            }
+            const auto j = nlohmann::json::parse(f, nullptr, /* allow_exceptions= */ false);
+            if (!j.is_object() || !j.contains("stamp") || !j["stamp"].is_string()
+                || !j.contains("env_vars") || !j["env_vars"].is_array())
+            {
+                return std::nullopt;
+            }
+
+            const auto field = [&](const char* key) { return j.value(key, nlohmann::json()); };
+            auto plan = ActivationPlan();
+            if (!paths_from_json(field("env_vars_files"), plan.env_vars_files)
+                || !paths_from_json(field("activate_scripts"), plan.activate_scripts)
+                || !paths_from_json(field("deactivate_scripts"), plan.deactivate_scripts))
+            {
+                return std::nullopt;
+            }
+            auto latest = fs::file_time_type();
+            if (j["stamp"].get<std::string>()
+                != activation_plan_stamp(prefix, plan.env_vars_files, latest))
+            {
+                return std::nullopt;
+            }
+            for (const auto& var : j["env_vars"])
+            {
+                if (!var.is_array() || (var.size() != 2) || !var[0].is_string()
+                    || !var[1].is_string())
+                {
+                    return std::nullopt;
+                }
+                plan.env_vars.emplace_back(var[0].get<std::string>(), var[1].get<std::string>());
+            }
+            const auto& warnings = field("warnings");
+            if (!warnings.is_array())
+            {
+                return std::nullopt;
+            }
+            for (const auto& warning : warnings)
+            {
+                if (!warning.is_string())
+                {
+                    return std::nullopt;
+                }
+                plan.warnings.push_back(warning.get<std::string>());
+            }
+            return plan;
+        }
+
+        void write_cached_activation_plan(
+            const fs::u8path& file,
+            std::string_view stamp,
+            const ActivationPlan& plan
+        )
+        {
+            auto env_vars = nlohmann::json::array();
+            for (const auto& [key, value] : plan.env_vars)
+            {
+                env_vars.push_back({ key, value });
+            }
+            const auto j = nlohmann::json{
+                { "stamp", stamp },
+                { "env_vars", std::move(env_vars) },
+                { "env_vars_files", paths_to_json(plan.env_vars_files) },
+                { "activate_scripts", paths_to_json(plan.activate_scripts) },
+                { "deactivate_scripts", paths_to_json(plan.deactivate_scripts) },
+                { "warnings", plan.warnings },
+            };
+
+            std::error_code ec;
+            fs::create_directories(file.parent_path(), ec);
+            const auto tmp_file = fs::u8path(util::concat(
+                file.string(),
+                ".",
+                util::generate_random_alphanumeric_string(8),
+                ".tmp"
+            ));
+            {
+                auto f = std::ofstream(tmp_file.std_path());
+                if (!f)
+                {
+                    return;
+                }
+                f << j.dump();
+                if (!f)
+                {
+                    f.close();
+                    fs::remove(tmp_file, ec);
+                    return;
+                }
+            }
+            fs::rename(tmp_file, file, ec);
+            if (ec)
+            {
+                fs::remove(tmp_file, ec);
+            }
+        }
+    }
+
+    auto activation_plan_cache_dir() -> fs::u8path
+    {
+        try
+        {
+            return fs::u8path(util::user_cache_dir()) / "mamba" / "activation";
+        }
+        catch (const std::exception& e)
+        {
+            LOG_DEBUG << "Activation plans are not cached: " << e.what();
+            return {};
+        }
+    }
+
+    namespace
+    {
+        void log_activation_plan_warnings(const ActivationPlan& plan)
+        {
+            for (const auto& warning : plan.warnings)
+            {
+                LOG_WARNING << warning;
+            }
+        }
+    }
+
+    auto load_activation_plan(const fs::u8path& prefix, const fs::u8path& cache_dir)
+        -> ActivationPlan
+    {
+        auto cache_file = fs::u8path();
+        if (!cache_dir.empty())
+        {
+            cache_file = cache_dir
+                         / util::concat(util::Sha256Hasher().str_hex_str(prefix.string()), ".json");
+            if (auto plan = read_cached_activation_plan(cache_file, prefix))
+            {
+                LOG_DEBUG << "Activation plan of " << prefix << " read from " << cache_file;
+                log_activation_plan_warnings(*plan);
+                return std::move(plan).value();
+            }
+        }
+
+        auto plan = ActivationPlan();
+        plan.env_vars_files = filter_dir(prefix / PACKAGE_ENV_VARS_DIR, "");
+        std::sort(plan.env_vars_files.begin(), plan.env_vars_files.end());
+        // Stamp the inputs before reading them, so that concurrent changes invalidate the cache
+        auto latest = fs::file_time_type();
+        const auto stamp = activation_plan_stamp(prefix, plan.env_vars_files, latest);
+
+        plan.env_vars = read_environment_vars(prefix, plan.env_vars_files, plan.warnings);
+        log_activation_plan_warnings(plan);
+        plan.activate_scripts = filter_dir(prefix / PACKAGE_ACTIVATE_DIR, "");
+        std::sort(plan.activate_scripts.begin(), plan.activate_scripts.end());
+        plan.deactivate_scripts = filter_dir(prefix / PACKAGE_DEACTIVATE_DIR, "");
+        // reverse sort!
+        std::sort(
+            plan.deactivate_scripts.begin(),
+            plan.deactivate_scripts.end(),
+            std::greater<fs::u8path>()
+        );
+
+        // Modification times have a coarse resolution on some filesystems, a change made right
+        // after recently modified inputs may not alter the stamp.
+        const bool inputs_settled = latest
+                                    < (fs::file_time_type::clock::now() - std::chrono::seconds(2));
+        if (!cache_file.empty() && inputs_settled)
+        {
+            write_cached_activation_plan(cache_file, stamp, plan);
+        }
+        return plan;
+    }
+
     /****************************
      * Activator implementation *
      ****************************/
@@ -33,20 +371,42 @@ namespace mamba
     {
     }
 
+    const ActivationPlan& Activator::get_activation_plan(const fs::u8path& prefix)
+    {
+        auto it = m_plans.find(prefix);
+        if (it == m_plans.end())
+        {
+            it = m_plans.emplace(prefix, load_activation_plan(prefix, activation_plan_cache_dir()))
+                     .first;
+        }
+        return it->second;
+    }
+
     std::vector<fs::u8path> Activator::get_activate_scripts(const fs::u8path& prefix)
     {
-        fs::u8path script_dir = prefix / "etc" / "conda" / "activate.d";
-        std::vector<fs::u8path> result = filter_dir(script_dir, shell_extension());
-        std::sort(result.begin(), result.end());
+        std::vector<fs::u8path> result;
+        const auto extension = shell_extension();
+        for (const auto& script : get_activation_plan(prefix).activate_scripts)
+        {
+            if (script.extension() == extension)
+            {
+                result.push_back(script);
+            }
+        }
         return result;
     }
 
     std::vector<fs::u8path> Activator::get_deactivate_scripts(const fs::u8path& prefix)
     {
-        fs::u8path script_dir = prefix / "etc" / "conda" / "deactivate.d";
-        std::vector<fs::u8path> result = filter_dir(script_dir, shell_extension());
-        // reverse sort!
-        std::sort(result.begin(), result.end(), std::greater<fs::u8path>());
+        std::vector<fs::u8path> result;
+        const auto extension = shell_extension();
+        for (const auto& script : get_activation_plan(prefix).deactivate_scripts)
+        {
+            if (script.extension() == extension)
+            {
+                result.push_back(script);
+            }
+        }
         return result;
     }
 
@@ -70,63 +430,7 @@ namespace mamba
     std::vector<std::pair<std::string, std::string>>
     Activator::get_environment_vars(const fs::u8path& prefix)
     {
-        fs::u8path env_vars_file = prefix / PREFIX_STATE_FILE;
-        fs::u8path pkg_env_var_dir = prefix / PACKAGE_ENV_VARS_DIR;
-
-        nlohmann::ordered_map<std::string, std::string> env_vars;
-
-        // # First get env vars from packages
-        auto env_var_files = filter_dir(pkg_env_var_dir, "");
-        std::sort(env_var_files.begin(), env_var_files.end());
-        for (auto& f : env_var_files)
-        {
-            auto fin = open_ifstream(f);
-            nlohmann::ordered_json j;
-            try
-            {
-                fin >> j;
-                for (auto it = j.begin(); it != j.end(); ++it)
-                {
-                    env_vars[util::to_upper(it.key())] = it.value();
-                }
-            }
-            catch (nlohmann::json::exception& error)
-            {
-                LOG_WARNING << "Could not read JSON at " << f << ": " << error.what();
-            }
-        }
-
-        // Then get env vars from environment specification
-        if (fs::exists(env_vars_file))
-        {
-            auto fin = open_ifstream(env_vars_file);
-            try
-            {
-                nlohmann::ordered_json j;
-                fin >> j;
-                if (j.contains("env_vars"))
-                {
-                    auto& prefix_state_env_vars = j["env_vars"];
-                    for (auto it = prefix_state_env_vars.begin(); it != prefix_state_env_vars.end();
-                         ++it)
-                    {
-                        if (env_vars.find(it.key()) != env_vars.end())
-                        {
-                            LOG_WARNING << "Duplicate env vars detected. Vars from the environment "
-                                        << "will overwrite those from packages";
-                            LOG_WARNING << "Variable " << it.key() << " duplicated";
-                        }
-                        env_vars[util::to_upper(it.key())] = it.value();
-                    }
-                }
-            }
-            catch (nlohmann::json::exception& error)
-            {
-                LOG_WARNING << "Could not read JSON at " << env_vars_file << ": " << error.what();
-            }
-        }
-        std::vector<std::pair<std::string, std::string>> res(env_vars.begin(), env_vars.end());
-        return res;
+        return get_activation_plan(prefix).env_vars;
     }
 
     std::string Activator::get_prompt_modifier(
@@ -4,9 +4,16 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <fstream>
+#include <mutex>
 #include <string>
 #include <system_error>
+#include <thread>
 
 #include "mamba/core/fsutil.hpp"
 #include "mamba/core/output.hpp"
@@ -155,6 +162,32 @@ namespace mamba::path
 
 namespace mamba::mamba_fs
 {
+    namespace
+    {
+        auto thread_count(std::size_t max_threads) -> std::size_t
+        {
+            return (max_threads > 0) ? max_threads
+                                     : std::max(std::thread::hardware_concurrency(), 1u);
+        }
+
+        /** Run ``worker`` on ``n_threads`` threads, including the calling one. */
+        template <typename Func>
+        void run_on_threads(std::size_t n_threads, const Func& worker)
+        {
+            auto threads = std::vector<std::thread>();
+            threads.reserve(n_threads - 1);
+            for (std::size_t t = 1; t < n_threads; ++t)
+            {
+                threads.emplace_back(worker);
+            }
+            worker();
+            for (auto& t : threads)
+            {
+                t.join();
+            }
+        }
+    }
+
     void rename_or_move(const fs::u8path& from, const fs::u8path& to, std::error_code& ec)
     {
         fs::rename(from, to, ec);
@@ -169,4 +202,215 @@ namespace mamba::mamba_fs
             }
         }
     }
+
+    auto
+    walk_directories(const std::vector<fs::u8path>& roots, const DirectoryWalkOptions& options)
+        -> std::vector<DirectoryWalkEntry>
+    {
+        struct Node
+        {
+            fs::u8path path = {};
+            Node* parent = nullptr;
+            bool collected = false;
+            std::atomic<std::uintmax_t> size = 0;
+            /** The listing of the directory and its subdirectories not walked yet. */
+            std::atomic<std::size_t> pending = 1;
+        };
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<Node> nodes;  // Stable addresses
+        std::deque<Node*> queue;
+        std::size_t pending_roots = 0;
+        std::exception_ptr error = nullptr;
+        auto out = std::vector<DirectoryWalkEntry>();
+
+        // Must be called with the mutex locked
+        auto add_node = [&](fs::u8path path, Node* parent, bool collected)
+        {
+            auto& node = nodes.emplace_back();
+            node.path = std::move(path);
+            node.parent = parent;
+            node.collected = collected;
+            queue.push_back(&node);
+            cv.notify_one();
+        };
+
+        // Called once a directory and all its subdirectories were walked
+        auto complete = [&](Node* node)
+        {
+            while (node != nullptr)
+            {
+                if (node->collected)
+                {
+                    auto lock = std::lock_guard(mutex);
+                    out.push_back({ node->path, node->size.load(), true });
+                }
+                Node* parent = node->parent;
+                if (parent == nullptr)
+                {
+                    auto lock = std::lock_guard(mutex);
+                    if (--pending_roots == 0)
+                    {
+                        cv.notify_all();
+                    }
+                    return;
+                }
+                parent->size += node->size.load();
+                if (--parent->pending != 0)
+                {
+                    return;
+                }
+                node = parent;
+            }
+        };
+
+        auto walk = [&](Node* node)
+        {
+            std::uintmax_t files_size = 0;
+            std::error_code ec;
+            for (auto it = fs::directory_iterator(node->path, ec);
+                 !ec && (it != fs::directory_iterator());
+                 it.increment(ec))
+            {
+                const auto& entry = *it;
+                std::error_code entry_ec;
+                if (entry.is_symlink(entry_ec))
+                {
+                    continue;
+                }
+                auto path = entry.path();
+                if (entry.is_directory(entry_ec))
+                {
+                    if (options.skip_directory && options.skip_directory(path))
+                    {
+                        continue;
+                    }
+                    const bool collected = options.collect_directory
+                                           && options.collect_directory(path);
+                    ++node->pending;
+                    auto lock = std::lock_guard(mutex);
+                    add_node(std::move(path), node, collected);
+                }
+                else
+                {
+                    auto size = entry.file_size(entry_ec);
+                    if (entry_ec)
+                    {
+                        size = 0;
+                    }
+                    files_size += size;
+                    if (options.collect_file && options.collect_file(path))
+                    {
+                        auto lock = std::lock_guard(mutex);
+                        out.push_back({ std::move(path), size, false });
+                    }
+                }
+            }
+            if (ec)
+            {
+                LOG_DEBUG << "Could not list directory '" << node->path.string()
+                          << "': " << ec.message();
+            }
+
+            node->size += files_size;
+            if (--node->pending == 0)
+            {
+                complete(node);
+            }
+        };
+
+        for (const auto& root : roots)
+        {
+            if (fs::is_directory(root))
+            {
+                ++pending_roots;
+                add_node(root, nullptr, false);
+            }
+        }
+        if (pending_roots == 0)
+        {
+            return out;
+        }
+
+        auto worker = [&]()
+        {
+            while (true)
+            {
+                Node* node = nullptr;
+                {
+                    auto lock = std::unique_lock(mutex);
+                    cv.wait(
+                        lock,
+                        [&] { return !queue.empty() || (pending_roots == 0) || error; }
+                    );
+                    if (queue.empty() || error)
+                    {
+                        return;
+                    }
+                    node = queue.front();
+                    queue.pop_front();
+                }
+
+                try
+                {
+                    walk(node);
+                }
+                catch (...)
+                {
+                    auto lock = std::lock_guard(mutex);
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                    cv.notify_all();
+                    return;
+                }
+            }
+        };
+        run_on_threads(thread_count(options.max_threads), worker);
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+        std::sort(
+            out.begin(),
+            out.end(),
+            [](const auto& a, const auto& b) { return a.path < b.path; }
+        );
+        return out;
+    }
+
+    auto remove_all_parallel(const std::vector<fs::u8path>& paths, std::size_t max_threads)
+        -> std::vector<fs::u8path>
+    {
+        auto failed = std::vector<fs::u8path>();
+        if (paths.empty())
+        {
+            return failed;
+        }
+
+        std::atomic<std::size_t> next = 0;
+        std::mutex mutex;
+
+        auto worker = [&]()
+        {
+            for (std::size_t i = next++; i < paths.size(); i = next++)
+            {
+                std::error_code ec;
+                fs::remove_all(paths[i], ec);
+                if (ec)
+                {
+                    LOG_WARNING << "Could not remove '" << paths[i].string()
+                                << "': " << ec.message();
+                    auto lock = std::lock_guard(mutex);
+                    failed.push_back(paths[i]);
+                }
+            }
+        };
+        run_on_threads(std::min(thread_count(max_threads), paths.size()), worker);
+
+        return failed;
+    }
 }
@@ -4,18 +4,407 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <algorithm>
+#include <charconv>
+#include <iterator>
 #include <list>
-#include <regex>
+#include <optional>
+#include <string_view>
+
+#include <fmt/format.h>
 
 #include "mamba/core/channel_context.hpp"
 #include "mamba/core/fsutil.hpp"
 #include "mamba/core/history.hpp"
 #include "mamba/core/output.hpp"
 #include "mamba/core/util.hpp"
+#include "mamba/util/random.hpp"
 #include "mamba/util/string.hpp"
 
 namespace mamba
 {
+    namespace
+    {
+        /** Return the date of a ``==> date <==`` revision header, nothing for other lines. */
+        auto parse_head_line(std::string_view line) -> std::optional<std::string_view>
+        {
+            constexpr auto open = std::string_view("==>");
+            constexpr auto close = std::string_view("<==");
+            if ((line.size() <= open.size() + close.size()) || !util::starts_with(line, open)
+                || !util::ends_with(line, close))
+            {
+                return std::nullopt;
+            }
+            const auto date = line.substr(open.size(), line.size() - open.size() - close.size());
+            const auto stripped = util::strip(date);
+            return stripped.empty() ? date : stripped;
+        }
+
+        struct HistoryEntry
+        {
+            History::ParseResult content = {};
+            /** The offset of the first line of the entry in the history file. */
+            std::size_t begin = 0;
+            /** The offset following the last line of the entry in the history file. */
+            std::size_t end = 0;
+            /** Whether the entry links or unlinks packages, making it a revision. */
+            bool has_diff = false;
+        };
+
+        /**
+         * Call ``func`` on every entry of the history read from ``in``, starting at ``offset``.
+         *
+         * The history is read line by line, without loading it in memory, and the diff
+         * lines are only stored when ``keep_diff`` is set.
+         * ``in`` must be opened in binary mode for the offsets to be exact.
+         */
+        template <typename Func>
+        void
+        for_each_history_entry(std::istream& in, std::size_t offset, bool keep_diff, Func&& func)
+        {
+            in.seekg(static_cast<std::streamoff>(offset));
+
+            auto entry = std::optional<HistoryEntry>();
+            auto line = std::string();
+            auto pos = offset;
+            while (std::getline(in, line))
+            {
+                const auto line_begin = pos;
+                pos += line.size() + (in.eof() ? 0 : 1);
+                if (!line.empty() && (line.back() == '\r'))
+                {
+                    line.pop_back();
+                }
+
+                if (line.empty())
+                {
+                    if (entry.has_value())
+                    {
+                        entry->end = pos;
+                    }
+                    continue;
+                }
+
+                if (const auto date = parse_head_line(line))
+                {
+                    if (entry.has_value())
+                    {
+                        func(std::move(entry).value());
+                    }
+                    entry.emplace();
+                    entry->content.head_line = *date;
+                    entry->begin = line_begin;
+                }
+                else
+                {
+                    // Lines preceding the first header are gathered in an entry without date
+                    if (!entry.has_value())
+                    {
+                        entry.emplace();
+                        entry->begin = line_begin;
+                    }
+                    if (line[0] == '#')
+                    {
+                        entry->content.comments.push_back(std::move(line));
+                    }
+                    else
+                    {
+                        entry->has_diff = entry->has_diff || (line[0] == '-') || (line[0] == '+');
+                        if (keep_diff)
+                        {
+                            entry->content.diff.push_back(std::move(line));
+                        }
+                    }
+                }
+                entry->end = pos;
+            }
+
+            if (entry.has_value())
+            {
+                func(std::move(entry).value());
+            }
+        }
+
+        /** Convert a history entry, ``revisions`` being the number of revisions preceding it. */
+        auto to_user_request(History& history, HistoryEntry&& entry, std::size_t& revisions)
+            -> History::UserRequest
+        {
+            History::UserRequest r;
+            r.date = std::move(entry.content.head_line);
+            for (const auto& c : entry.content.comments)
+            {
+                history.parse_comment_line(c, r);
+            }
+
+            for (const auto& x : entry.content.diff)
+            {
+                if (x[0] == '-')
+                {
+                    r.unlink_dists.push_back(x.substr(1));
+                }
+                else if (x[0] == '+')
+                {
+                    r.link_dists.push_back(x.substr(1));
+                }
+            }
+            if (entry.has_diff)
+            {
+                r.revision_num = revisions++;
+            }
+            return r;
+        }
+
+        /*******************
+         *  History index  *
+         *******************/
+
+        /*
+         * The history index is a text file with a header line followed by one line per
+         * history entry, made of the offsets delimiting the entry in the history file and
+         * of the number of revisions up to, and including, this entry.
+         * Since the history file is only ever appended to, the index is brought up to date
+         * by parsing the entries following the last indexed one.
+         */
+
+        constexpr auto history_index_header = std::string_view("mamba-history-index 1");
+
+        struct HistoryIndexEntry
+        {
+            std::size_t begin = 0;
+            std::size_t end = 0;
+            std::size_t revisions = 0;
+        };
+
+        auto format_history_index_line(const HistoryIndexEntry& entry) -> std::string
+        {
+            return fmt::format("{} {} {}\n", entry.begin, entry.end, entry.revisions);
+        }
+
+        auto parse_history_index_line(std::string_view line) -> std::optional<HistoryIndexEntry>
+        {
+            auto entry = HistoryIndexEntry();
+            const char* first = line.data();
+            const char* const last = line.data() + line.size();
+            for (auto* field : { &entry.begin, &entry.end, &entry.revisions })
+            {
+                const auto [ptr, ec] = std::from_chars(first, last, *field);
+                if (ec != std::errc())
+                {
+                    return std::nullopt;
+                }
+                first = ((ptr != last) && (*ptr == ' ')) ? ptr + 1 : ptr;
+            }
+            if ((first != last) || (entry.end <= entry.begin))
+            {
+                return std::nullopt;
+            }
+            return entry;
+        }
+
+        /** Read the whole index, returning nothing if it is missing or invalid. */
+        auto read_history_index(const fs::u8path& path)
+            -> std::optional<std::vector<HistoryIndexEntry>>
+        {
+            if (!fs::exists(path))
+            {
+                return std::nullopt;
+            }
+
+            auto in = open_ifstream(path);
+            auto line = std::string();
+            if (!std::getline(in, line) || (line != history_index_header))
+            {
+                return std::nullopt;
+            }
+
+            auto entries = std::vector<HistoryIndexEntry>();
+            while (std::getline(in, line))
+            {
+                const auto entry = parse_history_index_line(line);
+                if (!entry.has_value()
+                    || (!entries.empty()
+                        && ((entry->begin < entries.back().end)
+                            || (entry->revisions < entries.back().revisions))))
+                {
+                    LOG_DEBUG << "Ignoring invalid history index '" << path.string() << "'";
+                    return std::nullopt;
+                }
+                entries.push_back(entry.value());
+            }
+            return entries;
+        }
+
+        /** Read the last line of the index, without reading the whole file. */
+        auto read_last_history_index_entry(const fs::u8path& path)
+            -> std::optional<HistoryIndexEntry>
+        {
+            if (!fs::exists(path))
+            {
+                return std::nullopt;
+            }
+
+            auto in = open_ifstream(path);
+            auto line = std::string();
+            if (!std::getline(in, line) || (line != history_index_header))
+            {
+                return std::nullopt;
+            }
+
+            // Index lines are much shorter than this, the tail holds at least a whole line
+            constexpr std::streamoff tail_size = 128;
+            const auto lines_begin = in.tellg();
+            in.seekg(0, std::ios::end);
+            const auto size = in.tellg();
+            const bool partial = (size - lines_begin) > tail_size;
+            in.seekg(partial ? (size - tail_size) : lines_begin);
+
+            auto tail = std::string(std::istreambuf_iterator<char>(in), {});
+            if (tail.empty() || (tail.back() != '\n'))
+            {
+                return std::nullopt;
+            }
+            tail.pop_back();
+            const auto last_nl = tail.rfind('\n');
+            if (partial && (last_nl == std::string::npos))
+            {
+                return std::nullopt;
+            }
+            return parse_history_index_line(
+                std::string_view(tail).substr(last_nl == std::string::npos ? 0 : last_nl + 1)
+            );
+        }
+
+        void
+        write_history_index(const fs::u8path& path, const std::vector<HistoryIndexEntry>& entries)
+        {
+            auto tmp_path = path;
+            tmp_path += util::concat(".", util::generate_random_alphanumeric_string(8), ".tmp");
+            try
+            {
+                {
+                    auto out = open_ofstream(tmp_path);
+                    out << history_index_header << '\n';
+                    for (const auto& entry : entries)
+                    {
+                        out << format_history_index_line(entry);
+                    }
+                }
+                fs::rename(tmp_path, path);
+            }
+            catch (const std::exception& e)
+            {
+                LOG_DEBUG << "Could not write history index '" << path.string()
+                          << "': " << e.what();
+                std::error_code ec;
+                fs::remove(tmp_path, ec);
+            }
+        }
+
+        /** Read the index of ``history_path``, updating it with the entries not indexed yet. */
+        auto refresh_history_index(const fs::u8path& history_path) -> std::vector<HistoryIndexEntry>
+        {
+            std::error_code ec;
+            const auto size = static_cast<std::size_t>(fs::file_size(history_path, ec));
+            if (ec)
+            {
+                return {};
+            }
+
+            const auto index_path = History::index_file_path(history_path);
+            auto entries = read_history_index(index_path)
+                               .value_or(std::vector<HistoryIndexEntry>{});
+            if (!entries.empty() && (entries.back().end == size))
+            {
+                return entries;
+            }
+
+            auto in_file = open_ifstream(history_path);
+            auto scan_from = [&](std::size_t offset)
+            {
+                for_each_history_entry(
+                    in_file,
+                    offset,
+                    /* keep_diff= */ false,
+                    [&](HistoryEntry&& entry)
+                    {
+                        const auto previous = entries.empty() ? 0 : entries.back().revisions;
+                        entries.push_back({ entry.begin, entry.end, previous + entry.has_diff });
+                    }
+                );
+            };
+
+            // The last indexed entry may have been extended, so it is parsed again along
+            // with the new ones. A history that shrank was rewritten and is fully reindexed.
+            if (!entries.empty() && (entries.back().end < size))
+            {
+                const auto offset = entries.back().begin;
+                entries.pop_back();
+                const auto indexed = entries.size();
+                scan_from(offset);
+                if ((entries.size() == indexed) || (entries[indexed].begin != offset))
+                {
+                    LOG_DEBUG << "History index is out of date, rebuilding it";
+                    entries.clear();
+                    in_file.clear();
+                    scan_from(0);
+                }
+            }
+            else
+            {
+                entries.clear();
+                scan_from(0);
+            }
+
+            write_history_index(index_path, entries);
+            return entries;
+        }
+
+        /** Record the entry appended to ``history_path`` at ``entry_begin`` in its index. */
+        void append_to_history_index(
+            const fs::u8path& history_path,
+            std::size_t entry_begin,
+            bool has_diff
+        )
+        {
+            const auto index_path = History::index_file_path(history_path);
+            std::error_code ec;
+            const auto entry_end = static_cast<std::size_t>(fs::file_size(history_path, ec));
+            if (ec)
+            {
+                return;
+            }
+
+            if (entry_begin == 0)
+            {
+                write_history_index(index_path, { { 0, entry_end, has_diff ? 1u : 0u } });
+                return;
+            }
+
+            try
+            {
+                const auto last = read_last_history_index_entry(index_path);
+                if (last.has_value() && (last->end == entry_begin))
+                {
+                    auto out = open_ofstream(index_path, std::ios::app | std::ios::binary);
+                    out << format_history_index_line(
+                        { entry_begin, entry_end, last->revisions + has_diff }
+                    );
+                }
+                else
+                {
+                    // Reindexing is left to the next reader rather than slowing down writes
+                    fs::remove(index_path, ec);
+                }
+            }
+            catch (const std::exception& e)
+            {
+                LOG_DEBUG << "Could not update history index '" << index_path.string()
+                          << "': " << e.what();
+                fs::remove(index_path, ec);
+            }
+        }
+    }
+
     History::History(const fs::u8path& prefix, ChannelContext& channel_context)
         : m_prefix(prefix)
         , m_history_file_path(fs::absolute(m_prefix / "conda-meta" / "history"))
@@ -48,48 +437,13 @@ namespace mamba
             return res;
         }
 
-        static const std::regex head_re("==>\\s*(.+?)\\s*<==");
-        std::ifstream in_file = open_ifstream(m_history_file_path, std::ios::in);
-
-        std::string line;
-        while (getline(in_file, line))
-        {
-            if (line.size() == 0)
-            {
-                continue;
-            }
-            std::smatch base_match;
-            if (std::regex_match(line, base_match, head_re))
-            {
-                ParseResult p;
-                p.head_line = base_match[1].str();
-                res.push_back(p);
-            }
-            else if (line[0] == '#')
-            {
-                if (res.size() > 0)
-                {
-                    res[res.size() - 1].comments.push_back(line);
-                }
-                else
-                {
-                    res.push_back(ParseResult());
-                    res[0].comments.push_back(line);
-                }
-            }
-            else if (line.size() != 0)
-            {
-                if (res.size() > 0)
-                {
-                    res[res.size() - 1].diff.push_back(line);
-                }
-                else
-                {
-                    res.push_back(ParseResult());
-                    res[0].diff.push_back(line);
-                }
-            }
-        }
+        auto in_file = open_ifstream(m_history_file_path);
+        for_each_history_entry(
+            in_file,
+            0,
+            /* keep_diff= */ true,
+            [&](HistoryEntry&& entry) { res.push_back(std::move(entry.content)); }
+        );
         return res;
     }
 
@@ -203,40 +557,59 @@ namespace mamba
     std::vector<History::UserRequest> History::get_user_requests()
     {
         std::vector<UserRequest> res;
-        std::size_t revision_num = 0;
-        for (const auto& el : parse())
+        if (!fs::exists(m_history_file_path))
         {
-            UserRequest r;
-            r.date = el.head_line;
-            for (const auto& c : el.comments)
-            {
-                parse_comment_line(c, r);
-            }
-
-            for (const auto& x : el.diff)
-            {
-                if (x[0] == '-')
-                {
-                    r.unlink_dists.push_back(x.substr(1));
-                }
-                else if (x[0] == '+')
-                {
-                    r.link_dists.push_back(x.substr(1));
-                }
-            }
-            if ((r.link_dists.size() > 0) || (r.unlink_dists.size() > 0))
-            {
-                r.revision_num = revision_num++;
-            }
-            res.push_back(r);
+            return res;
         }
+
+        std::size_t revisions = 0;
+        auto in_file = open_ifstream(m_history_file_path);
+        for_each_history_entry(
+            in_file,
+            0,
+            /* keep_diff= */ true,
+            [&](HistoryEntry&& entry)
+            { res.push_back(to_user_request(*this, std::move(entry), revisions)); }
+        );
         // TODO add some stuff here regarding version of conda?
         return res;
     }
 
+    std::vector<History::UserRequest> History::get_user_requests_after(std::size_t revision)
+    {
+        std::vector<UserRequest> res;
+        const auto index = refresh_history_index(m_history_file_path);
+
+        // The entry of revision ``revision + 1`` is the first one counting more revisions
+        const auto first = std::partition_point(
+            index.cbegin(),
+            index.cend(),
+            [&](const HistoryIndexEntry& entry) { return entry.revisions <= revision + 1; }
+        );
+        if (first == index.cend())
+        {
+            return res;
+        }
+
+        std::size_t revisions = (first == index.cbegin()) ? 0 : std::prev(first)->revisions;
+        auto in_file = open_ifstream(m_history_file_path);
+        for_each_history_entry(
+            in_file,
+            first->begin,
+            /* keep_diff= */ true,
+            [&](HistoryEntry&& entry)
+            { res.push_back(to_user_request(*this, std::move(entry), revisions)); }
+        );
+        return res;
+    }
+
     std::unordered_map<std::string, specs::MatchSpec> History::get_requested_specs_map()
     {
         std::unordered_map<std::string, specs::MatchSpec> map;
+        if (!fs::exists(m_history_file_path))
+        {
+            return map;
+        }
 
         auto to_specs = [&](const std::vector<std::string>& sv)
         {
@@ -253,24 +626,34 @@ namespace mamba
             return v;
         };
 
-        for (const auto& request : get_user_requests())
-        {
-            auto remove_specs = to_specs(request.remove);
-            for (auto& spec : remove_specs)
+        // Only the comments are needed, so the entries are processed as they are read,
+        // without storing their diff.
+        std::size_t revisions = 0;
+        auto in_file = open_ifstream(m_history_file_path);
+        for_each_history_entry(
+            in_file,
+            0,
+            /* keep_diff= */ false,
+            [&](HistoryEntry&& entry)
             {
-                map.erase(spec.name().to_string());
-            }
-            auto update_specs = to_specs(request.update);
-            for (auto& spec : update_specs)
-            {
-                map[spec.name().to_string()] = spec;
-            }
-            auto neutered_specs = to_specs(request.neutered);
-            for (auto& spec : neutered_specs)
-            {
-                map[spec.name().to_string()] = spec;
+                const auto request = to_user_request(*this, std::move(entry), revisions);
+                auto remove_specs = to_specs(request.remove);
+                for (auto& spec : remove_specs)
+                {
+                    map.erase(spec.name().to_string());
+                }
+                auto update_specs = to_specs(request.update);
+                for (auto& spec : update_specs)
+                {
+                    map[spec.name().to_string()] = spec;
+                }
+                auto neutered_specs = to_specs(request.neutered);
+                for (auto& spec : neutered_specs)
+                {
+                    map[spec.name().to_string()] = spec;
+                }
             }
-        }
+        );
 
         return map;
     }
@@ -278,10 +661,15 @@ namespace mamba
     void History::add_entry(const History::UserRequest& entry)
     {
         LOG_INFO << "Opening history file: " << m_history_file_path;
+        std::size_t entry_begin = 0;
         if (!fs::exists(m_history_file_path))
         {
             path::touch(m_history_file_path);
         }
+        else
+        {
+            entry_begin = static_cast<std::size_t>(fs::file_size(m_history_file_path));
+        }
         std::ofstream out = open_ofstream(m_history_file_path, std::ios::app);
 
         if (out.fail())
@@ -326,6 +714,20 @@ namespace mamba
             out << specs_output("remove", entry.remove);
             out << specs_output("neutered", entry.neutered);
         }
+        out.close();
+
+        append_to_history_index(
+            m_history_file_path,
+            entry_begin,
+            !entry.unlink_dists.empty() || !entry.link_dists.empty()
+        );
+    }
+
+    fs::u8path History::index_file_path(const fs::u8path& history_file_path)
+    {
+        auto out = history_file_path;
+        out += ".index";
+        return out;
     }
 
     specs::PackageInfo read_history_url_entry(const std::string& s)
@@ -404,8 +806,6 @@ namespace mamba
         std::size_t target_revision
     )
     {
-        assert(!user_requests.empty());
-
         struct revision
         {
             std::size_t key = 0;
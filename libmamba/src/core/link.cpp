@@ -6,12 +6,15 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cctype>
 #include <iostream>
 #include <iterator>
+#include <mutex>
 #include <regex>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
@@ -21,16 +24,19 @@
 #include <reproc++/run.hpp>
 
 #include "./link.hpp"
+#include "mamba/core/cache_paths.hpp"
 #include "mamba/core/error_handling.hpp"
 #include "mamba/core/menuinst.hpp"
 #include "mamba/core/output.hpp"
 #include "mamba/specs/match_spec.hpp"
 #include "mamba/util/build.hpp"
 #include "mamba/util/environment.hpp"
+#include "mamba/util/mapped_file.hpp"
 #include "mamba/util/path_manip.hpp"
 #include "mamba/util/string.hpp"
 #include "mamba/validation/tools.hpp"
 
+#include "./pyc_cache.hpp"
 #include "./transaction_context.hpp"
 
 #ifdef __APPLE__
@@ -910,34 +916,151 @@ namespace mamba
         assert(m_context != nullptr);
     }
 
-    std::tuple<std::string, std::string>
-    LinkPackage::link_path(const PathData& path_data, bool noarch_python)
+    namespace
     {
-        std::string subtarget = path_data.path;
-        LOG_TRACE << "linking '" << subtarget << "'";
-        fs::u8path dst, rel_dst;
-        if (noarch_python)
+        /** Errors meaning that no hard-link can be made between the two filesystems. */
+        bool is_hardlink_unsupported_error(const std::error_code& ec)
         {
-            rel_dst = get_python_noarch_target_path(
-                subtarget,
-                m_context->python_params().site_packages_path
-            );
-            dst = m_context->prefix_params().target_prefix / rel_dst;
+            return (ec == std::errc::cross_device_link)
+                   || (ec == std::errc::function_not_supported)
+                   || (ec == std::errc::operation_not_supported);
         }
-        else
+
+        /**
+         * Errors meaning that only this file cannot be hard-linked.
+         *
+         * For instance with ``fs.protected_hardlinks``, or when the source file reached its
+         * maximum number of links.
+         */
+        bool is_hardlink_refused_error(const std::error_code& ec)
         {
-            rel_dst = subtarget;
-            dst = m_context->prefix_params().target_prefix / rel_dst;
+            return (ec == std::errc::operation_not_permitted) || (ec == std::errc::too_many_links);
+        }
+    }
+
+    namespace
+    {
+        /**
+         * Compute the SHA256 of files, spreading large batches over several threads.
+         *
+         * The files were just linked, so they are usually in the page cache and hashing is
+         * CPU bound.
+         */
+        auto sha256sum_all(const std::vector<fs::u8path>& files) -> std::vector<std::string>
+        {
+            static constexpr std::size_t files_per_thread = 16;
+
+            std::vector<std::string> hashes(files.size());
+            std::atomic<std::size_t> next_file = 0;
+            std::mutex error_mutex;
+            std::exception_ptr error = nullptr;
+
+            auto work = [&]()
+            {
+                for (std::size_t i = next_file++; i < files.size(); i = next_file++)
+                {
+                    try
+                    {
+                        hashes[i] = validation::sha256sum(files[i]);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard lock(error_mutex);
+                        if (!error)
+                        {
+                            error = std::current_exception();
+                        }
+                    }
+                }
+            };
+
+            const std::size_t n_threads = std::min<std::size_t>(
+                std::max(std::thread::hardware_concurrency(), 1u),
+                (files.size() + files_per_thread - 1) / files_per_thread
+            );
+            std::vector<std::thread> workers;
+            try
+            {
+                for (std::size_t t = 1; t < n_threads; ++t)
+                {
+                    workers.emplace_back(work);
+                }
+            }
+            catch (const std::system_error& e)
+            {
+                LOG_DEBUG << "Could not start hashing thread: " << e.what();
+            }
+            work();
+            for (auto& worker : workers)
+            {
+                worker.join();
+            }
+
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+            return hashes;
         }
+    }
 
-        fs::u8path src = m_source / subtarget;
-        if (!fs::exists(dst.parent_path()))
+    std::vector<LinkPackage::LinkTarget>
+    LinkPackage::plan_link_targets(const std::vector<PathData>& paths_data, bool noarch_python)
+    {
+        const fs::u8path& target_prefix = m_context->prefix_params().target_prefix;
+        fs::create_directories(target_prefix);
+
+        // Relative directory -> whether it was created for this package
+        std::unordered_map<std::string, bool> directories = { { "", false } };
+        auto ensure_directory = [&](const auto& self, const fs::u8path& rel_dir) -> bool
         {
-            fs::create_directories(dst.parent_path());
+            const auto key = rel_dir.generic_string();
+            if (const auto it = directories.find(key); it != directories.end())
+            {
+                return it->second;
+            }
+            const bool parent_is_new = self(self, rel_dir.parent_path());
+            // A new parent cannot contain anything, the directory is created without checking
+            const bool is_new = fs::create_directory(target_prefix / rel_dir) || parent_is_new;
+            directories.emplace(key, is_new);
+            return is_new;
+        };
+
+        std::vector<LinkTarget> targets;
+        targets.reserve(paths_data.size());
+        for (const auto& path_data : paths_data)
+        {
+            auto target = LinkTarget{};
+            if (noarch_python)
+            {
+                target.rel_dst = get_python_noarch_target_path(
+                    path_data.path,
+                    m_context->python_params().site_packages_path
+                );
+            }
+            else
+            {
+                target.rel_dst = path_data.path;
+            }
+            target.in_new_directory = ensure_directory(
+                ensure_directory,
+                target.rel_dst.parent_path()
+            );
+            targets.push_back(std::move(target));
         }
+        return targets;
+    }
+
+    std::tuple<std::string, std::string>
+    LinkPackage::link_path(const PathData& path_data, const LinkTarget& target)
+    {
+        LOG_TRACE << "linking '" << path_data.path << "'";
+        const fs::u8path& rel_dst = target.rel_dst;
+        const fs::u8path dst = m_context->prefix_params().target_prefix / rel_dst;
+        const fs::u8path src = m_source / path_data.path;
 
         std::error_code ec;
-        if (lexists(dst, ec) && !ec)
+        if (!target.in_new_directory && lexists(dst, ec) && !ec)
         {
             // Sometimes we might want to raise here ...
             m_clobber_warnings.push_back(rel_dst.string());
@@ -986,38 +1109,33 @@ namespace mamba
             LOG_TRACE << "Copying file & replace prefix " << src << " -> " << dst;
             // TODO windows does something else here
 
-            std::string buffer;
-            if (path_data.file_mode != FileMode::BINARY)
+            auto mapped = util::MappedFile::try_open(src);
+            if (!mapped)
             {
-                buffer = read_contents(src, std::ios::in | std::ios::binary);
-                util::replace_all(buffer, path_data.prefix_placeholder, new_prefix);
-
-                if constexpr (!util::on_win)  // only on non-windows platforms
-                {
-                    // we need to check the first line for a shebang and replace it if it's too long
-                    if (buffer[0] == '#' && buffer[1] == '!')
-                    {
-                        std::size_t end_of_line = buffer.find_first_of('\n');
-                        std::string first_line = buffer.substr(0, end_of_line);
-                        if (first_line.size() > MAX_SHEBANG_LENGTH)
-                        {
-                            std::string new_shebang = replace_long_shebang(first_line);
-                            buffer.replace(0, end_of_line, new_shebang);
-                        }
-                    }
-                }
+                throw std::runtime_error(util::concat(
+                    "Could not open ",
+                    src.string(),
+                    " for prefix replacement: ",
+                    mapped.error().message()
+                ));
+            }
+            const std::string_view data = mapped->view();
+            const auto& placeholder = path_data.prefix_placeholder;
+            std::vector<std::size_t> offsets;
+            if (const auto* indexed = m_placeholder_index.find(path_data.path, placeholder, data))
+            {
+                offsets = *indexed;
             }
             else
             {
-                assert(path_data.file_mode == FileMode::BINARY);
-                buffer = read_contents(src, std::ios::in | std::ios::binary);
+                offsets = find_prefix_placeholder(data, path_data.prefix_placeholder);
+            }
 
 #ifdef _WIN32
-                auto has_pyzzer_entrypoint = [](const std::string& data)
-                { return data.rfind("PK\x05\x06"); };
-
+            if (path_data.file_mode == FileMode::BINARY)
+            {
                 // on win we only replace pyzzer entrypoints apparently
-                auto entry_point = has_pyzzer_entrypoint(buffer);
+                auto entry_point = data.rfind("PK\x05\x06");
 
                 struct pyzzer_struct
                 {
@@ -1025,24 +1143,24 @@ namespace mamba
                     uint32_t cdr_offset;
                 } pyzzer_entry;
 
-                if (entry_point != std::string::npos)
+                if (entry_point != std::string_view::npos)
                 {
                     std::string launcher, shebang;
                     pyzzer_entry = *reinterpret_cast<const pyzzer_struct*>(
-                        buffer.c_str() + entry_point
+                        data.data() + entry_point
                     );
                     std::size_t arc_pos = entry_point - pyzzer_entry.cdr_size
                                           - pyzzer_entry.cdr_offset;
 
                     if (arc_pos > 0)
                     {
-                        auto pos = buffer.rfind("#!", arc_pos);
-                        if (pos != std::string::npos)
+                        auto pos = data.rfind("#!", arc_pos);
+                        if (pos != std::string_view::npos)
                         {
-                            shebang = buffer.substr(pos, arc_pos);
+                            shebang = data.substr(pos, arc_pos);
                             if (pos > 0)
                             {
-                                launcher = buffer.substr(0, pos);
+                                launcher = data.substr(0, pos);
                             }
                         }
                     }
@@ -1051,7 +1169,9 @@ namespace mamba
                     {
                         util::replace_all(shebang, path_data.prefix_placeholder, new_prefix);
                         std::ofstream fo = open_ofstream(dst, std::ios::out | std::ios::binary);
-                        fo << launcher << shebang << (buffer.c_str() + arc_pos);
+                        // The archive is written up to its first null character, as a C string
+                        const auto archive = data.substr(arc_pos);
+                        fo << launcher << shebang << archive.substr(0, archive.find('\0'));
                         fo.close();
                     }
                     return std::make_tuple(
@@ -1059,39 +1179,91 @@ namespace mamba
                         rel_dst.generic_string()
                     );
                 }
-#else
-                std::size_t padding_size = (path_data.prefix_placeholder.size() > new_prefix.size())
-                                               ? path_data.prefix_placeholder.size()
-                                                     - new_prefix.size()
-                                               : 0;
-                std::string padding(padding_size, '\0');
-
-                std::size_t pos = buffer.find(path_data.prefix_placeholder);
-                while (pos != std::string::npos)
-                {
-#if defined(__APPLE__)
-                    binary_changed = true;
+            }
 #endif
-                    std::size_t end = pos + path_data.prefix_placeholder.size();
-                    std::string suffix;
 
-                    while (end < buffer.size() && buffer[end] != '\0')
+            // The file is hashed while it is written rather than read again afterwards
+            std::ofstream fo = open_ofstream(dst, std::ios::out | std::ios::binary);
+            Sha256OutputBuffer hashing_buffer(fo.rdbuf());
+            std::ostream out(&hashing_buffer);
+
+            if (path_data.file_mode != FileMode::BINARY)
+            {
+                // we need to check the first line for a shebang and replace it if it's too long
+                // (only on non-windows platforms)
+                std::size_t body_start = 0;
+                if (!util::on_win && util::starts_with(data, "#!"))
+                {
+                    const std::size_t end_of_line = std::min(data.find('\n'), data.size());
+                    const std::string first_line = replace_prefix_placeholder(
+                        data.substr(0, end_of_line),
+                        path_data.prefix_placeholder,
+                        new_prefix
+                    );
+                    if (first_line.size() > MAX_SHEBANG_LENGTH)
                     {
-                        suffix += buffer[end];
-                        ++end;
+                        out << replace_long_shebang(first_line);
+                        body_start = end_of_line;
                     }
+                }
 
-                    std::string replacement = util::concat(new_prefix, suffix, padding);
-                    buffer.replace(pos, end - pos, replacement);
-
-                    pos = buffer.find(path_data.prefix_placeholder, pos + new_prefix.size());
+                if (body_start == 0)
+                {
+                    write_text_prefix_replaced(
+                        out,
+                        data,
+                        path_data.prefix_placeholder,
+                        new_prefix,
+                        offsets
+                    );
+                }
+                else
+                {
+                    std::vector<std::size_t> body_offsets;
+                    for (const auto pos : offsets)
+                    {
+                        if (pos >= body_start)
+                        {
+                            body_offsets.push_back(pos - body_start);
+                        }
+                    }
+                    write_text_prefix_replaced(
+                        out,
+                        data.substr(body_start),
+                        path_data.prefix_placeholder,
+                        new_prefix,
+                        body_offsets
+                    );
                 }
+            }
+            else
+            {
+                assert(path_data.file_mode == FileMode::BINARY);
+                if constexpr (util::on_win)
+                {
+                    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+                }
+                else
+                {
+#if defined(__APPLE__)
+                    binary_changed = !offsets.empty();
 #endif
+                    write_binary_prefix_replaced(
+                        out,
+                        data,
+                        path_data.prefix_placeholder,
+                        new_prefix,
+                        offsets
+                    );
+                }
             }
-
-            std::ofstream fo = open_ofstream(dst, std::ios::out | std::ios::binary);
-            fo << buffer;
+            out.flush();
             fo.close();
+            if (!out || !fo)
+            {
+                throw std::runtime_error(util::concat("Could not write ", dst.string()));
+            }
+            std::string sha256_in_prefix = hashing_buffer.hex_digest();
 
             std::error_code lec;
             fs::permissions(dst, fs::status(src).permissions(), lec);
@@ -1104,9 +1276,11 @@ namespace mamba
             if (binary_changed && m_pkg_info.platform == "osx-arm64")
             {
                 codesign(dst, m_context->transaction_params().verbosity > 1);
+                // Signing modifies the file
+                sha256_in_prefix = validation::sha256sum(dst);
             }
 #endif
-            return std::tuple(validation::sha256sum(dst), rel_dst.generic_string());
+            return std::tuple(std::move(sha256_in_prefix), rel_dst.generic_string());
         }
 
         if ((path_data.path_type == PathType::HARDLINK) || path_data.no_link)
@@ -1114,6 +1288,11 @@ namespace mamba
             bool copy = path_data.no_link || m_context->link_params().always_copy;
             bool softlink = m_context->link_params().always_softlink;
 
+            if (!copy && !softlink && m_context->hardlinks_unsupported(m_cache_path))
+            {
+                softlink = m_context->link_params().allow_softlinks;
+                copy = !softlink;
+            }
             if (!copy && !softlink)
             {
                 std::error_code lec;
@@ -1121,8 +1300,25 @@ namespace mamba
 
                 if (lec)
                 {
-                    softlink = m_context->link_params().allow_softlinks;
-                    copy = !softlink;
+                    if (is_hardlink_unsupported_error(lec))
+                    {
+                        // Do not try again for the other files of this package cache
+                        LOG_DEBUG << "Cannot hard-link from '" << m_cache_path.string()
+                                  << "': " << lec.message();
+                        m_context->set_hardlinks_unsupported(m_cache_path);
+                    }
+                    if (is_hardlink_refused_error(lec))
+                    {
+                        // Only this file cannot be hard-linked
+                        LOG_DEBUG << "Cannot hard-link '" << src.string()
+                                  << "', copying it: " << lec.message();
+                        copy = true;
+                    }
+                    else
+                    {
+                        softlink = m_context->link_params().allow_softlinks;
+                        copy = !softlink;
+                    }
                 }
                 else
                 {
@@ -1167,27 +1363,61 @@ namespace mamba
                 + std::to_string(static_cast<int>(path_data.path_type))
             );
         }
-        return std::tuple(
-            path_data.sha256.empty() ? validation::sha256sum(dst) : path_data.sha256,
-            rel_dst.generic_string()
-        );
+        // An empty hash is computed later, in parallel with the other files of the package
+        return std::tuple(path_data.sha256, rel_dst.generic_string());
     }
 
-    std::vector<fs::u8path> LinkPackage::compile_pyc_files(const std::vector<fs::u8path>& py_files)
+    std::vector<fs::u8path> LinkPackage::compile_pyc_files(
+        const std::vector<fs::u8path>& py_files,
+        const std::vector<std::string>& py_files_sha256
+    )
     {
+        assert(py_files.size() == py_files_sha256.size());
         if (py_files.size() == 0)
         {
             return {};
         }
 
+        const auto& short_python_version = m_context->python_params().short_python_version;
         std::vector<fs::u8path> pyc_files;
         for (auto& f : py_files)
         {
-            pyc_files.push_back(pyc_path(f, m_context->python_params().short_python_version));
+            pyc_files.push_back(pyc_path(f, short_python_version));
         }
-        if (m_context->link_params().compile_pyc)
+        if (!m_context->link_params().compile_pyc)
         {
-            m_context->try_pyc_compilation(py_files);
+            return pyc_files;
+        }
+
+        // Bytecode only depends on the source content, so it can be shared across environments
+        // through the package cache; only cache misses are sent to the compiler.
+        const fs::u8path& target_prefix = m_context->prefix_params().target_prefix;
+        const auto pyc_cache = PycCache(
+            m_cache_path / std::string(cache_paths::cache_pyc_relative)
+        );
+        const auto cache_tag = pyc_cache_tag(short_python_version);
+        const bool use_pyc_cache = m_context->link_params().pyc_cache && !cache_tag.empty();
+
+        std::vector<fs::u8path> to_compile;
+        for (std::size_t i = 0; i < py_files.size(); ++i)
+        {
+            if (use_pyc_cache && !py_files_sha256[i].empty())
+            {
+                auto key = PycCache::Key{ py_files_sha256[i], cache_tag };
+                if (pyc_cache.fetch(key, target_prefix / py_files[i], target_prefix / pyc_files[i]))
+                {
+                    continue;
+                }
+                m_context->defer_pyc_caching(pyc_cache, std::move(key), py_files[i], pyc_files[i]);
+            }
+            to_compile.push_back(py_files[i]);
+        }
+
+        LOG_DEBUG << (py_files.size() - to_compile.size()) << " of " << py_files.size()
+                  << " pyc files found in cache for '" << m_pkg_info.str() << "'";
+        if (!to_compile.empty())
+        {
+            m_context->try_pyc_compilation(to_compile);
         }
         return pyc_files;
     }
@@ -1217,6 +1447,7 @@ namespace mamba
 
         LOG_TRACE << "Opening: " << m_source / "info" / "paths.json";
         auto paths_data = read_paths(m_source);
+        m_placeholder_index = PrefixPlaceholderIndex::read(m_source);
 
         LOG_TRACE << "Opening: " << m_source / "info" / "repodata_record.json";
 
@@ -1259,9 +1490,11 @@ namespace mamba
         paths_json["paths"] = nlohmann::json::array();
         paths_json["paths_version"] = 1;
 
-        for (auto& path : paths_data)
+        const auto link_targets = plan_link_targets(paths_data, noarch_type == NoarchType::PYTHON);
+        for (std::size_t i = 0; i < paths_data.size(); ++i)
         {
-            auto [sha256_in_prefix, final_path] = link_path(path, noarch_type == NoarchType::PYTHON);
+            const auto& path = paths_data[i];
+            auto [sha256_in_prefix, final_path] = link_path(path, link_targets[i]);
             files_record.push_back(final_path);
 
             nlohmann::json json_record = { { "_path", final_path },
@@ -1298,6 +1531,28 @@ namespace mamba
             paths_json["paths"].push_back(json_record);
         }
 
+        // Hash the linked files that have no SHA256 in paths.json (softlinks are handled below)
+        {
+            std::vector<std::size_t> unhashed_indices;
+            std::vector<fs::u8path> unhashed_files;
+            for (std::size_t i = 0; i < paths_data.size(); ++i)
+            {
+                if ((paths_data[i].path_type != PathType::SOFTLINK)
+                    && paths_json["paths"][i]["sha256_in_prefix"].get<std::string>().empty())
+                {
+                    unhashed_indices.push_back(i);
+                    unhashed_files.push_back(
+                        m_context->prefix_params().target_prefix / files_record[i]
+                    );
+                }
+            }
+            const auto hashes = sha256sum_all(unhashed_files);
+            for (std::size_t k = 0; k < unhashed_indices.size(); ++k)
+            {
+                paths_json["paths"][unhashed_indices[k]]["sha256_in_prefix"] = hashes[k];
+            }
+        }
+
         for (std::size_t i = 0; i < paths_data.size(); ++i)
         {
             auto& path = paths_data[i];
@@ -1391,6 +1646,7 @@ namespace mamba
             }
 
             std::vector<fs::u8path> for_compilation;
+            std::vector<std::string> for_compilation_sha256;
             static std::regex py_file_re("^site-packages[/\\\\][^\\t\\n\\r\\f\\v]+\\.py$");
             for (auto& sub_path_json : paths_data)
             {
@@ -1400,10 +1656,17 @@ namespace mamba
                         sub_path_json.path,
                         m_context->python_params().site_packages_path
                     ));
+                    // Prefix replaced sources differ from the package content
+                    for_compilation_sha256.push_back(
+                        sub_path_json.prefix_placeholder.empty() ? sub_path_json.sha256 : ""
+                    );
                 }
             }
 
-            std::vector<fs::u8path> pyc_files = compile_pyc_files(for_compilation);
+            std::vector<fs::u8path> pyc_files = compile_pyc_files(
+                for_compilation,
+                for_compilation_sha256
+            );
             for (const fs::u8path& pyc_path : pyc_files)
             {
                 out_json["paths_data"]["paths"].push_back(
@@ -18,6 +18,7 @@
 #include "mamba/specs/package_info.hpp"
 #include "mamba/util/build.hpp"
 
+#include "./prefix_replacement.hpp"
 #include "./transaction_context.hpp"
 
 namespace mamba
@@ -92,8 +93,28 @@ namespace mamba
 
     private:
 
-        std::tuple<std::string, std::string> link_path(const PathData& path_data, bool noarch_python);
-        std::vector<fs::u8path> compile_pyc_files(const std::vector<fs::u8path>& py_files);
+        struct LinkTarget
+        {
+            /** Destination relative to the target prefix. */
+            fs::u8path rel_dst;
+            /** The parent directory was created for this package, nothing can be clobbered. */
+            bool in_new_directory = false;
+        };
+
+        /**
+         * Compute the destinations of all the package files and create their directories.
+         *
+         * Every directory is created (or found existing) only once, rather than checking the
+         * parent directory and the destination of every file.
+         */
+        std::vector<LinkTarget>
+        plan_link_targets(const std::vector<PathData>& paths_data, bool noarch_python);
+        std::tuple<std::string, std::string>
+        link_path(const PathData& path_data, const LinkTarget& target);
+        std::vector<fs::u8path> compile_pyc_files(
+            const std::vector<fs::u8path>& py_files,
+            const std::vector<std::string>& py_files_sha256
+        );
         auto
         create_python_entry_point(const fs::u8path& path, const python_entry_point_parsed& entry_point);
         void create_application_entry_point(
@@ -105,6 +126,7 @@ namespace mamba
         specs::PackageInfo m_pkg_info;
         fs::u8path m_cache_path;
         fs::u8path m_source;
+        PrefixPlaceholderIndex m_placeholder_index;
         std::vector<std::string> m_clobber_warnings;
         TransactionContext* m_context;
     };
@@ -34,10 +34,31 @@ namespace mamba::logging
 #endif
         extern util::synchronized_value<LoggingParams, params_mutex> logging_params;
         extern AnyLogHandler current_log_handler;
+        extern std::atomic<log_level> enabled_level;
+
+        auto enabled_log_level() noexcept -> const std::atomic<log_level>&
+        {
+            return details::enabled_level;
+        }
     }
 
     namespace
     {
+        /** Must be called with the parameters locked, after each change. */
+        auto update_enabled_log_level(const LoggingParams& params) -> void
+        {
+            const auto level = [&]
+            {
+                // The backtrace keeps the records of all levels to replay them later
+                if (params.log_backtrace > 0 or params.logging_level == log_level::all)
+                {
+                    return log_level::trace;
+                }
+                return params.logging_level;
+            }();
+            details::enabled_level.store(level, std::memory_order_relaxed);
+        }
+
         // TODO: consider generalize and move in synchronized_value.hpp
         template <std::default_initializable T, typename U, typename... OtherArgs>
             requires std::assignable_from<T&, U>
@@ -103,6 +124,7 @@ namespace mamba::logging
             auto previous_handler = std::exchange(details::current_log_handler, std::move(new_handler));
 
             auto params = synchronize_with_value(details::logging_params, maybe_new_params);
+            update_enabled_log_level(*params);
 
             if (details::current_log_handler)
             {
@@ -148,6 +170,7 @@ namespace mamba::logging
         auto synched_params = details::logging_params.synchronize();
         const auto previous_level = synched_params->logging_level;
         synched_params->logging_level = new_level;
+        update_enabled_log_level(*synched_params);
         if (details::current_log_handler)
         {
             details::current_log_handler.set_log_level(synched_params->logging_level);
@@ -170,6 +193,7 @@ namespace mamba::logging
         auto synched_params = details::logging_params.synchronize();
         LoggingParams previous_params = *synched_params;
         *synched_params = std::move(new_params);
+        update_enabled_log_level(*synched_params);
         if (update_log_handler and details::current_log_handler)
         {
             details::current_log_handler.set_params(*synched_params);
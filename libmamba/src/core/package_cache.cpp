@@ -4,9 +4,15 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
 #include <fstream>
 #include <mutex>
 #include <sstream>
+#include <system_error>
+#include <thread>
 #include <unordered_map>
 
 #include <nlohmann/json.hpp>
@@ -18,6 +24,7 @@
 #include "mamba/core/util.hpp"
 #include "mamba/specs/archive.hpp"
 #include "mamba/specs/conda_url.hpp"
+#include "mamba/util/random.hpp"
 #include "mamba/util/string.hpp"
 #include "mamba/validation/tools.hpp"
 
@@ -324,21 +331,12 @@ namespace mamba
             return util::rstrip(url1->str(Credentials::Remove), '/')
                    == util::rstrip(url2->str(Credentials::Remove), '/');
         }
-    }
-
-    bool
-    PackageCacheData::has_valid_extracted_dir(const specs::PackageInfo& s, const ValidationParams& params)
-    {
-        const std::string pkg = s.long_str();
-        if (m_valid_extracted_dir.find(pkg) != m_valid_extracted_dir.end())
-        {
-            return m_valid_extracted_dir[pkg];
-        }
-
-        auto pkg_name = specs::strip_archive_extension(s.filename);
-        const auto folder = package_cache_folder_relative_path(s);
 
-        auto validate_extracted_dir = [&](const fs::u8path& extracted_dir) -> bool
+        auto validate_extracted_dir(
+            const specs::PackageInfo& s,
+            const ValidationParams& params,
+            const fs::u8path& extracted_dir
+        ) -> bool
         {
             if (!fs::exists(extracted_dir))
             {
@@ -480,29 +478,291 @@ namespace mamba
                             << " couldn't be validated due to error: " << ex.what();
             }
             return false;
-        };
+        }
+
+        auto record_mtime(const fs::u8path& record_path, std::error_code& ec) -> std::int64_t
+        {
+            return static_cast<std::int64_t>(
+                fs::last_write_time(record_path, ec).time_since_epoch().count()
+            );
+        }
+    }
+
+    auto PackageCacheData::check_extracted_dir(
+        const specs::PackageInfo& s,
+        const ValidationParams& params
+    ) const -> ExtractedDirCheck
+    {
+        const auto pkg_name = specs::strip_archive_extension(s.filename);
+        const auto folder = package_cache_folder_relative_path(s);
 
         LOG_DEBUG << "Verify cache '" << m_path.string() << "' for package extracted directory '"
                   << pkg_name << "'";
 
-        // Try hierarchical path
-        fs::u8path extracted_dir = m_path / folder / pkg_name;
-        bool valid = validate_extracted_dir(extracted_dir);
+        // Try hierarchical path, then fall back to flat path
+        for (const auto& relative_dir : { folder / pkg_name, fs::u8path(pkg_name) })
+        {
+            const auto extracted_dir = m_path / relative_dir;
+            const auto record_path = extracted_dir / "info" / "repodata_record.json";
+            std::error_code ec;
+            const auto size = fs::file_size(record_path, ec);
+            if (ec)
+            {
+                continue;
+            }
+            const auto mtime = record_mtime(record_path, ec);
+            if (ec)
+            {
+                continue;
+            }
 
-        // Fall back to flat path
-        if (!valid)
+            const auto key = relative_dir.generic_string();
+            auto verdict = ExtractedDirVerdict{
+                /* .record_size= */ size,
+                /* .record_mtime= */ mtime,
+                /* .size= */ s.size,
+                /* .sha256= */ s.sha256,
+                /* .md5= */ s.md5,
+                /* .url= */ s.package_url,
+                /* .safety_checks= */ static_cast<int>(params.safety_checks),
+                /* .extra_safety_checks= */ params.extra_safety_checks,
+            };
+
+            // Extra safety checks are meant to catch files modified after extraction, which the
+            // verdict cannot see, so they always run.
+            const auto it = params.extra_safety_checks ? m_extracted_dir_verdicts.end()
+                                                       : m_extracted_dir_verdicts.find(key);
+            if (it != m_extracted_dir_verdicts.end())
+            {
+                const auto& known = it->second;
+                if ((known.record_size == verdict.record_size)
+                    && (known.record_mtime == verdict.record_mtime) && (known.size == verdict.size)
+                    && (known.sha256 == verdict.sha256) && (known.md5 == verdict.md5)
+                    && (known.url == verdict.url) && (known.safety_checks == verdict.safety_checks))
+                {
+                    LOG_TRACE << "Extracted package cache '" << extracted_dir.string()
+                              << "' is known to be valid";
+                    return { true, key, std::nullopt };
+                }
+            }
+
+            if (validate_extracted_dir(s, params, extracted_dir))
+            {
+                return { true, key, std::move(verdict) };
+            }
+        }
+        return { false, {}, std::nullopt };
+    }
+
+    void PackageCacheData::load_extracted_dir_verdicts()
+    {
+        if (m_extracted_dir_verdicts_loaded)
+        {
+            return;
+        }
+        m_extracted_dir_verdicts_loaded = true;
+
+        const auto index_path = m_path / "cache" / extracted_dirs_index_filename;
+        std::error_code ec;
+        if (!fs::exists(index_path, ec))
+        {
+            return;
+        }
+
+        try
+        {
+            auto in = open_ifstream(index_path);
+            const auto j = nlohmann::json::parse(in);
+            if (j.at("version").get<int>() != 1)
+            {
+                return;
+            }
+            for (const auto& [dir, v] : j.at("dirs").items())
+            {
+                m_extracted_dir_verdicts[dir] = ExtractedDirVerdict{
+                    /* .record_size= */ v.at("record_size").get<std::uintmax_t>(),
+                    /* .record_mtime= */ v.at("record_mtime").get<std::int64_t>(),
+                    /* .size= */ v.at("size").get<std::size_t>(),
+                    /* .sha256= */ v.at("sha256").get<std::string>(),
+                    /* .md5= */ v.at("md5").get<std::string>(),
+                    /* .url= */ v.at("url").get<std::string>(),
+                    /* .safety_checks= */ v.at("safety_checks").get<int>(),
+                    /* .extra_safety_checks= */ v.at("extra_safety_checks").get<bool>(),
+                };
+            }
+        }
+        catch (const std::exception& e)
+        {
+            LOG_DEBUG << "Ignoring invalid extracted directories index '" << index_path.string()
+                      << "': " << e.what();
+            m_extracted_dir_verdicts.clear();
+        }
+    }
+
+    void PackageCacheData::write_extracted_dir_verdicts()
+    {
+        if (is_writable() != Writable::WRITABLE)
+        {
+            return;
+        }
+
+        auto dirs = nlohmann::json::object();
+        for (const auto& [dir, verdict] : m_extracted_dir_verdicts)
+        {
+            // Drop the directories that were removed since they were validated
+            std::error_code ec;
+            if (!fs::exists(m_path / dir / "info" / "repodata_record.json", ec))
+            {
+                continue;
+            }
+            dirs[dir] = {
+                { "record_size", verdict.record_size },
+                { "record_mtime", verdict.record_mtime },
+                { "size", verdict.size },
+                { "sha256", verdict.sha256 },
+                { "md5", verdict.md5 },
+                { "url", verdict.url },
+                { "safety_checks", verdict.safety_checks },
+                { "extra_safety_checks", verdict.extra_safety_checks },
+            };
+        }
+        const auto j = nlohmann::json{ { "version", 1 }, { "dirs", std::move(dirs) } };
+
+        const auto cache_dir = m_path / "cache";
+        const auto index_path = cache_dir / extracted_dirs_index_filename;
+        const auto tmp_path = cache_dir
+                              / util::concat(
+                                  extracted_dirs_index_filename,
+                                  ".",
+                                  util::generate_random_alphanumeric_string(8),
+                                  ".tmp"
+                              );
+        try
         {
-            extracted_dir = m_path / pkg_name;
-            valid = validate_extracted_dir(extracted_dir);
+            fs::create_directories(cache_dir);
+            {
+                auto out = open_ofstream(tmp_path);
+                out << j.dump();
+            }
+            fs::rename(tmp_path, index_path);
+        }
+        catch (const std::exception& e)
+        {
+            LOG_DEBUG << "Could not write extracted directories index '" << index_path.string()
+                      << "': " << e.what();
+            std::error_code ec;
+            fs::remove(tmp_path, ec);
+        }
+    }
+
+    bool
+    PackageCacheData::has_valid_extracted_dir(const specs::PackageInfo& s, const ValidationParams& params)
+    {
+        const std::string pkg = s.long_str();
+        if (m_valid_extracted_dir.find(pkg) != m_valid_extracted_dir.end())
+        {
+            return m_valid_extracted_dir[pkg];
         }
 
+        load_extracted_dir_verdicts();
+        const bool valid = check_extracted_dir(s, params).valid;
+
         m_valid_extracted_dir[pkg] = valid;
-        LOG_DEBUG << "'" << pkg_name << "' extracted directory cache is "
-                  << (valid ? "valid" : "invalid");
+        LOG_DEBUG << "'" << specs::strip_archive_extension(s.filename)
+                  << "' extracted directory cache is " << (valid ? "valid" : "invalid");
 
         return valid;
     }
 
+    void PackageCacheData::validate_extracted_dirs(
+        const std::vector<specs::PackageInfo>& pkgs,
+        const ValidationParams& params
+    )
+    {
+        auto todo = std::vector<const specs::PackageInfo*>();
+        for (const auto& pkg : pkgs)
+        {
+            if (!m_valid_extracted_dir.contains(pkg.long_str()))
+            {
+                todo.push_back(&pkg);
+            }
+        }
+        if (todo.empty())
+        {
+            return;
+        }
+
+        load_extracted_dir_verdicts();
+
+        // Reading the records and hashing the files is independent for every package
+        auto results = std::vector<ExtractedDirCheck>(todo.size());
+        const std::size_t n_threads = std::min<std::size_t>(
+            std::max(std::thread::hardware_concurrency(), 1u),
+            todo.size()
+        );
+        std::atomic<std::size_t> next = 0;
+        std::exception_ptr error = nullptr;
+        std::mutex error_mutex;
+        auto worker = [&]()
+        {
+            for (auto i = next++; i < todo.size(); i = next++)
+            {
+                try
+                {
+                    results[i] = check_extracted_dir(*todo[i], params);
+                }
+                catch (...)
+                {
+                    auto lock = std::lock_guard(error_mutex);
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                    next = todo.size();
+                }
+            }
+        };
+        auto threads = std::vector<std::thread>();
+        threads.reserve(n_threads - 1);
+        try
+        {
+            for (std::size_t t = 1; t < n_threads; ++t)
+            {
+                threads.emplace_back(worker);
+            }
+        }
+        catch (const std::system_error& e)
+        {
+            LOG_DEBUG << "Could not start validation thread: " << e.what();
+        }
+        worker();
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+
+        bool new_verdicts = false;
+        for (std::size_t i = 0; i < todo.size(); ++i)
+        {
+            auto& result = results[i];
+            m_valid_extracted_dir[todo[i]->long_str()] = result.valid;
+            if (result.verdict.has_value())
+            {
+                auto& verdict = m_extracted_dir_verdicts[std::move(result.relative_dir)];
+                verdict = std::move(result.verdict).value();
+                new_verdicts = true;
+            }
+        }
+        if (new_verdicts)
+        {
+            write_extracted_dir_verdicts();
+        }
+    }
+
     MultiPackageCache::MultiPackageCache(
         const std::vector<fs::u8path>& cache_paths,
         const ValidationParams& params
@@ -661,4 +921,30 @@ namespace mamba
             c.clear_query_cache(s);
         }
     }
+
+    void MultiPackageCache::validate_extracted_dirs(const std::vector<specs::PackageInfo>& pkgs)
+    {
+        // Only look in a cache for the packages not found in the previous ones
+        auto remaining = std::vector<specs::PackageInfo>();
+        for (const auto& pkg : pkgs)
+        {
+            if (!m_cached_extracted_dirs.contains(pkg.long_str()))
+            {
+                remaining.push_back(pkg);
+            }
+        }
+        for (auto& c : m_caches)
+        {
+            if (remaining.empty())
+            {
+                break;
+            }
+            c.validate_extracted_dirs(remaining, m_params);
+            std::erase_if(
+                remaining,
+                [&](const specs::PackageInfo& pkg)
+                { return c.has_valid_extracted_dir(pkg, m_params); }
+            );
+        }
+    }
 }  // namespace mamba
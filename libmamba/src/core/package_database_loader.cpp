@@ -153,11 +153,8 @@ namespace mamba
             );
     }
 
-    auto load_installed_packages_in_database(
-        const Context& ctx,
-        solver::libsolv::Database& database,
-        const PrefixData& prefix
-    ) -> solver::libsolv::RepoInfo
+    auto installed_packages_for_database(const Context& ctx, const PrefixData& prefix)
+        -> std::vector<specs::PackageInfo>
     {
         // TODO(C++20): We could do a PrefixData range that returns packages without storing them.
         auto pkgs = prefix.sorted_records();
@@ -190,7 +187,15 @@ namespace mamba
             // the existing conda package takes precedence.
             std::ranges::copy(pip_packages_to_add, std::back_inserter(pkgs));
         }
+        return pkgs;
+    }
 
+    auto load_installed_packages_in_database(
+        solver::libsolv::Database& database,
+        const std::vector<specs::PackageInfo>& pkgs,
+        const std::vector<specs::PackageInfo>& virtual_packages
+    ) -> solver::libsolv::RepoInfo
+    {
         database.clear_virtual_package_lock_jobs();
 
         // Not adding Pip dependency since it might needlessly make the installed/active environment
@@ -200,9 +205,22 @@ namespace mamba
             "installed",
             solver::libsolv::PipAsPythonDependency::No
         );
-        database.add_virtual_packages(repo, get_virtual_packages(ctx.platform));
+        database.add_virtual_packages(repo, virtual_packages);
         database.internalize_repo(repo);
         database.set_installed_repo(repo);
         return repo;
     }
+
+    auto load_installed_packages_in_database(
+        const Context& ctx,
+        solver::libsolv::Database& database,
+        const PrefixData& prefix
+    ) -> solver::libsolv::RepoInfo
+    {
+        return load_installed_packages_in_database(
+            database,
+            installed_packages_for_database(ctx, prefix),
+            get_virtual_packages(ctx.platform)
+        );
+    }
 }
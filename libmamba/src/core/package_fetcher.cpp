@@ -5,16 +5,20 @@
 // The full license is in the file LICENSE, distributed with this software.
 
 #include <algorithm>
+#include <regex>
 
 #include "mamba/core/invoke.hpp"
 #include "mamba/core/output.hpp"
 #include "mamba/core/package_fetcher.hpp"
+#include "mamba/core/package_paths.hpp"
 #include "mamba/core/util.hpp"
 #include "mamba/core/util_os.hpp"
 #include "mamba/specs/archive.hpp"
 #include "mamba/util/string.hpp"
 #include "mamba/validation/tools.hpp"
 
+#include "./prefix_replacement.hpp"
+
 namespace mamba
 {
 
@@ -335,6 +339,25 @@ namespace mamba
                 mamba::extract_subproc(tarball_path, extract_path, options);
             }
         }
+
+        void write_prefix_placeholder_index(const fs::u8path& extract_path)
+        {
+            // The index only speeds up linking, a failure must not invalidate the extraction
+            try
+            {
+                const auto paths = read_paths(extract_path);
+                const auto index = PrefixPlaceholderIndex::build(extract_path, paths);
+                if (!index.empty())
+                {
+                    index.write(extract_path);
+                }
+            }
+            catch (const std::exception& e)
+            {
+                LOG_DEBUG << "Could not index prefix placeholders of '" << extract_path.string()
+                          << "': " << e.what();
+            }
+        }
     }
 
     bool PackageFetcher::extract(const ExtractOptions& options, progress_callback_t* cb)
@@ -359,6 +382,7 @@ namespace mamba
                 interruption_point();
                 LOG_DEBUG << "Extracted to '" << extract_path.string() << "'";
                 write_repodata_record(extract_path);
+                write_prefix_placeholder_index(extract_path);
                 update_urls_txt();
                 update_monitor(cb, PackageExtractEvent::extract_success);
             }
@@ -5,6 +5,14 @@
 // The full license is in the file LICENSE, distributed with this software.
 
 
+#include <algorithm>
+#include <atomic>
+#include <ctime>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <tuple>
+
 #include <archive.h>
 #include <archive_entry.h>
 #include <reproc++/run.hpp>
@@ -15,6 +23,8 @@
 #include "mamba/core/package_paths.hpp"
 #include "mamba/core/thread_utils.hpp"
 #include "mamba/core/util_os.hpp"
+#include "mamba/core/util_scope.hpp"
+#include "mamba/util/random.hpp"
 #include "mamba/util/string.hpp"
 #include "mamba/validation/tools.hpp"
 
@@ -221,6 +231,39 @@ namespace mamba
         return init_order;
     }
 
+    static void
+    set_zstd_tar_format(scoped_archive_write& a, int compression_level, int compression_threads)
+    {
+        archive_write_set_format_gnutar(a);
+        archive_write_set_format_pax_restricted(a);  // Note 1
+        archive_write_add_filter_zstd(a);
+
+        if (compression_level < 1 || compression_level > 22)
+        {
+            throw std::runtime_error("zstd compression level should be between 1 and 22");
+        }
+
+        std::string comp_level = std::string("zstd:compression-level=")
+                                 + std::to_string(compression_level);
+
+        int res = archive_write_set_options(a, comp_level.c_str());
+        if (res != 0)
+        {
+            LOG_ERROR << "libarchive error (" << res << ") " << archive_error_string(a);
+        }
+
+        if (compression_threads > 1)
+        {
+            std::string comp_threads_level = std::string("zstd:threads=")
+                                             + std::to_string(compression_threads);
+            res = archive_write_set_options(a, comp_threads_level.c_str());
+            if (res != 0)
+            {
+                LOG_ERROR << "libarchive error (" << res << ") " << archive_error_string(a);
+            }
+        }
+    }
+
     // Bundle up all files in directory and create destination archive
     void create_archive(
         const fs::u8path& directory,
@@ -265,34 +308,7 @@ namespace mamba
         }
         if (ca == compression_algorithm::zstd)
         {
-            archive_write_set_format_gnutar(a);
-            archive_write_set_format_pax_restricted(a);  // Note 1
-            archive_write_add_filter_zstd(a);
-
-            if (compression_level < 1 || compression_level > 22)
-            {
-                throw std::runtime_error("zstd compression level should be between 1 and 22");
-            }
-
-            std::string comp_level = std::string("zstd:compression-level=")
-                                     + std::to_string(compression_level);
-
-            int res = archive_write_set_options(a, comp_level.c_str());
-            if (res != 0)
-            {
-                LOG_ERROR << "libarchive error (" << res << ") " << archive_error_string(a);
-            }
-
-            if (compression_threads > 2)
-            {
-                std::string comp_threads_level = std::string("zstd:threads=")
-                                                 + std::to_string(compression_threads);
-                res = archive_write_set_options(a, comp_threads_level.c_str());
-                if (res != 0)
-                {
-                    LOG_ERROR << "libarchive error (" << res << ") " << archive_error_string(a);
-                }
-            }
+            set_zstd_tar_format(a, compression_level, compression_threads);
         }
 
         archive_write_open_filename(a, abs_out_path.string().c_str());
@@ -499,6 +515,31 @@ namespace mamba
         stream_extract_archive(a, destination, options);
     }
 
+    void extract_archive(
+        std::FILE* stream,
+        const fs::u8path& destination,
+        const ExtractOptions& options
+    )
+    {
+        LOG_INFO << "Extracting stream to " << destination;
+        extraction_guard g(destination);
+
+        scoped_archive_read a;
+        archive_read_support_format_tar(a);
+        archive_read_support_format_zip(a);
+        archive_read_support_filter_all(a);
+
+        int r = archive_read_open_FILE(a, stream);
+
+        if (r != ARCHIVE_OK)
+        {
+            LOG_ERROR << "Error opening archive: " << archive_error_string(a);
+            throw std::runtime_error("Could not open archive stream for reading.");
+        }
+
+        stream_extract_archive(a, destination, options);
+    }
+
     namespace
     {
         struct conda_extract_context : non_copyable_base
@@ -784,6 +825,191 @@ namespace mamba
         }
     }
 
+    fs::u8path extract_subproc(const fs::u8path& file, const ExtractOptions& options)
+    {
+        const fs::u8path dest_dir = extract_dest_dir(file);
+        extract_subproc(file, dest_dir, options);
+        return dest_dir;
+    }
+
+    namespace
+    {
+        la_ssize_t
+        write_to_buffer(archive*, void* client_data, const void* buff, std::size_t length)
+        {
+            auto* out = static_cast<std::vector<char>*>(client_data);
+            const auto* data = static_cast<const char*>(buff);
+            out->insert(out->end(), data, data + length);
+            return static_cast<la_ssize_t>(length);
+        }
+
+        void check_archive(archive* a, int r)
+        {
+            if (r < ARCHIVE_WARN)
+            {
+                throw std::runtime_error(util::concat("libarchive error: ", archive_error_string(a)));
+            }
+        }
+
+        void copy_entry_data(archive* source, archive* dest, std::vector<char>& buffer)
+        {
+            while (!is_sig_interrupted())
+            {
+                const la_ssize_t len = archive_read_data(source, buffer.data(), buffer.size());
+                if (len == 0)
+                {
+                    return;
+                }
+                check_archive(source, static_cast<int>(std::min<la_ssize_t>(len, 0)));
+                if (archive_write_data(dest, buffer.data(), static_cast<std::size_t>(len)) < 0)
+                {
+                    check_archive(dest, ARCHIVE_FATAL);
+                }
+            }
+            throw std::runtime_error("SIGINT received. Aborting transmute.");
+        }
+
+        void write_zip_member_header(archive* zip, const std::string& name, std::uintmax_t size)
+        {
+            scoped_archive_entry entry;
+            archive_entry_set_pathname(entry, name.c_str());
+            archive_entry_set_size(entry, static_cast<la_int64_t>(size));
+            archive_entry_set_filetype(entry, AE_IFREG);
+            archive_entry_set_perm(entry, 0644);
+            archive_entry_set_mtime(entry, std::time(nullptr), 0);
+            check_archive(zip, archive_write_header(zip, entry));
+        }
+
+        /**
+         * Convert a ``.tar.bz2`` package to a ``.conda`` package from archive to archive.
+         *
+         * Entries are split between the info and pkg zstd tarballs as they are read.
+         * The info tarball is small and kept in memory, the pkg tarball is compressed to a
+         * temporary file next to the target since zip members must be written with their size.
+         */
+        void transmute_tar_bz2_to_conda(
+            const fs::u8path& pkg_file,
+            const fs::u8path& target,
+            int compression_level,
+            int compression_threads
+        )
+        {
+            LOG_INFO << "Streaming " << pkg_file << " to " << target;
+            extraction_guard g(target);
+            const std::string stem = target.stem().string();
+
+            scoped_archive_read source;
+            archive_read_support_format_tar(source);
+            archive_read_support_filter_all(source);
+            auto lock = LockFile(pkg_file);
+            if (archive_read_open_filename(source, pkg_file.string().c_str(), 10240) != ARCHIVE_OK)
+            {
+                LOG_ERROR << "Error opening archive: " << archive_error_string(source);
+                throw std::runtime_error(
+                    pkg_file.string() + " : Could not open archive for reading."
+                );
+            }
+
+            std::vector<char> info_data;
+            scoped_archive_write info;
+            set_zstd_tar_format(info, compression_level, compression_threads);
+            archive_write_set_bytes_in_last_block(info, 1);
+            check_archive(
+                info,
+                archive_write_open2(info, &info_data, nullptr, write_to_buffer, nullptr, nullptr)
+            );
+
+            const fs::u8path pkg_tmp_file = target.parent_path()
+                                            / util::concat(
+                                                ".",
+                                                target.filename().string(),
+                                                ".",
+                                                util::generate_random_alphanumeric_string(8),
+                                                ".tmp"
+                                            );
+            on_scope_exit remove_pkg_tmp_file{ [&]
+                                               {
+                                                   std::error_code ec;
+                                                   fs::remove(pkg_tmp_file, ec);
+                                               } };
+            scoped_archive_write pkg;
+            set_zstd_tar_format(pkg, compression_level, compression_threads);
+            check_archive(pkg, archive_write_open_filename(pkg, pkg_tmp_file.string().c_str()));
+
+            std::vector<char> buffer(1 << 16);
+            archive_entry* entry = nullptr;
+            for (;;)
+            {
+                const int r = archive_read_next_header(source, &entry);
+                if (r == ARCHIVE_EOF)
+                {
+                    break;
+                }
+                check_archive(source, r);
+
+                // clean out UID and GID
+                archive_entry_set_uid(entry, 0);
+                archive_entry_set_gid(entry, 0);
+                archive_entry_set_gname(entry, "");
+                archive_entry_set_uname(entry, "");
+
+                const auto path = fs::u8path(archive_entry_pathname(entry)).lexically_normal();
+                archive* dest = fs::path_has_prefix(path, "info") ? info : pkg;
+                check_archive(dest, archive_write_header(dest, entry));
+                if (archive_entry_size(entry) > 0)
+                {
+                    copy_entry_data(source, dest, buffer);
+                }
+                check_archive(dest, archive_write_finish_entry(dest));
+            }
+            check_archive(info, archive_write_close(info));
+            check_archive(pkg, archive_write_close(pkg));
+
+            const std::string metadata = nlohmann::json{ { "conda_pkg_format_version", 2 } }.dump();
+
+            // Same member order as ``create_package``, see ``zip_order``
+            scoped_archive_write zip;
+            archive_write_set_format_zip(zip);
+            archive_write_set_options(zip, "zip:compression-level=0");
+            check_archive(
+                zip,
+                archive_write_open_filename(zip, fs::absolute(target).string().c_str())
+            );
+
+            write_zip_member_header(zip, "metadata.json", metadata.size());
+            if (archive_write_data(zip, metadata.data(), metadata.size()) < 0)
+            {
+                check_archive(zip, ARCHIVE_FATAL);
+            }
+
+            write_zip_member_header(
+                zip,
+                util::concat("pkg-", stem, ".tar.zst"),
+                fs::file_size(pkg_tmp_file)
+            );
+            {
+                std::ifstream fin(pkg_tmp_file.std_path(), std::ios::in | std::ios::binary);
+                while (fin)
+                {
+                    fin.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                    const auto len = static_cast<std::size_t>(fin.gcount());
+                    if ((len > 0) && (archive_write_data(zip, buffer.data(), len) < 0))
+                    {
+                        check_archive(zip, ARCHIVE_FATAL);
+                    }
+                }
+            }
+
+            write_zip_member_header(zip, util::concat("info-", stem, ".tar.zst"), info_data.size());
+            if (archive_write_data(zip, info_data.data(), info_data.size()) < 0)
+            {
+                check_archive(zip, ARCHIVE_FATAL);
+            }
+
+            check_archive(zip, archive_write_close(zip));
+        }
+    }
+
     bool transmute(
         const fs::u8path& pkg_file,
         const fs::u8path& target,
@@ -792,6 +1018,13 @@ namespace mamba
         const ExtractOptions& options
     )
     {
+        if (util::ends_with(pkg_file.string(), ".tar.bz2")
+            && util::ends_with(target.string(), ".conda"))
+        {
+            transmute_tar_bz2_to_conda(pkg_file, target, compression_level, compression_threads);
+            return true;
+        }
+
         TemporaryDirectory extract_dir;
 
         if (util::ends_with(pkg_file.string(), ".tar.bz2"))
@@ -811,6 +1044,166 @@ namespace mamba
         return true;
     }
 
+    fs::u8path transmute_target(const fs::u8path& pkg_file)
+    {
+        const auto file = pkg_file.string();
+        if (util::ends_with(file, ".tar.bz2"))
+        {
+            return file.substr(0, file.size() - 8) + ".conda";
+        }
+        else if (util::ends_with(file, ".conda"))
+        {
+            return file.substr(0, file.size() - 6) + ".tar.bz2";
+        }
+        throw std::runtime_error("Unknown package format (" + file + ")");
+    }
+
+    std::pair<std::size_t, int>
+    balance_compression_threads(std::size_t n_archives, std::size_t n_threads)
+    {
+        n_threads = std::max<std::size_t>(n_threads, 1);
+        const std::size_t n_workers = std::clamp<std::size_t>(n_archives, 1, n_threads);
+        return { n_workers, static_cast<int>(n_threads / n_workers) };
+    }
+
+    namespace
+    {
+        void transmute_subproc(
+            const fs::u8path& pkg_file,
+            int compression_level,
+            int compression_threads,
+            const ExtractOptions& options
+        )
+        {
+            std::vector<std::string> args;
+            if (options.subproc_mode == extract_subproc_mode::mamba_exe)
+            {
+                args = { get_self_exe_path().string(), "package", "transmute" };
+            }
+            else
+            {
+                args = { "mamba-package", "transmute" };
+            }
+            if (compression_level != -1)
+            {
+                args.insert(args.end(), { "-c", std::to_string(compression_level) });
+            }
+            args.insert(
+                args.end(),
+                { "--compression-threads", std::to_string(compression_threads), pkg_file.string() }
+            );
+
+            std::string out, err;
+            LOG_DEBUG << "Running subprocess transmute '" << util::join(" ", args) << "'";
+            auto [status, ec] = reproc::run(
+                args,
+                reproc::options{},
+                reproc::sink::string(out),
+                reproc::sink::string(err)
+            );
+            if (ec)
+            {
+                throw std::runtime_error(util::concat("Could not run transmute: ", ec.message()));
+            }
+            if (status != 0)
+            {
+                throw std::runtime_error(
+                    util::concat("Transmute exited with code ", std::to_string(status), ": ", err)
+                );
+            }
+        }
+    }
+
+    TransmuteBatchResult transmute_batch(
+        const std::vector<fs::u8path>& pkg_files,
+        int compression_level,
+        int compression_threads,
+        std::size_t n_threads,
+        const ExtractOptions& options
+    )
+    {
+        const auto start = std::chrono::steady_clock::now();
+        std::size_t n_workers = 0;
+        if (compression_threads > 0)
+        {
+            // Only run as many packages as the threads left once each has its own
+            const std::size_t max_workers = std::max<std::size_t>(
+                n_threads / static_cast<std::size_t>(compression_threads),
+                1
+            );
+            n_workers = std::clamp<std::size_t>(pkg_files.size(), 1, max_workers);
+        }
+        else
+        {
+            std::tie(n_workers, compression_threads) = balance_compression_threads(
+                pkg_files.size(),
+                n_threads
+            );
+        }
+        LOG_INFO << "Transmuting " << pkg_files.size() << " packages on " << n_workers
+                 << " workers with " << compression_threads << " compression threads each";
+
+        TransmuteBatchResult result;
+        std::atomic<std::size_t> next = 0;
+        std::mutex result_mutex;
+
+        const auto worker = [&]
+        {
+            for (std::size_t i = next++; i < pkg_files.size(); i = next++)
+            {
+                if (is_sig_interrupted())
+                {
+                    return;
+                }
+                const auto& pkg_file = pkg_files[i];
+                try
+                {
+                    const auto target = transmute_target(pkg_file);
+                    const int level = (compression_level != -1)
+                                          ? compression_level
+                                          : (util::ends_with(target.string(), ".conda") ? 15 : 9);
+                    // Streaming conversions do not change the working directory
+                    const bool in_process = (n_workers == 1)
+                                            || util::ends_with(pkg_file.string(), ".tar.bz2");
+                    if (!in_process)
+                    {
+                        transmute_subproc(pkg_file, level, compression_threads, options);
+                    }
+                    else
+                    {
+                        transmute(pkg_file, target, level, compression_threads, options);
+                    }
+                    const auto input_bytes = fs::file_size(pkg_file);
+                    const auto output_bytes = fs::file_size(target);
+
+                    std::lock_guard lock(result_mutex);
+                    ++result.converted;
+                    result.input_bytes += input_bytes;
+                    result.output_bytes += output_bytes;
+                }
+                catch (const std::exception& e)
+                {
+                    std::lock_guard lock(result_mutex);
+                    result.failures.emplace_back(pkg_file, e.what());
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (std::size_t t = 1; t < n_workers; ++t)
+        {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+
+        result.elapsed = std::chrono::steady_clock::now() - start;
+        return result;
+    }
+
     bool validate(const fs::u8path& pkg_folder, const ValidationParams& params)
     {
         auto safety_checks = params.safety_checks;
@@ -24,6 +24,8 @@
 #include "mamba/util/graph.hpp"
 #include "mamba/util/string.hpp"
 
+#include "core/prefix_index.hpp"
+
 namespace mamba
 {
     auto
@@ -55,11 +57,21 @@ namespace mamba
         auto conda_meta_dir = m_prefix_path / "conda-meta";
         if (lexists(conda_meta_dir))
         {
-            for (auto& p : fs::directory_iterator(conda_meta_dir))
+            auto index = PrefixIndex::load(conda_meta_dir);
+            for (const auto& entry : index.entries())
+            {
+                add_record(entry.record);
+            }
+            if (index.is_stale())
             {
-                if (util::ends_with(p.path().string(), ".json"))
+                // Best effort, the prefix may be read-only
+                try
+                {
+                    index.write(conda_meta_dir);
+                }
+                catch (const std::exception& e)
                 {
-                    load_single_record(p.path());
+                    LOG_DEBUG << "Could not update prefix index: " << e.what();
                 }
             }
         }
@@ -192,22 +204,33 @@ namespace mamba
     void PrefixData::load_single_record(const fs::u8path& path)
     {
         LOG_INFO << "Loading single package record: " << path;
-        auto infile = open_ifstream(path);
-        nlohmann::json j;
-        infile >> j;
-        auto prec = j.get<specs::PackageInfo>();
+        add_record(read_conda_meta_record(path));
+    }
 
+    void PrefixData::add_record(specs::PackageInfo prec)
+    {
         // Some versions of micromamba constructor generate repodata_record.json
         // and conda-meta json files with channel names while mamba expects
         // specs::PackageInfo channels to be platform urls. This fixes the issue described
         // in https://github.com/mamba-org/mamba/issues/2665
 
-        auto channels = m_channel_context.make_channel(prec.channel);
-        // If someone wrote multichannel names in repodata_record, we don't know which one is the
-        // correct URL. This must never happen!
-        assert(channels.size() == 1);
-        using Credentials = specs::CondaURL::Credentials;
-        prec.channel = channels.front().platform_url(prec.platform).str(Credentials::Remove);
+        auto key = std::pair(prec.channel, prec.platform);
+        auto it = m_record_channel_urls.find(key);
+        if (it == m_record_channel_urls.end())
+        {
+            auto channels = m_channel_context.make_channel(prec.channel);
+            // If someone wrote multichannel names in repodata_record, we don't know which one is
+            // the correct URL. This must never happen!
+            assert(channels.size() == 1);
+            using Credentials = specs::CondaURL::Credentials;
+            it = m_record_channel_urls
+                     .emplace(
+                         std::move(key),
+                         channels.front().platform_url(prec.platform).str(Credentials::Remove)
+                     )
+                     .first;
+        }
+        prec.channel = it->second;
         m_package_records.insert({ prec.name, std::move(prec) });
     }
 
@@ -0,0 +1,194 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+
+#include "mamba/core/output.hpp"
+#include "mamba/core/util.hpp"
+#include "mamba/util/random.hpp"
+#include "mamba/util/string.hpp"
+
+#include "core/prefix_index.hpp"
+
+namespace mamba
+{
+    namespace
+    {
+        using entry_map = std::unordered_map<std::string, PrefixIndex::Entry>;
+
+        auto read_index_file(const fs::u8path& index_path) -> entry_map
+        {
+            auto entries = entry_map();
+            std::error_code ec;
+            if (!fs::exists(index_path, ec))
+            {
+                return entries;
+            }
+
+            try
+            {
+                auto infile = open_ifstream(index_path);
+                const auto j = nlohmann::json::parse(infile);
+                if (j.at("version").get<int>() != PrefixIndex::version)
+                {
+                    return entries;
+                }
+                for (const auto& jentry : j.at("records"))
+                {
+                    auto entry = PrefixIndex::Entry{
+                        /* .filename= */ jentry.at("filename").get<std::string>(),
+                        /* .size= */ jentry.at("size").get<std::uintmax_t>(),
+                        /* .mtime= */ jentry.at("mtime").get<std::int64_t>(),
+                        /* .record= */ jentry.at("record").get<specs::PackageInfo>(),
+                    };
+                    auto key = entry.filename;
+                    entries.emplace(std::move(key), std::move(entry));
+                }
+            }
+            catch (const std::exception& e)
+            {
+                LOG_DEBUG << "Ignoring invalid prefix index '" << index_path.string()
+                          << "': " << e.what();
+                return {};
+            }
+            return entries;
+        }
+    }
+
+    auto read_conda_meta_record(const fs::u8path& path) -> specs::PackageInfo
+    {
+        static constexpr auto skip_large_entries =
+            [](int depth, nlohmann::json::parse_event_t event, nlohmann::json& parsed)
+        {
+            // Returning false on a key discards its value without building it
+            return !(
+                (depth == 1) && (event == nlohmann::json::parse_event_t::key)
+                && ((parsed == "files") || (parsed == "paths_data"))
+            );
+        };
+
+        auto infile = open_ifstream(path);
+        return nlohmann::json::parse(infile, skip_large_entries).get<specs::PackageInfo>();
+    }
+
+    auto PrefixIndex::load(const fs::u8path& conda_meta_dir) -> PrefixIndex
+    {
+        auto cached = read_index_file(conda_meta_dir / filename);
+        std::size_t n_cached_used = 0;
+
+        auto index = PrefixIndex();
+        for (const auto& p : fs::directory_iterator(conda_meta_dir))
+        {
+            auto name = p.path().filename().string();
+            if (!util::ends_with(name, ".json"))
+            {
+                continue;
+            }
+
+            std::error_code ec;
+            const auto size = p.file_size(ec);
+            const auto mtime = ec ? 0 : p.last_write_time(ec).time_since_epoch().count();
+            if (!ec)
+            {
+                const auto it = cached.find(name);
+                if ((it != cached.end()) && (it->second.size == size)
+                    && (it->second.mtime == mtime))
+                {
+                    index.m_entries.push_back(std::move(it->second));
+                    ++n_cached_used;
+                    continue;
+                }
+            }
+
+            LOG_INFO << "Loading single package record: " << p.path();
+            auto record = read_conda_meta_record(p.path());
+            index.m_entries.push_back({ std::move(name), size, mtime, std::move(record) });
+            index.m_stale = true;
+        }
+
+        // Records removed since the index was written
+        index.m_stale = index.m_stale || (n_cached_used != cached.size());
+        return index;
+    }
+
+    void PrefixIndex::refresh(const fs::u8path& conda_meta_dir)
+    {
+        try
+        {
+            const auto index = load(conda_meta_dir);
+            if (index.is_stale())
+            {
+                index.write(conda_meta_dir);
+            }
+        }
+        catch (const std::exception& e)
+        {
+            LOG_DEBUG << "Could not update prefix index in '" << conda_meta_dir.string()
+                      << "': " << e.what();
+        }
+    }
+
+    auto PrefixIndex::entries() const -> const std::vector<Entry>&
+    {
+        return m_entries;
+    }
+
+    auto PrefixIndex::is_stale() const -> bool
+    {
+        return m_stale;
+    }
+
+    void PrefixIndex::write(const fs::u8path& conda_meta_dir) const
+    {
+        auto records = nlohmann::json::array();
+        for (const auto& entry : m_entries)
+        {
+            records.push_back({
+                { "filename", entry.filename },
+                { "size", entry.size },
+                { "mtime", entry.mtime },
+                { "record", entry.record },
+            });
+        }
+        const auto j = nlohmann::json{ { "version", version }, { "records", std::move(records) } };
+
+        // Write to a temporary file and rename it so that readers never see a partial index
+        const auto index_path = conda_meta_dir / filename;
+        const auto tmp_path = conda_meta_dir
+                              / util::concat(
+                                  filename,
+                                  ".",
+                                  util::generate_random_alphanumeric_string(8),
+                                  ".tmp"
+                              );
+        {
+            // Not ``open_ofstream``, which logs an error: callers may ignore a read-only prefix
+            std::ofstream out(tmp_path.std_path(), std::ios::out | std::ios::binary);
+            if (!out)
+            {
+                throw std::runtime_error(
+                    util::concat("Could not open '", tmp_path.string(), "' for writing")
+                );
+            }
+            out << j.dump();
+        }
+        std::error_code ec;
+        fs::rename(tmp_path, index_path, ec);
+        if (ec)
+        {
+            const auto message = ec.message();
+            fs::remove(tmp_path, ec);
+            throw std::runtime_error(
+                util::concat("Could not write prefix index '", index_path.string(), "': ", message)
+            );
+        }
+    }
+}
@@ -0,0 +1,76 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#ifndef MAMBA_CORE_PREFIX_INDEX_HPP
+#define MAMBA_CORE_PREFIX_INDEX_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "mamba/fs/filesystem.hpp"
+#include "mamba/specs/package_info.hpp"
+
+namespace mamba
+{
+    /**
+     * Read a ``conda-meta`` package record, skipping the large ``files`` and ``paths_data``
+     * entries while parsing rather than building them in memory.
+     */
+    [[nodiscard]] auto read_conda_meta_record(const fs::u8path& path) -> specs::PackageInfo;
+
+    /**
+     * A cache of the package records of the ``conda-meta`` directory of a prefix.
+     *
+     * The records are stored in ``conda-meta/.index`` with only the fields of
+     * ``specs::PackageInfo``.
+     * Every record is validated against the size and modification time of its ``conda-meta``
+     * JSON file, so that only new or modified files are parsed again.
+     * The index is replaced atomically and is never required to be up to date: a stale or
+     * missing index only means more files are parsed.
+     */
+    class PrefixIndex
+    {
+    public:
+
+        static constexpr std::string_view filename = ".index";
+        static constexpr int version = 1;
+
+        struct Entry
+        {
+            std::string filename;
+            std::uintmax_t size = 0;
+            std::int64_t mtime = 0;
+            specs::PackageInfo record;
+        };
+
+        /** Load the records of ``conda_meta_dir``, using its index where it is valid. */
+        [[nodiscard]] static auto load(const fs::u8path& conda_meta_dir) -> PrefixIndex;
+
+        /**
+         * Bring the index of ``conda_meta_dir`` up to date, for instance after a transaction.
+         *
+         * Errors are logged but not reported since the index is only a cache.
+         */
+        static void refresh(const fs::u8path& conda_meta_dir);
+
+        [[nodiscard]] auto entries() const -> const std::vector<Entry>&;
+
+        /** Whether some records were not found in the index on disk. */
+        [[nodiscard]] auto is_stale() const -> bool;
+
+        /** Atomically replace the index on disk. */
+        void write(const fs::u8path& conda_meta_dir) const;
+
+    private:
+
+        std::vector<Entry> m_entries;
+        bool m_stale = false;
+    };
+}
+
+#endif
@@ -0,0 +1,325 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <functional>
+#include <sstream>
+
+#include <nlohmann/json.hpp>
+
+#include "mamba/core/output.hpp"
+#include "mamba/core/util.hpp"
+#include "mamba/util/encoding.hpp"
+#include "mamba/util/mapped_file.hpp"
+
+#include "core/prefix_replacement.hpp"
+
+namespace mamba
+{
+    namespace
+    {
+        void write(std::ostream& out, std::string_view data)
+        {
+            out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        }
+
+        void write_nulls(std::ostream& out, std::size_t count)
+        {
+            static constexpr std::string_view nulls("\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0", 16);
+            for (; count > nulls.size(); count -= nulls.size())
+            {
+                write(out, nulls);
+            }
+            write(out, nulls.substr(0, count));
+        }
+    }
+
+    auto find_prefix_placeholder(std::string_view data, std::string_view placeholder)
+        -> std::vector<std::size_t>
+    {
+        std::vector<std::size_t> offsets;
+        if (placeholder.empty() || data.size() < placeholder.size())
+        {
+            return offsets;
+        }
+
+        const auto searcher = std::boyer_moore_horspool_searcher(
+            placeholder.begin(),
+            placeholder.end()
+        );
+        auto it = data.begin();
+        while (true)
+        {
+            it = std::search(it, data.end(), searcher);
+            if (it == data.end())
+            {
+                break;
+            }
+            const auto pos = static_cast<std::size_t>(it - data.begin());
+            offsets.push_back(pos);
+            it += static_cast<std::ptrdiff_t>(placeholder.size());
+        }
+        return offsets;
+    }
+
+    void write_text_prefix_replaced(
+        std::ostream& out,
+        std::string_view data,
+        std::string_view placeholder,
+        std::string_view new_prefix,
+        const std::vector<std::size_t>& offsets
+    )
+    {
+        std::size_t cursor = 0;
+        for (const auto pos : offsets)
+        {
+            assert(pos >= cursor);
+            assert(data.substr(pos, placeholder.size()) == placeholder);
+            write(out, data.substr(cursor, pos - cursor));
+            write(out, new_prefix);
+            cursor = pos + placeholder.size();
+        }
+        write(out, data.substr(cursor));
+    }
+
+    void write_binary_prefix_replaced(
+        std::ostream& out,
+        std::string_view data,
+        std::string_view placeholder,
+        std::string_view new_prefix,
+        const std::vector<std::size_t>& offsets
+    )
+    {
+        const std::size_t padding_size = (placeholder.size() > new_prefix.size())
+                                             ? placeholder.size() - new_prefix.size()
+                                             : 0;
+
+        std::size_t cursor = 0;
+        auto offset_it = offsets.cbegin();
+        while (offset_it != offsets.cend())
+        {
+            const std::size_t pos = *offset_it;
+            assert(pos >= cursor);
+            write(out, data.substr(cursor, pos - cursor));
+
+            // The null-terminated string holding the placeholder, which may contain several
+            // occurrences (e.g. a search path).
+            std::size_t end = data.find('\0', pos + placeholder.size());
+            if (end == std::string_view::npos)
+            {
+                end = data.size();
+            }
+
+            std::size_t n_replaced = 0;
+            std::size_t str_cursor = pos;
+            for (; (offset_it != offsets.cend()) && (*offset_it < end); ++offset_it)
+            {
+                assert(data.substr(*offset_it, placeholder.size()) == placeholder);
+                write(out, data.substr(str_cursor, *offset_it - str_cursor));
+                write(out, new_prefix);
+                str_cursor = *offset_it + placeholder.size();
+                ++n_replaced;
+            }
+            write(out, data.substr(str_cursor, end - str_cursor));
+            write_nulls(out, n_replaced * padding_size);
+            cursor = end;
+        }
+        write(out, data.substr(cursor));
+    }
+
+    auto replace_prefix_placeholder(
+        std::string_view data,
+        std::string_view placeholder,
+        std::string_view new_prefix
+    ) -> std::string
+    {
+        std::ostringstream out;
+        write_text_prefix_replaced(
+            out,
+            data,
+            placeholder,
+            new_prefix,
+            find_prefix_placeholder(data, placeholder)
+        );
+        return out.str();
+    }
+
+    Sha256OutputBuffer::Sha256OutputBuffer(std::streambuf* sink)
+        : m_sink(sink)
+    {
+        m_digester.digest_start();
+    }
+
+    auto Sha256OutputBuffer::hex_digest() -> std::string
+    {
+        auto bytes = std::array<std::byte, util::Sha256Digester::bytes_size>{};
+        m_digester.digest_finalize_to(bytes.data());
+        return util::bytes_to_hex_str(bytes.data(), bytes.data() + bytes.size());
+    }
+
+    auto Sha256OutputBuffer::xsputn(const char_type* s, std::streamsize count) -> std::streamsize
+    {
+        const auto written = m_sink->sputn(s, count);
+        if (written > 0)
+        {
+            m_digester.digest_update(
+                reinterpret_cast<const std::byte*>(s),
+                static_cast<std::size_t>(written)
+            );
+        }
+        return written;
+    }
+
+    auto Sha256OutputBuffer::overflow(int_type ch) -> int_type
+    {
+        if (traits_type::eq_int_type(ch, traits_type::eof()))
+        {
+            return traits_type::not_eof(ch);
+        }
+        const auto c = traits_type::to_char_type(ch);
+        return (xsputn(&c, 1) == 1) ? ch : traits_type::eof();
+    }
+
+    auto Sha256OutputBuffer::sync() -> int
+    {
+        return m_sink->pubsync();
+    }
+
+    auto PrefixPlaceholderIndex::build(
+        const fs::u8path& extracted_dir,
+        const std::vector<PathData>& paths
+    ) -> PrefixPlaceholderIndex
+    {
+        auto index = PrefixPlaceholderIndex();
+        for (const auto& path_data : paths)
+        {
+            if (path_data.prefix_placeholder.empty() || path_data.path_type == PathType::SOFTLINK)
+            {
+                continue;
+            }
+            auto mapped = util::MappedFile::try_open(extracted_dir / path_data.path);
+            if (!mapped)
+            {
+                LOG_DEBUG << "Could not index prefix placeholder of '" << path_data.path
+                          << "': " << mapped.error().message();
+                continue;
+            }
+            const auto data = mapped->view();
+            index.insert(
+                path_data.path,
+                {
+                    /* .placeholder= */ path_data.prefix_placeholder,
+                    /* .size= */ data.size(),
+                    /* .offsets= */ find_prefix_placeholder(data, path_data.prefix_placeholder),
+                }
+            );
+        }
+        return index;
+    }
+
+    auto PrefixPlaceholderIndex::read(const fs::u8path& extracted_dir) -> PrefixPlaceholderIndex
+    {
+        auto index = PrefixPlaceholderIndex();
+        const auto index_path = extracted_dir / "info" / filename;
+        std::error_code ec;
+        if (!fs::exists(index_path, ec))
+        {
+            return index;
+        }
+
+        try
+        {
+            auto in = open_ifstream(index_path);
+            const auto j = nlohmann::json::parse(in);
+            if (j.at("version").get<int>() != 1)
+            {
+                return index;
+            }
+            for (const auto& [path, entry] : j.at("paths").items())
+            {
+                index.insert(
+                    path,
+                    {
+                        /* .placeholder= */ entry.at("prefix_placeholder").get<std::string>(),
+                        /* .size= */ entry.at("size_in_bytes").get<std::size_t>(),
+                        /* .offsets= */ entry.at("offsets").get<std::vector<std::size_t>>(),
+                    }
+                );
+            }
+        }
+        catch (const std::exception& e)
+        {
+            LOG_DEBUG << "Ignoring invalid prefix placeholder index '" << index_path.string()
+                      << "': " << e.what();
+            return {};
+        }
+        return index;
+    }
+
+    void PrefixPlaceholderIndex::write(const fs::u8path& extracted_dir) const
+    {
+        auto paths = nlohmann::json::object();
+        for (const auto& [path, entry] : m_entries)
+        {
+            paths[path] = {
+                { "prefix_placeholder", entry.placeholder },
+                { "size_in_bytes", entry.size },
+                { "offsets", entry.offsets },
+            };
+        }
+        const auto j = nlohmann::json{ { "version", 1 }, { "paths", std::move(paths) } };
+
+        auto out = open_ofstream(extracted_dir / "info" / filename);
+        out << j.dump();
+    }
+
+    void PrefixPlaceholderIndex::insert(std::string path, Entry entry)
+    {
+        m_entries.insert_or_assign(std::move(path), std::move(entry));
+    }
+
+    auto PrefixPlaceholderIndex::size() const -> std::size_t
+    {
+        return m_entries.size();
+    }
+
+    auto PrefixPlaceholderIndex::empty() const -> bool
+    {
+        return m_entries.empty();
+    }
+
+    auto PrefixPlaceholderIndex::find(
+        const std::string& path,
+        std::string_view placeholder,
+        std::string_view data
+    ) const -> const std::vector<std::size_t>*
+    {
+        const auto it = m_entries.find(path);
+        if (it == m_entries.cend())
+        {
+            return nullptr;
+        }
+        const auto& entry = it->second;
+        if ((entry.placeholder != placeholder) || (entry.size != data.size()))
+        {
+            return nullptr;
+        }
+
+        std::size_t cursor = 0;
+        for (const auto pos : entry.offsets)
+        {
+            if ((pos < cursor) || (pos > data.size())
+                || (data.substr(pos, placeholder.size()) != placeholder))
+            {
+                return nullptr;
+            }
+            cursor = pos + placeholder.size();
+        }
+        return &entry.offsets;
+    }
+}
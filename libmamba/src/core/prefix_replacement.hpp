@@ -0,0 +1,150 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#ifndef MAMBA_CORE_PREFIX_REPLACEMENT_HPP
+#define MAMBA_CORE_PREFIX_REPLACEMENT_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "mamba/core/package_paths.hpp"
+#include "mamba/fs/filesystem.hpp"
+#include "mamba/util/cryptography.hpp"
+
+namespace mamba
+{
+    /**
+     * Offsets of the non-overlapping occurrences of ``placeholder`` in ``data``, in order.
+     *
+     * Uses a Boyer-Moore-Horspool search, which skips most of the input for the long
+     * placeholders used by conda-build.
+     */
+    [[nodiscard]] auto
+    find_prefix_placeholder(std::string_view data, std::string_view placeholder)
+        -> std::vector<std::size_t>;
+
+    /**
+     * Write ``data`` to ``out`` with the placeholders found at ``offsets`` replaced by
+     * ``new_prefix``.
+     *
+     * Text mode: every occurrence is simply substituted.
+     */
+    void write_text_prefix_replaced(
+        std::ostream& out,
+        std::string_view data,
+        std::string_view placeholder,
+        std::string_view new_prefix,
+        const std::vector<std::size_t>& offsets
+    );
+
+    /**
+     * Write ``data`` to ``out`` with the placeholders found at ``offsets`` replaced by
+     * ``new_prefix``.
+     *
+     * Binary mode: the null-terminated string containing the placeholder is rewritten and padded
+     * with null characters so that the file layout is unchanged (as long as ``new_prefix`` is
+     * not longer than ``placeholder``).
+     */
+    void write_binary_prefix_replaced(
+        std::ostream& out,
+        std::string_view data,
+        std::string_view placeholder,
+        std::string_view new_prefix,
+        const std::vector<std::size_t>& offsets
+    );
+
+    /** Replace all occurrences of ``placeholder`` in a small string, as in text mode. */
+    [[nodiscard]] auto replace_prefix_placeholder(
+        std::string_view data,
+        std::string_view placeholder,
+        std::string_view new_prefix
+    ) -> std::string;
+
+    /**
+     * An output stream buffer forwarding to another one while computing the SHA256 of the data.
+     *
+     * Used to hash the files written during prefix replacement without reading them again.
+     */
+    class Sha256OutputBuffer : public std::streambuf
+    {
+    public:
+
+        explicit Sha256OutputBuffer(std::streambuf* sink);
+
+        /** Hexadecimal SHA256 of everything written so far, ends the computation. */
+        [[nodiscard]] auto hex_digest() -> std::string;
+
+    protected:
+
+        auto xsputn(const char_type* s, std::streamsize count) -> std::streamsize override;
+        auto overflow(int_type ch) -> int_type override;
+        auto sync() -> int override;
+
+    private:
+
+        std::streambuf* m_sink;
+        util::Sha256Digester m_digester = {};
+    };
+
+    /**
+     * Offsets of the prefix placeholders in the files of an extracted package.
+     *
+     * The index is computed when the package is extracted in the package cache and stored in
+     * the ``info`` directory, so that linking the package in an environment only needs to patch
+     * the recorded offsets rather than scanning the whole files again.
+     * Being stored in the extracted directory, it is removed along with it.
+     */
+    class PrefixPlaceholderIndex
+    {
+    public:
+
+        struct Entry
+        {
+            std::string placeholder;
+            std::size_t size = 0;
+            std::vector<std::size_t> offsets;
+        };
+
+        static constexpr std::string_view filename = "prefix_placeholder_offsets.json";
+
+        /** Scan the files of ``paths`` that have a prefix placeholder. */
+        [[nodiscard]] static auto
+        build(const fs::u8path& extracted_dir, const std::vector<PathData>& paths)
+            -> PrefixPlaceholderIndex;
+
+        /** Read the index of an extracted package, or an empty index if it has none. */
+        [[nodiscard]] static auto read(const fs::u8path& extracted_dir) -> PrefixPlaceholderIndex;
+
+        void write(const fs::u8path& extracted_dir) const;
+
+        void insert(std::string path, Entry entry);
+
+        [[nodiscard]] auto size() const -> std::size_t;
+        [[nodiscard]] auto empty() const -> bool;
+
+        /**
+         * The recorded offsets of ``placeholder`` in the file at ``path``.
+         *
+         * The offsets are checked against the file content ``data`` (size and placeholder at
+         * every offset, which is cheap) and ``nullptr`` is returned if they do not match, in
+         * which case the file must be scanned.
+         */
+        [[nodiscard]] auto
+        find(const std::string& path, std::string_view placeholder, std::string_view data) const
+            -> const std::vector<std::size_t>*;
+
+    private:
+
+        std::unordered_map<std::string, Entry> m_entries;
+    };
+}
+
+#endif
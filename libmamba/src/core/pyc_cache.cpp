@@ -0,0 +1,221 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <system_error>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+#include "mamba/core/output.hpp"
+#include "mamba/util/random.hpp"
+#include "mamba/util/string.hpp"
+
+#include "core/pyc_cache.hpp"
+
+namespace mamba
+{
+    namespace
+    {
+        // PEP 552: magic (4 bytes), flags (4 bytes), then either the source mtime and size
+        // (4 bytes each) or an 8 bytes source hash.
+        constexpr std::size_t pyc_header_size = 16;
+        constexpr std::uint32_t pyc_flag_hash_based = 0b01;
+
+        auto read_le32(const std::array<char, pyc_header_size>& header, std::size_t offset)
+            -> std::uint32_t
+        {
+            std::uint32_t out = 0;
+            for (std::size_t i = 0; i < 4; ++i)
+            {
+                out |= static_cast<std::uint32_t>(static_cast<unsigned char>(header[offset + i]))
+                       << (8 * i);
+            }
+            return out;
+        }
+
+        auto read_pyc_header(const fs::u8path& pyc_file)
+            -> std::optional<std::array<char, pyc_header_size>>
+        {
+            std::ifstream in(pyc_file.std_path(), std::ios::in | std::ios::binary);
+            auto header = std::array<char, pyc_header_size>{};
+            if (!in.read(header.data(), header.size()))
+            {
+                return std::nullopt;
+            }
+            return header;
+        }
+
+        /** The source mtime as stored by CPython, i.e. ``int(st_mtime) & 0xFFFFFFFF``. */
+        auto source_mtime(const fs::u8path& py_file) -> std::optional<std::uint32_t>
+        {
+#ifdef _WIN32
+            std::error_code ec;
+            const auto filetime = fs::last_write_time(py_file, ec);
+            if (ec)
+            {
+                return std::nullopt;
+            }
+            // windows filetime is in 100ns intervals since 1601-01-01
+            static constexpr auto epoch_offset = std::chrono::seconds(11644473600ULL);
+            const auto unix_time = std::chrono::duration_cast<std::chrono::seconds>(
+                filetime.time_since_epoch() - epoch_offset
+            );
+            return static_cast<std::uint32_t>(unix_time.count());
+#else
+            struct stat st;
+            if (::stat(py_file.string().c_str(), &st) != 0)
+            {
+                return std::nullopt;
+            }
+            return static_cast<std::uint32_t>(st.st_mtime);
+#endif
+        }
+
+        /** Whether the bytecode in ``pyc_file`` would be considered up to date for ``py_file``. */
+        auto is_pyc_valid_for(const fs::u8path& pyc_file, const fs::u8path& py_file) -> bool
+        {
+            const auto header = read_pyc_header(pyc_file);
+            if (!header.has_value())
+            {
+                return false;
+            }
+            if (read_le32(*header, 4) & pyc_flag_hash_based)
+            {
+                // The source hash is part of the cache key
+                return true;
+            }
+
+            std::error_code ec;
+            const auto size = fs::file_size(py_file, ec);
+            const auto mtime = source_mtime(py_file);
+            return !ec && mtime.has_value() && (read_le32(*header, 8) == mtime.value())
+                   && (read_le32(*header, 12) == static_cast<std::uint32_t>(size));
+        }
+    }
+
+    auto pyc_cache_tag(const std::string& short_python_version) -> std::string
+    {
+        if (short_python_version.empty() || short_python_version[0] == '2')
+        {
+            return "";
+        }
+        std::string nodot = short_python_version;
+        util::replace_all(nodot, ".", "");
+        // Free-threaded builds share the cache tag of the regular interpreter
+        util::replace_all(nodot, "t", "");
+        return util::concat("cpython-", nodot);
+    }
+
+    PycCache::PycCache(fs::u8path cache_dir)
+        : m_cache_dir(std::move(cache_dir))
+    {
+    }
+
+    auto PycCache::path() const -> const fs::u8path&
+    {
+        return m_cache_dir;
+    }
+
+    auto PycCache::entry_path(const Key& key) const -> fs::u8path
+    {
+        return m_cache_dir / key.cache_tag / util::concat("opt-", std::to_string(key.optimization))
+               / key.source_sha256.substr(0, 2) / util::concat(key.source_sha256, ".pyc");
+    }
+
+    auto
+    PycCache::fetch(const Key& key, const fs::u8path& py_file, const fs::u8path& pyc_file) const
+        -> bool
+    {
+        if (key.source_sha256.size() < 2 || key.cache_tag.empty())
+        {
+            return false;
+        }
+
+        const auto entry = entry_path(key);
+        if (!is_pyc_valid_for(entry, py_file))
+        {
+            return false;
+        }
+
+        std::error_code ec;
+        fs::create_directories(pyc_file.parent_path(), ec);
+        fs::remove(pyc_file, ec);
+        ec.clear();
+        fs::create_hard_link(entry, pyc_file, ec);
+        if (ec)
+        {
+            ec.clear();
+            fs::copy_file(entry, pyc_file, fs::copy_options::overwrite_existing, ec);
+        }
+        if (ec)
+        {
+            LOG_DEBUG << "Could not use cached bytecode '" << entry.string()
+                      << "': " << ec.message();
+            return false;
+        }
+        LOG_TRACE << "Using cached bytecode '" << entry.string() << "' for '" << py_file.string()
+                  << "'";
+        return true;
+    }
+
+    auto
+    PycCache::store(const Key& key, const fs::u8path& py_file, const fs::u8path& pyc_file) const
+        -> bool
+    {
+        if (key.source_sha256.size() < 2 || key.cache_tag.empty())
+        {
+            return false;
+        }
+
+        // Do not poison the cache with bytecode that Python would reject anyway
+        if (!is_pyc_valid_for(pyc_file, py_file))
+        {
+            return false;
+        }
+
+        const auto entry = entry_path(key);
+        std::error_code ec;
+        fs::create_directories(entry.parent_path(), ec);
+        if (ec)
+        {
+            LOG_DEBUG << "Could not create bytecode cache directory '"
+                      << entry.parent_path().string() << "': " << ec.message();
+            return false;
+        }
+
+        // Stage the entry under a temporary name and rename it over any existing, possibly
+        // stale, entry so that concurrent processes never see partial entries.
+        const auto tmp_entry = fs::u8path(
+            util::concat(entry.string(), ".", util::generate_random_alphanumeric_string(8), ".tmp")
+        );
+        fs::create_hard_link(pyc_file, tmp_entry, ec);
+        if (ec)
+        {
+            // Different filesystems, copy instead.
+            ec.clear();
+            fs::copy_file(pyc_file, tmp_entry, fs::copy_options::overwrite_existing, ec);
+        }
+        if (!ec)
+        {
+            fs::rename(tmp_entry, entry, ec);
+        }
+        if (ec)
+        {
+            LOG_DEBUG << "Could not add bytecode '" << pyc_file.string() << "' to cache: "
+                      << ec.message();
+            std::error_code rm_ec;
+            fs::remove(tmp_entry, rm_ec);
+            return false;
+        }
+        return true;
+    }
+}
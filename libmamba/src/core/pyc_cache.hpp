@@ -0,0 +1,75 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#ifndef MAMBA_CORE_PYC_CACHE_HPP
+#define MAMBA_CORE_PYC_CACHE_HPP
+
+#include <string>
+
+#include "mamba/fs/filesystem.hpp"
+
+namespace mamba
+{
+    /**
+     * Bytecode cache tag of a CPython version, as in ``sys.implementation.cache_tag``.
+     *
+     * For instance ``cpython-312`` for ``3.12`` and ``cpython-313`` for ``3.13t``.
+     * Returns an empty string for Python 2, which does not use ``__pycache__``.
+     */
+    [[nodiscard]] auto pyc_cache_tag(const std::string& short_python_version) -> std::string;
+
+    /**
+     * Content addressed store of compiled Python bytecode shared across environments.
+     *
+     * Entries are keyed by the sha256 of the ``.py`` source (as recorded in ``paths.json``),
+     * the interpreter cache tag, and the optimization level.
+     * Since bytecode is compiled from paths relative to the target prefix, the ``.pyc`` only
+     * depends on the source content and can be hard-linked in any environment.
+     *
+     * Entries are only reused if their header matches the stat of the source they are linked
+     * next to, so a cache hit is exactly what ``compileall`` would have produced.
+     */
+    class PycCache
+    {
+    public:
+
+        struct Key
+        {
+            std::string source_sha256;
+            std::string cache_tag;
+            int optimization = 0;
+        };
+
+        explicit PycCache(fs::u8path cache_dir);
+
+        [[nodiscard]] auto path() const -> const fs::u8path&;
+
+        /** Location of the entry for the given key, whether it exists or not. */
+        [[nodiscard]] auto entry_path(const Key& key) const -> fs::u8path;
+
+        /**
+         * Hard-link (or copy) the cached bytecode of ``py_file`` to ``pyc_file``.
+         *
+         * @return false if there is no valid entry, in which case ``pyc_file`` is untouched.
+         */
+        auto fetch(const Key& key, const fs::u8path& py_file, const fs::u8path& pyc_file) const
+            -> bool;
+
+        /**
+         * Add a freshly compiled ``pyc_file`` of ``py_file`` to the cache.
+         *
+         * Failures (e.g. read-only package cache) are not errors and only return false.
+         */
+        auto store(const Key& key, const fs::u8path& py_file, const fs::u8path& pyc_file) const
+            -> bool;
+
+    private:
+
+        fs::u8path m_cache_dir;
+    };
+}
+
+#endif
@@ -0,0 +1,165 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <algorithm>
+#include <string>
+
+#include "mamba/core/repodata_prefilter.hpp"
+#include "mamba/solver/libsolv/database.hpp"
+#include "mamba/specs/match_spec.hpp"
+#include "mamba/util/string.hpp"
+
+#include "core/shard_python_minor_prefilter.hpp"
+
+namespace mamba
+{
+    RepodataPrefilter::RepodataPrefilter(
+        std::optional<specs::Version> python_minor,
+        std::optional<std::vector<specs::PackageInfo>> virtual_packages
+    )
+        : m_python_minor(std::move(python_minor))
+    {
+        if (virtual_packages.has_value())
+        {
+            auto promise = std::promise<std::vector<specs::PackageInfo>>();
+            promise.set_value(std::move(virtual_packages).value());
+            m_virtual_packages = promise.get_future().share();
+        }
+    }
+
+    RepodataPrefilter::RepodataPrefilter(
+        std::optional<specs::Version> python_minor,
+        std::shared_future<std::vector<specs::PackageInfo>> virtual_packages
+    )
+        : m_python_minor(std::move(python_minor))
+        , m_virtual_packages(std::move(virtual_packages))
+    {
+    }
+
+    auto RepodataPrefilter::is_active() const -> bool
+    {
+        return m_python_minor.has_value() || m_virtual_packages.has_value();
+    }
+
+    auto RepodataPrefilter::python_minor() const -> const std::optional<specs::Version>&
+    {
+        return m_python_minor;
+    }
+
+    auto RepodataPrefilter::with_python_minor(std::optional<specs::Version> python_minor) const
+        -> RepodataPrefilter
+    {
+        auto out = RepodataPrefilter();
+        out.m_python_minor = std::move(python_minor);
+        out.m_virtual_packages = m_virtual_packages;
+        return out;
+    }
+
+    auto RepodataPrefilter::key() const -> std::string
+    {
+        if (!is_active())
+        {
+            return {};
+        }
+        auto out = std::string("prefilter");
+        if (m_python_minor.has_value())
+        {
+            out += util::concat(":python=", m_python_minor->to_string());
+        }
+        if (m_virtual_packages.has_value())
+        {
+            out += ":virtual";
+            for (const auto& pkg : m_virtual_packages->get())
+            {
+                out += util::concat(",", pkg.name, "=", pkg.version, "=", pkg.build_string);
+            }
+        }
+        return out;
+    }
+
+    auto RepodataPrefilter::evaluate(std::string_view dependency) const -> bool
+    {
+        auto maybe_name = specs::MatchSpec::extract_name(dependency);
+        if (!maybe_name.has_value())
+        {
+            return true;
+        }
+        const auto& name = maybe_name.value();
+
+        if (m_python_minor.has_value() && (name == "python"))
+        {
+            return matches_python_minor(std::string(dependency), *m_python_minor);
+        }
+
+        if (m_virtual_packages.has_value() && util::starts_with(name, "__"))
+        {
+            const auto& virtual_packages = m_virtual_packages->get();
+            const auto it = std::find_if(
+                virtual_packages.cbegin(),
+                virtual_packages.cend(),
+                [&](const specs::PackageInfo& pkg) { return pkg.name == name; }
+            );
+            if (it == virtual_packages.cend())
+            {
+                return false;
+            }
+            auto maybe_ms = specs::MatchSpec::parse(dependency);
+            return !maybe_ms.has_value() || maybe_ms->contains_except_channel(*it);
+        }
+
+        return true;
+    }
+
+    auto RepodataPrefilter::accepts_dependency(std::string_view dependency) const -> bool
+    {
+        // Only python and virtual packages can be rejected, skip the cache for the rest.
+        const bool may_reject = (m_python_minor.has_value() && util::contains(dependency, "python"))
+                                || (m_virtual_packages.has_value()
+                                    && util::contains(dependency, "__"));
+        if (!may_reject)
+        {
+            return true;
+        }
+
+        {
+            auto lock = std::lock_guard(m_verdicts->mutex);
+            if (const auto it = m_verdicts->by_dependency.find(std::string(dependency));
+                it != m_verdicts->by_dependency.cend())
+            {
+                return it->second;
+            }
+        }
+        const bool verdict = evaluate(dependency);
+        auto lock = std::lock_guard(m_verdicts->mutex);
+        m_verdicts->by_dependency.insert_or_assign(std::string(dependency), verdict);
+        return verdict;
+    }
+
+    auto RepodataPrefilter::accepts_depends(std::span<const std::string> depends) const -> bool
+    {
+        return std::all_of(
+            depends.begin(),
+            depends.end(),
+            [&](const std::string& dep) { return accepts_dependency(dep); }
+        );
+    }
+
+    auto RepodataPrefilter::filter_repo(
+        solver::libsolv::Database& database,
+        solver::libsolv::RepoInfo repo
+    ) const -> std::size_t
+    {
+        if (!is_active())
+        {
+            return 0;
+        }
+        return database.remove_packages_by_dependency(
+            repo,
+            key(),
+            [this](std::string_view dep) { return accepts_dependency(dep); }
+        );
+    }
+}
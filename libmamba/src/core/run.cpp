@@ -5,8 +5,12 @@
 // The full license is in the file LICENSE, distributed with this software.
 
 #include <array>
+#include <cerrno>
 #include <csignal>
+#include <cstring>
 #include <iostream>
+#include <map>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -30,6 +34,7 @@ extern "C"
 #include <nlohmann/json.hpp>
 #include <reproc++/run.hpp>
 
+#include "mamba/core/activation.hpp"
 #include "mamba/core/context.hpp"
 #include "mamba/core/error_handling.hpp"
 #include "mamba/core/execution.hpp"
@@ -294,6 +299,166 @@ namespace mamba
     }
 #endif
 
+    namespace
+    {
+        std::map<std::string, std::string> parse_env_vars(const std::vector<std::string>& env_vars)
+        {
+            std::map<std::string, std::string> env_map;
+            for (auto& e : env_vars)
+            {
+                if (e.find_first_of("=") != std::string::npos)
+                {
+                    auto split_e = util::split(e, "=", 1);
+                    env_map[split_e[0]] = split_e[1];
+                }
+                else
+                {
+                    auto val = util::get_env(e);
+                    if (val)
+                    {
+                        env_map[e] = val.value();
+                    }
+                    else
+                    {
+                        LOG_WARNING << "Requested env var " << e
+                                    << " does not exist in environment";
+                    }
+                }
+            }
+            return env_map;
+        }
+
+#ifndef _WIN32
+        /** A POSIX activator computing the activation from a given environment. */
+        class EnvironmentActivator : public PosixActivator
+        {
+        public:
+
+            EnvironmentActivator(const Context& context, util::environment_map env)
+                : PosixActivator(context)
+            {
+                m_env = std::move(env);
+            }
+        };
+
+        /**
+         * Replace the current process with the command run in the activated prefix.
+         *
+         * The activation is computed in process from the cached activation plan of the prefix,
+         * instead of spawning a shell evaluating the shell hook and activation.
+         * The environment left by the wrapper script is reproduced, apart from shell variables
+         * such as ``PS1``.
+         *
+         * Returns only if the command could not be executed, or if the activation runs scripts
+         * which need a shell, in which case the environment of the process is left untouched.
+         */
+        std::optional<int> exec_in_environment(
+            const Context& context,
+            const fs::u8path& prefix,
+            std::vector<std::string> command,
+            const std::string& cwd,
+            const std::map<std::string, std::string>& env_map
+        )
+        {
+            if (command.front() == "exec")
+            {
+                command.erase(command.begin());
+            }
+            if (command.empty())
+            {
+                return std::nullopt;
+            }
+            if (!cwd.empty() && !fs::exists(cwd))
+            {
+                LOG_CRITICAL << "The given path does not exist: " << cwd;
+                return -1;
+            }
+
+            // The variables set before activation, same as the wrapper script and the shell hook
+            auto env = util::get_env_map();
+            auto overrides = env_map;
+            const auto set_var = [&](const std::string& key, const std::string& value)
+            {
+                env[key] = value;
+                overrides[key] = value;
+            };
+            for (const auto& [key, value] : env_map)
+            {
+                env[key] = value;
+            }
+            set_var("MAMBA_EXE", get_self_exe_path().string());
+            if (env.find("CONDA_SHLVL") == env.end())
+            {
+                const auto path_it = env.find("PATH");
+                const auto path = (path_it != env.end()) ? path_it->second : std::string();
+                set_var("CONDA_SHLVL", "0");
+                set_var(
+                    "PATH",
+                    util::concat(
+                        (context.prefix_params.root_prefix / "condabin").string(),
+                        ":",
+                        path
+                    )
+                );
+            }
+
+            auto activator = EnvironmentActivator(context, std::move(env));
+            const auto envt = activator.build_activate(prefix);
+            if (!envt.activate_scripts.empty() || !envt.deactivate_scripts.empty())
+            {
+                LOG_DEBUG << "Activation of " << prefix << " runs scripts, using a wrapper script";
+                return std::nullopt;
+            }
+
+            for (const auto& [key, value] : overrides)
+            {
+                util::set_env(key, value);
+            }
+            if (!envt.export_path.empty())
+            {
+                util::set_env("PATH", envt.export_path);
+            }
+            for (const auto& var : envt.unset_vars)
+            {
+                util::unset_env(var);
+            }
+            for (const auto& [key, value] : envt.export_vars)
+            {
+                util::set_env(key, value);
+            }
+
+            if (!cwd.empty())
+            {
+                std::error_code ec;
+                fs::current_path(cwd, ec);
+                if (ec)
+                {
+                    LOG_CRITICAL << "Could not change directory to " << cwd << ": " << ec.message();
+                    return -1;
+                }
+            }
+
+            LOG_DEBUG << fmt::format("Executing command: {}", fmt::join(command, " "));
+            logging::flush_logs();
+            std::cout << std::flush;
+
+            std::vector<char*> argv;
+            argv.reserve(command.size() + 1);
+            for (auto& arg : command)
+            {
+                argv.push_back(arg.data());
+            }
+            argv.push_back(nullptr);
+            // The PATH of the activated environment is used to find the executable
+            execvp(argv.front(), argv.data());
+
+            const int err = errno;
+            std::cerr << command.front() << ": " << std::strerror(err) << '\n';
+            return (err == ENOENT) ? 127 : 126;
+        }
+#endif
+    }
+
     int run_in_environment(
         const Context& context,
         const fs::u8path& prefix,
@@ -311,6 +476,24 @@ namespace mamba
             LOG_CRITICAL << "The given prefix does not exist: " << prefix;
             return 1;
         }
+
+        const auto env_map = parse_env_vars(env_vars);
+
+#ifndef _WIN32
+        // Labelled and detached processes are tracked in the proc directory and need a resident
+        // parent, as do redirected streams and clean environments.
+        const bool all_streams = stream_options == static_cast<int>(STREAM_OPTIONS::ALL_STREAMS);
+        const bool exec_directly = !detach && specific_process_name.empty() && all_streams
+                                   && !clean_env && context.command_params.is_mamba_exe;
+        if (exec_directly)
+        {
+            if (auto status = exec_in_environment(context, prefix, command, cwd, env_map))
+            {
+                return status.value();
+            }
+        }
+#endif
+
         std::vector<std::string> raw_command = command;
         // Make sure the proc directory is always existing and ready.
         std::error_code ec;
@@ -324,7 +507,7 @@ namespace mamba
         {
             LOG_DEBUG << "Currently running processes: " << get_all_running_processes_info();
         }
-        fmt::print(LOG_DEBUG, "Remaining args to run as command: {}", fmt::join(command, " "));
+        LOG_DEBUG << fmt::format("Remaining args to run as command: {}", fmt::join(command, " "));
 
         // replace the wrapping bash with new process entirely
 #ifndef _WIN32
@@ -340,7 +523,7 @@ namespace mamba
             context.command_params.is_mamba_exe
         );
 
-        fmt::print(LOG_DEBUG, "Running wrapped script: {}", fmt::join(command, " "));
+        LOG_DEBUG << fmt::format("Running wrapped script: {}", fmt::join(command, " "));
 
         bool sinkout = stream_options & static_cast<int>(STREAM_OPTIONS::SINKOUT);
         bool sinkerr = stream_options & static_cast<int>(STREAM_OPTIONS::SINKERR);
@@ -362,29 +545,8 @@ namespace mamba
             opt.env.behavior = reproc::env::empty;
         }
 
-        std::map<std::string, std::string> env_map;
         if (env_vars.size())
         {
-            for (auto& e : env_vars)
-            {
-                if (e.find_first_of("=") != std::string::npos)
-                {
-                    auto split_e = util::split(e, "=", 1);
-                    env_map[split_e[0]] = split_e[1];
-                }
-                else
-                {
-                    auto val = util::get_env(e);
-                    if (val)
-                    {
-                        env_map[e] = val.value();
-                    }
-                    else
-                    {
-                        LOG_WARNING << "Requested env var " << e << " does not exist in environment";
-                    }
-                }
-            }
             opt.env.extra = env_map;
         }
 
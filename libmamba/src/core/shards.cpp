@@ -409,19 +409,21 @@ namespace mamba
 
         /**
          * Whether a raw shard package record's ``depends`` list is compatible with the
-         * requested environment python minor.
+         * requested environment python minor and accepted by the prefilter.
          *
-         * When ``python_minor_version_for_prefilter`` is unset, returns true (no prefilter).
-         * When set, inspects ``depends`` entries for ``python`` and keeps the record only if
+         * When ``python_minor_version_for_prefilter`` is unset and the prefilter is inactive,
+         * returns true (no prefilter).
+         * Otherwise, inspects ``depends`` entries for ``python`` and keeps the record only if
          * each such constraint contains that minor (see
-         * ``matches_python_minor``).
+         * ``matches_python_minor``), and if the prefilter accepts all entries.
          */
         bool record_depends_on_python_minor_version_for_prefilter(
             const msgpack_object& raw_record_obj,
-            const std::optional<specs::Version>& python_minor_version_for_prefilter
+            const std::optional<specs::Version>& python_minor_version_for_prefilter,
+            const RepodataPrefilter& prefilter
         )
         {
-            if (!python_minor_version_for_prefilter.has_value())
+            if (!python_minor_version_for_prefilter.has_value() && !prefilter.is_active())
             {
                 // No requested python minor version is provided
                 // so the build is installable in the environment.
@@ -449,14 +451,17 @@ namespace mamba
                     continue;
                 }
                 const auto depends = msgpack_object_to_string_array(val_obj);
-                for (const auto& dep : depends)
+                if (python_minor_version_for_prefilter.has_value())
                 {
-                    if (!matches_python_minor(dep, python_minor_version_for_prefilter.value()))
+                    for (const auto& dep : depends)
                     {
-                        return false;
+                        if (!matches_python_minor(dep, python_minor_version_for_prefilter.value()))
+                        {
+                            return false;
+                        }
                     }
                 }
-                return true;
+                return prefilter.accepts_depends(depends);
             }
             return true;
         }
@@ -475,7 +480,8 @@ namespace mamba
         std::size_t download_threads,
         std::optional<std::reference_wrapper<const download::mirror_map>> mirrors,
         std::optional<specs::Version> python_minor_version_for_prefilter,
-        std::size_t shards_ttl_seconds
+        std::size_t shards_ttl_seconds,
+        RepodataPrefilter prefilter
     )
         : m_shards_index(std::move(shards_index))
         , m_url(std::move(url))
@@ -486,6 +492,7 @@ namespace mamba
         , m_shards_ttl_seconds(shards_ttl_seconds)
         , m_mirrors(std::move(mirrors))
         , m_python_minor_version_for_prefilter(std::move(python_minor_version_for_prefilter))
+        , m_prefilter(std::move(prefilter))
         , m_pkgs_cache_root(
               fs::u8path(util::user_cache_dir()) / std::string(cache_paths::conda_pkgs_relative)
           )
@@ -1028,7 +1035,8 @@ namespace mamba
                         // builds to parse and to provide to the solver for dependency resolution.
                         if (!record_depends_on_python_minor_version_for_prefilter(
                                 val,
-                                m_python_minor_version_for_prefilter
+                                m_python_minor_version_for_prefilter,
+                                m_prefilter
                             ))
                         {
                             continue;
@@ -68,6 +68,9 @@ namespace mamba
         // require it with the documentation which should guide the implementers anyway.
         constinit AnyLogHandler current_log_handler;
 
+        // Lowest level of the records to process, @see `mamba::logging::is_enabled`
+        constinit std::atomic<log_level> enabled_level{ log_level::trace };
+
         // MessageLogger
         constinit std::atomic<bool> message_logger_use_buffer;
         constinit util::synchronized_value<MessageLoggerBuffer> message_logger_buffer;
@@ -42,6 +42,7 @@
 #include "solver/helpers.hpp"
 
 #include "link.hpp"
+#include "prefix_index.hpp"
 #include "progress_bar_impl.hpp"
 #include "transaction_context.hpp"
 
@@ -51,6 +52,16 @@ namespace mamba
 
     namespace
     {
+        /** Validate the cached packages of the solution all at once, rather than on lookup. */
+        void validate_package_caches(const solver::Solution& solution, MultiPackageCache& caches)
+        {
+            // TODO(C++23): std::ranges::to
+            auto to_install_range = solution.packages_to_install();
+            caches.validate_extracted_dirs(
+                std::vector<specs::PackageInfo>(to_install_range.begin(), to_install_range.end())
+            );
+        }
+
         bool need_pkg_download(const specs::PackageInfo& pkg_info, MultiPackageCache& caches)
         {
             return caches.get_extracted_dir_path(pkg_info).empty()
@@ -807,6 +818,9 @@ namespace mamba
         LOG_INFO << "Waiting for pyc compilation to finish";
         transaction_context.wait_for_pyc_compilation();
 
+        // Index the new records so that the next command does not have to parse them
+        PrefixIndex::refresh(ctx.prefix_params.target_prefix / "conda-meta");
+
         Console::stream() << "\nTransaction finished\n";
 
         prefix.history().add_entry(m_history_entry);
@@ -850,6 +864,8 @@ namespace mamba
     {
         namespace views = std::ranges::views;
 
+        validate_package_caches(m_solution, m_multi_cache);
+
         // TODO(C++23): std::ranges::to
         auto to_fetch_range = m_solution.packages_to_install()
                               | views::filter([this](const auto& pkg)
@@ -894,6 +910,7 @@ namespace mamba
         )
         {
             FetcherList fetchers;
+            validate_package_caches(solution, multi_cache);
 
             if (ctx.validation_params.verify_artifacts)
             {
@@ -1200,6 +1217,8 @@ namespace mamba
             return;
         }
 
+        validate_package_caches(m_solution, m_multi_cache);
+
         Console::instance().print("Transaction\n");
         Console::stream() << "  Prefix: " << ctx.prefix_params.target_prefix.string() << "\n";
 
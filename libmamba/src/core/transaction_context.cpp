@@ -314,6 +314,55 @@ namespace mamba
             }
             m_pyc_process = nullptr;
         }
+        store_compiled_pyc_files();
+    }
+
+    void TransactionContext::defer_pyc_caching(
+        PycCache cache,
+        PycCache::Key key,
+        fs::u8path py_file,
+        fs::u8path pyc_file
+    )
+    {
+        m_pending_pyc_cache_entries.push_back(
+            { std::move(cache), std::move(key), std::move(py_file), std::move(pyc_file) }
+        );
+    }
+
+    bool TransactionContext::hardlinks_unsupported(const fs::u8path& pkgs_dir) const
+    {
+        return m_no_hardlink_pkgs_dirs.contains(pkgs_dir.string());
+    }
+
+    void TransactionContext::set_hardlinks_unsupported(const fs::u8path& pkgs_dir)
+    {
+        m_no_hardlink_pkgs_dirs.insert(pkgs_dir.string());
+    }
+
+    void TransactionContext::store_compiled_pyc_files()
+    {
+        if (m_pending_pyc_cache_entries.empty())
+        {
+            return;
+        }
+
+        // Files that failed to compile are simply missing and rejected by the cache.
+        const fs::u8path& target_prefix = prefix_params().target_prefix;
+        std::size_t n_stored = 0;
+        for (const auto& entry : m_pending_pyc_cache_entries)
+        {
+            if (entry.cache.store(
+                    entry.key,
+                    target_prefix / entry.py_file,
+                    target_prefix / entry.pyc_file
+                ))
+            {
+                ++n_stored;
+            }
+        }
+        LOG_DEBUG << "Added " << n_stored << " of " << m_pending_pyc_cache_entries.size()
+                  << " compiled files to the pyc cache";
+        m_pending_pyc_cache_entries.clear();
     }
 
     auto TransactionContext::transaction_params() const -> const TransactionParams&
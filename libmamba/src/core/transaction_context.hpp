@@ -7,6 +7,7 @@
 #ifndef MAMBA_CORE_TRANSACTION_CONTEXT
 #define MAMBA_CORE_TRANSACTION_CONTEXT
 
+#include <set>
 #include <string>
 
 #include <reproc++/reproc.hpp>
@@ -17,6 +18,8 @@
 #include "mamba/specs/match_spec.hpp"
 #include "mamba/specs/package_info.hpp"
 
+#include "./pyc_cache.hpp"
+
 namespace mamba
 {
     std::string compute_short_python_version(const std::string& long_version);
@@ -59,6 +62,23 @@ namespace mamba
         bool try_pyc_compilation(const std::vector<fs::u8path>& py_files);
         void wait_for_pyc_compilation();
 
+        /**
+         * Add the bytecode of ``py_file`` to ``cache`` once the pending compilation is done.
+         *
+         * Both paths are relative to the target prefix.
+         */
+        void defer_pyc_caching(
+            PycCache cache,
+            PycCache::Key key,
+            fs::u8path py_file,
+            fs::u8path pyc_file
+        );
+
+        /** Whether hard-links from the package cache ``pkgs_dir`` are known to fail. */
+        bool hardlinks_unsupported(const fs::u8path& pkgs_dir) const;
+        /** Remember that hard-links cannot be made from ``pkgs_dir`` to the target prefix. */
+        void set_hardlinks_unsupported(const fs::u8path& pkgs_dir);
+
         const TransactionParams& transaction_params() const;
         const PrefixParams& prefix_params() const;
         const LinkParams& link_params() const;
@@ -68,11 +88,22 @@ namespace mamba
 
     private:
 
+        struct PendingPycCacheEntry
+        {
+            PycCache cache;
+            PycCache::Key key;
+            fs::u8path py_file;
+            fs::u8path pyc_file;
+        };
+
         bool start_pyc_compilation_process();
+        void store_compiled_pyc_files();
 
         TransactionParams m_transaction_params;
         PythonParams m_python_params;
         std::vector<specs::MatchSpec> m_requested_specs;
+        std::vector<PendingPycCacheEntry> m_pending_pyc_cache_entries;
+        std::set<std::string> m_no_hardlink_pkgs_dirs;
 
         std::unique_ptr<reproc::process> m_pyc_process = nullptr;
         std::unique_ptr<TemporaryFile> m_pyc_script_file = nullptr;
@@ -1667,7 +1667,11 @@ namespace mamba
             copy = std::regex_replace(copy, token_regex(), "/t/*****");
         }
 
-        copy = std::regex_replace(copy, http_basicauth_regex(), "$1$2:*****@");
+        // Credentials need a ':' followed by a '@', most strings (e.g. logs) have none
+        if (const auto at = str.rfind('@'); (at != std::string_view::npos) && (str.find(':') < at))
+        {
+            copy = std::regex_replace(copy, http_basicauth_regex(), "$1$2:*****@");
+        }
 
         return copy;
     }
@@ -4,7 +4,12 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <optional>
 #include <regex>
+#include <string_view>
 #include <vector>
 
 #ifdef _WIN32
@@ -13,16 +18,20 @@
 #include <unistd.h>
 #endif
 
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
 #include <reproc++/run.hpp>
 
 #include "mamba/core/output.hpp"
 #include "mamba/core/util.hpp"
 #include "mamba/core/virtual_packages.hpp"
 #include "mamba/util/build.hpp"
+#include "mamba/util/cryptography.hpp"
 #include "mamba/util/environment.hpp"
 #include "mamba/util/os_linux.hpp"
 #include "mamba/util/os_osx.hpp"
 #include "mamba/util/os_win.hpp"
+#include "mamba/util/random.hpp"
 #include "mamba/util/string.hpp"
 
 namespace mamba
@@ -57,18 +66,138 @@ namespace mamba
             return std::string(util::strip(version, "glibc "));
         }
 
-        std::string cuda_version()
+        /** Nothing when the user has no cache directory, e.g. without ``HOME`` nor passwd entry. */
+        auto virtual_packages_cache_dir() -> std::optional<fs::u8path>
         {
-            LOG_DEBUG << "Loading CUDA virtual package";
+            try
+            {
+                return fs::u8path(util::user_cache_dir()) / "mamba" / "virtual_packages";
+            }
+            catch (const std::exception& e)
+            {
+                LOG_DEBUG << "Virtual package probes are not cached: " << e.what();
+                return std::nullopt;
+            }
+        }
 
-            auto override_version = util::get_env("CONDA_OVERRIDE_CUDA");
-            if (override_version)
+        auto read_cached_probe(const fs::u8path& file, std::string_view fingerprint)
+            -> std::optional<std::string>
+        {
+            auto f = std::ifstream(file.std_path());
+            if (!f)
             {
-                LOG_DEBUG << "CUDA version set by `CONDA_OVERRIDE_CUDA`: "
-                          << override_version.value();
-                return override_version.value();
+                return std::nullopt;
+            }
+            const auto j = nlohmann::json::parse(f, nullptr, /* allow_exceptions= */ false);
+            if (!j.is_object())
+            {
+                return std::nullopt;
+            }
+            const auto fp = j.find("fingerprint");
+            const auto value = j.find("value");
+            if ((fp == j.end()) || (value == j.end()) || !fp->is_string() || !value->is_string()
+                || (fp->get<std::string>() != fingerprint))
+            {
+                return std::nullopt;
+            }
+            return value->get<std::string>();
+        }
+
+        void write_cached_probe(
+            const fs::u8path& file,
+            std::string_view fingerprint,
+            std::string_view value
+        )
+        {
+            std::error_code ec;
+            fs::create_directories(file.parent_path(), ec);
+            const auto tmp_file = fs::u8path(util::concat(
+                file.string(),
+                ".",
+                util::generate_random_alphanumeric_string(8),
+                ".tmp"
+            ));
+            {
+                auto f = std::ofstream(tmp_file.std_path());
+                if (!f)
+                {
+                    return;
+                }
+                f << nlohmann::json{ { "fingerprint", fingerprint }, { "value", value } }.dump();
+                if (!f)
+                {
+                    f.close();
+                    fs::remove(tmp_file, ec);
+                    return;
+                }
+            }
+            fs::rename(tmp_file, file, ec);
+            if (ec)
+            {
+                fs::remove(tmp_file, ec);
+            }
+        }
+
+        namespace
+        {
+            void add_file_stamp(std::string& data, const fs::u8path& path)
+            {
+                std::error_code ec;
+                const auto size = fs::file_size(path, ec);
+                if (ec)
+                {
+                    return;
+                }
+                const auto mtime = fs::last_write_time(path, ec).time_since_epoch().count();
+                data += fmt::format("{}|{}|{}\n", path.string(), size, mtime);
             }
 
+            // The driver version is also found in a small, fast to read, procfs file.
+            void add_file_content(std::string& data, const fs::u8path& path)
+            {
+                auto f = std::ifstream(path.std_path());
+                auto line = std::string();
+                if (f && std::getline(f, line))
+                {
+                    data += util::concat(path.string(), "|", line, "\n");
+                }
+            }
+        }
+
+        auto cuda_probe_fingerprint() -> std::string
+        {
+            // Format version of the cache entry
+            auto data = std::string("1\n");
+            // nvidia-smi is found through the PATH
+            data += util::get_env("PATH").value_or("");
+            data += '\n';
+            if (util::on_linux)
+            {
+                data += util::linux_version().value_or("");
+                data += '\n';
+                add_file_content(data, "/proc/driver/nvidia/version");
+                for (const auto* lib_dir :
+                     { "/usr/lib/x86_64-linux-gnu",
+                       "/usr/lib/aarch64-linux-gnu",
+                       "/usr/lib/powerpc64le-linux-gnu",
+                       "/usr/lib64",
+                       "/usr/lib",
+                       "/usr/lib/wsl/lib" })
+                {
+                    add_file_stamp(data, fs::u8path(lib_dir) / "libcuda.so.1");
+                }
+            }
+            if (util::on_win)
+            {
+                const auto system_root = util::get_env("SystemRoot").value_or("C:\\Windows");
+                add_file_stamp(data, fs::u8path(system_root) / "System32" / "nvcuda.dll");
+            }
+            add_file_stamp(data, "/usr/local/cuda/version.json");
+            return util::Sha256Hasher().str_hex_str(data);
+        }
+
+        std::string probe_cuda_version()
+        {
             std::string cuda_version;
             std::string cuda_version_file = "/usr/local/cuda/version.json";
 
@@ -192,6 +321,57 @@ namespace mamba
             return "";
         }
 
+        namespace
+        {
+            auto detect_cuda_version() -> std::string
+            {
+                const auto cache_dir = virtual_packages_cache_dir();
+                if (!cache_dir.has_value())
+                {
+                    return probe_cuda_version();
+                }
+                const auto file = cache_dir.value() / "cuda.json";
+                const auto fingerprint = cuda_probe_fingerprint();
+                if (auto cached = read_cached_probe(file, fingerprint))
+                {
+                    LOG_DEBUG << "CUDA version read from cache " << file << ": " << cached.value();
+                    return std::move(cached).value();
+                }
+                auto version = probe_cuda_version();
+                write_cached_probe(file, fingerprint, version);
+                return version;
+            }
+
+            /** The CUDA detection of the process, started at most once. */
+            auto detected_cuda_version(std::launch policy) -> std::shared_future<std::string>
+            {
+                static auto mutex = std::mutex();
+                static auto detection = std::optional<std::shared_future<std::string>>();
+
+                auto lock = std::lock_guard(mutex);
+                if (!detection.has_value())
+                {
+                    detection = std::async(policy, detect_cuda_version).share();
+                }
+                return detection.value();
+            }
+        }
+
+        std::string cuda_version()
+        {
+            LOG_DEBUG << "Loading CUDA virtual package";
+
+            auto override_version = util::get_env("CONDA_OVERRIDE_CUDA");
+            if (override_version)
+            {
+                LOG_DEBUG << "CUDA version set by `CONDA_OVERRIDE_CUDA`: "
+                          << override_version.value();
+                return override_version.value();
+            }
+
+            return detected_cuda_version(std::launch::deferred).get();
+        }
+
         auto make_virtual_package(  //
             std::string name,
             std::string subdir,
@@ -342,7 +522,30 @@ namespace mamba
             {
                 return { std::move(override_version).value() };
             }
-            return util::osx_version();
+            if (!util::on_mac)
+            {
+                return util::osx_version();
+            }
+
+            // Avoid running ``sw_vers`` when the system did not change
+            auto fingerprint = std::string("1\n");
+            add_file_stamp(fingerprint, "/System/Library/CoreServices/SystemVersion.plist");
+            const auto cache_dir = virtual_packages_cache_dir();
+            if (!cache_dir.has_value())
+            {
+                return util::osx_version();
+            }
+            const auto file = cache_dir.value() / "osx.json";
+            if (auto cached = read_cached_probe(file, fingerprint))
+            {
+                return { std::move(cached).value() };
+            }
+            auto version = util::osx_version();
+            if (version)
+            {
+                write_cached_probe(file, fingerprint, version.value());
+            }
+            return version;
         }
 
         [[nodiscard]] auto overridable_windows_version() -> tl::expected<std::string, util::OSError>
@@ -458,6 +661,14 @@ namespace mamba
         }
     }
 
+    void start_virtual_packages_detection()
+    {
+        if (!util::get_env("CONDA_OVERRIDE_CUDA").has_value())
+        {
+            detail::detected_cuda_version(std::launch::async);
+        }
+    }
+
     std::vector<specs::PackageInfo> get_virtual_packages(const std::string& platform)
     {
         LOG_DEBUG << "Loading virtual packages";
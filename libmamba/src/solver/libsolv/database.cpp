@@ -4,19 +4,28 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <algorithm>
+#include <cstdio>
 #include <exception>
 #include <iostream>
 #include <string_view>
+#include <unordered_map>
+#include <vector>
 
 #include <fmt/format.h>
+#include <nlohmann/json.hpp>
 #include <solv/evr.h>
+#include <solv/repo.h>
 #include <solv/selection.h>
+#include <solv/solvable.h>
 #include <solv/solver.h>
 
 #include "mamba/fs/filesystem.hpp"
 #include "mamba/solver/libsolv/database.hpp"
 #include "mamba/solver/libsolv/repo_info.hpp"
 #include "mamba/specs/match_spec.hpp"
+#include "mamba/util/cfile.hpp"
+#include "mamba/util/cryptography.hpp"
 #include "mamba/util/random.hpp"
 #include "mamba/util/string.hpp"
 #include "solv-cpp/pool.hpp"
@@ -39,6 +48,25 @@ namespace mamba::solver::libsolv
         solv::ObjPool pool = {};
         Matcher matcher;
         solv::ObjQueue virtual_package_lock_jobs = {};
+
+        /** Where the repositories loaded from repodata files come from, for the fingerprint. */
+        std::unordered_map<solv::RepoId, std::string> repo_origins = {};
+
+        /**
+         * Reverse dependency index from the name of a requirement to the solvables requiring it.
+         *
+         * Built lazily on the first reverse dependency query and dropped whenever the
+         * solvables change.
+         */
+        std::unordered_map<solv::StringId, std::vector<solv::SolvableId>> requiring_solvables = {};
+        std::size_t requiring_solvables_pool_size = 0;
+        bool requiring_solvables_valid = false;
+
+        void invalidate_reverse_dependencies()
+        {
+            requiring_solvables.clear();
+            requiring_solvables_valid = false;
+        }
     };
 
     Database::Database(specs::ChannelResolveParams channel_params)
@@ -69,6 +97,84 @@ namespace mamba::solver::libsolv
 
     auto Database::operator=(Database&&) -> Database& = default;
 
+    auto Database::clone() const -> Database
+    {
+        auto out = Database(channel_params(), settings());
+        const auto installed = pool().installed_repo();
+        auto solvable_ids = std::unordered_map<solv::SolvableId, solv::SolvableId>();
+
+        pool().for_each_repo(
+            [&](solv::ObjRepoViewConst repo)
+            {
+                auto [new_id, new_repo] = out.pool().add_repo(repo.name());
+
+                // Copy the solvables and all their attributes through the libsolv binary format
+                const auto file = std::unique_ptr<std::FILE, decltype(&std::fclose)>(
+                    std::tmpfile(),
+                    &std::fclose
+                );
+                if (file == nullptr)
+                {
+                    throw mamba_error(
+                        "Could not create a temporary file to clone the database",
+                        mamba_error_code::internal_failure
+                    );
+                }
+                auto copied = repo.write(file.get()).and_then(
+                    [&]()
+                    {
+                        std::rewind(file.get());
+                        return new_repo.read(file.get());
+                    }
+                );
+                if (!copied.has_value())
+                {
+                    throw mamba_error(
+                        fmt::format(
+                            R"(Could not clone repo "{}": {})",
+                            repo.name(),
+                            copied.error()
+                        ),
+                        mamba_error_code::internal_failure
+                    );
+                }
+                new_repo.internalize();
+                new_repo.raw()->priority = repo.raw()->priority;
+                new_repo.raw()->subpriority = repo.raw()->subpriority;
+
+                if (installed.has_value() && (installed->id() == repo.id()))
+                {
+                    out.pool().set_installed_repo(new_id);
+                }
+                if (const auto it = m_data->repo_origins.find(repo.id());
+                    it != m_data->repo_origins.cend())
+                {
+                    out.m_data->repo_origins.emplace(new_id, it->second);
+                }
+
+                // Solvables are written in order, but their ids may differ in the new pool
+                auto old_ids = std::vector<solv::SolvableId>();
+                old_ids.reserve(repo.solvable_count());
+                repo.for_each_solvable_id([&](solv::SolvableId id) { old_ids.push_back(id); });
+                auto old_id_it = old_ids.cbegin();
+                new_repo.for_each_solvable_id(
+                    [&](solv::SolvableId id)
+                    {
+                        assert(old_id_it != old_ids.cend());
+                        solvable_ids.emplace(*old_id_it++, id);
+                    }
+                );
+            }
+        );
+
+        const auto& jobs = m_data->virtual_package_lock_jobs;
+        for (std::size_t i = 0; i + 1 < jobs.size(); i += 2)
+        {
+            out.m_data->virtual_package_lock_jobs.push_back(jobs[i], solvable_ids.at(jobs[i + 1]));
+        }
+        return out;
+    }
+
     auto Database::pool() -> solv::ObjPool&
     {
         return m_data->pool;
@@ -168,6 +274,7 @@ namespace mamba::solver::libsolv
                 mamba_error_code::repodata_not_loaded
             );
         }
+        m_data->invalidate_reverse_dependencies();
         auto repo = pool().add_repo(url).second;
         repo.set_url(std::string(url));
 
@@ -216,6 +323,23 @@ namespace mamba::solver::libsolv
                         add_pip_as_python_dependency(pool(), p_repo);
                     }
                     p_repo.internalize();
+                    std::error_code ec;
+                    const auto size = fs::file_size(path, ec);
+                    const auto mtime = fs::last_write_time(path, ec).time_since_epoch().count();
+                    m_data->repo_origins.insert_or_assign(
+                        p_repo.id(),
+                        fmt::format(
+                            "json|{}|{}|{}|{}|{}|{}|{}|{}",
+                            path.string(),
+                            size,
+                            mtime,
+                            channel_id,
+                            static_cast<int>(add),
+                            static_cast<int>(package_types),
+                            static_cast<int>(verify_artifacts),
+                            static_cast<int>(repo_parser)
+                        )
+                    );
                     return RepoInfo{ p_repo.raw() };
                 }
             )
@@ -229,6 +353,7 @@ namespace mamba::solver::libsolv
         PipAsPythonDependency add
     ) -> expected_t<RepoInfo>
     {
+        m_data->invalidate_reverse_dependencies();
         auto repo = pool().add_repo(expected.url).second;
 
         return read_solv(pool(), repo, path, expected, static_cast<bool>(add))
@@ -242,6 +367,17 @@ namespace mamba::solver::libsolv
                         add_pip_as_python_dependency(pool(), p_repo);
                     }
                     p_repo.internalize();
+                    m_data->repo_origins.insert_or_assign(
+                        p_repo.id(),
+                        fmt::format(
+                            "solv|{}|{}|{}|{}|{}",
+                            expected.url,
+                            expected.etag,
+                            expected.mod,
+                            channel_id,
+                            static_cast<int>(add)
+                        )
+                    );
                     return RepoInfo(p_repo.raw());
                 }
             )
@@ -276,6 +412,7 @@ namespace mamba::solver::libsolv
 
     void Database::add_repo_from_packages_impl_post(const RepoInfo& repo, PipAsPythonDependency add)
     {
+        m_data->invalidate_reverse_dependencies();
         auto s_repo = solv::ObjRepoView(*repo.m_ptr);
         if (add == PipAsPythonDependency::Yes)
         {
@@ -297,9 +434,62 @@ namespace mamba::solver::libsolv
 
     void Database::remove_repo(RepoInfo repo)
     {
+        m_data->invalidate_reverse_dependencies();
+        m_data->repo_origins.erase(repo.id());
         pool().remove_repo(repo.id(), /* reuse_ids= */ true);
     }
 
+    auto Database::remove_packages_by_dependency(
+        RepoInfo repo,
+        std::string_view filter_key,
+        const std::function<bool(std::string_view)>& keep
+    ) -> std::size_t
+    {
+        auto s_repo = solv::ObjRepoView(*repo.m_ptr);
+        auto verdicts = std::unordered_map<solv::DependencyId, bool>();
+        auto removed = std::vector<solv::SolvableId>();
+        s_repo.for_each_solvable(
+            [&](solv::ObjSolvableView s)
+            {
+                for (const solv::DependencyId dep : s.dependencies())
+                {
+                    auto [it, inserted] = verdicts.try_emplace(dep, true);
+                    if (inserted)
+                    {
+                        // Dependencies parsed by mamba are stored in namespaces, they must be
+                        // decoded rather than printed. Keep the ones that cannot be decoded.
+                        it->second = pool_get_matchspec(pool().view(), dep)
+                                         .transform([&](const specs::MatchSpec& ms)
+                                                    { return keep(ms.conda_build_form()); })
+                                         .value_or(true);
+                    }
+                    if (!it->second)
+                    {
+                        removed.push_back(s.id());
+                        break;
+                    }
+                }
+            }
+        );
+        if (removed.empty())
+        {
+            return 0;
+        }
+
+        m_data->invalidate_reverse_dependencies();
+        // In reverse order so that the pool shrinks when removing its last solvables
+        for (auto it = removed.crbegin(); it != removed.crend(); ++it)
+        {
+            s_repo.remove_solvable(*it, /* reuse_id= */ true);
+        }
+        s_repo.internalize();
+        if (const auto it = m_data->repo_origins.find(repo.id()); it != m_data->repo_origins.end())
+        {
+            it->second += fmt::format("|{}|{}", filter_key, removed.size());
+        }
+        return removed.size();
+    }
+
     auto Database::repo_count() const -> std::size_t
     {
         return pool().repo_count();
@@ -310,6 +500,291 @@ namespace mamba::solver::libsolv
         return pool().solvable_count();
     }
 
+    auto Database::fingerprint() const -> std::string
+    {
+        const auto installed = pool().installed_repo();
+        auto data = fmt::format(
+            "{}|{}\n",
+            static_cast<int>(settings().matchspec_parser),
+            settings().exclude_newer_timestamp.value_or(0)
+        );
+        pool().for_each_repo(
+            [&](solv::ObjRepoViewConst repo)
+            {
+                data += fmt::format(
+                    "{}|{}|{}|{}|{}|",
+                    repo.name(),
+                    repo.url(),
+                    repo.raw()->priority,
+                    repo.raw()->subpriority,
+                    installed.has_value() && (installed->id() == repo.id())
+                );
+                if (const auto it = m_data->repo_origins.find(repo.id());
+                    it != m_data->repo_origins.cend())
+                {
+                    data += it->second;
+                }
+                else
+                {
+                    // Repositories built from packages (installed, virtual...) are usually small
+                    repo.for_each_solvable(
+                        [&](solv::ObjSolvableViewConst s)
+                        { data += nlohmann::json(make_package_info(pool(), s)).dump(); }
+                    );
+                }
+                data += '\n';
+            }
+        );
+        return util::Sha256Hasher().str_hex_str(data);
+    }
+
+    namespace
+    {
+        constexpr auto snapshot_magic = std::string_view("mamba-database-snapshot\n");
+        constexpr int snapshot_version = 1;
+        /** Zero padded offset of the metadata, so that the trailer has a fixed size. */
+        constexpr std::size_t snapshot_trailer_size = 21;
+
+        auto snapshot_error(const fs::u8path& path, std::string_view msg) -> mamba_error
+        {
+            return mamba_error(
+                fmt::format(R"(Invalid database snapshot "{}": {})", path.string(), msg),
+                mamba_error_code::repodata_not_loaded
+            );
+        }
+    }
+
+    auto Database::write_snapshot(const fs::u8path& path, std::string_view key) const
+        -> expected_t<void>
+    {
+        const auto installed = pool().installed_repo();
+        auto solvable_positions = std::unordered_map<solv::SolvableId, std::pair<int, int>>();
+        auto repos = nlohmann::json::array();
+
+        const auto tmp_path = fs::u8path(
+            util::concat(path.string(), ".", util::generate_random_alphanumeric_string(8), ".tmp")
+        );
+        auto write = [&](util::CFile&& file) -> expected_t<void>
+        {
+            if (std::fwrite(snapshot_magic.data(), 1, snapshot_magic.size(), file.raw())
+                != snapshot_magic.size())
+            {
+                return make_unexpected(
+                    "Could not write snapshot",
+                    mamba_error_code::internal_failure
+                );
+            }
+
+            auto result = expected_t<void>();
+            pool().for_each_repo(
+                [&](solv::ObjRepoViewConst repo)
+                {
+                    const auto repo_index = static_cast<int>(repos.size());
+                    int solvable_index = 0;
+                    repo.for_each_solvable_id(
+                        [&](solv::SolvableId id)
+                        { solvable_positions.emplace(id, std::pair(repo_index, solvable_index++)); }
+                    );
+
+                    const auto offset = std::ftell(file.raw());
+                    if (auto written = repo.write(file.raw()); !written)
+                    {
+                        result = make_unexpected(
+                            std::move(written).error(),
+                            mamba_error_code::internal_failure
+                        );
+                        return util::LoopControl::Break;
+                    }
+                    const auto origin = m_data->repo_origins.find(repo.id());
+                    repos.push_back({
+                        { "name", repo.name() },
+                        { "url", repo.url() },
+                        { "offset", offset },
+                        { "priority", repo.raw()->priority },
+                        { "subpriority", repo.raw()->subpriority },
+                        { "installed", installed.has_value() && (installed->id() == repo.id()) },
+                        { "origin",
+                          origin != m_data->repo_origins.cend() ? nlohmann::json(origin->second)
+                                                                : nlohmann::json() },
+                    });
+                    return util::LoopControl::Continue;
+                }
+            );
+            if (!result)
+            {
+                return result;
+            }
+
+            auto lock_jobs = nlohmann::json::array();
+            const auto& jobs = m_data->virtual_package_lock_jobs;
+            for (std::size_t i = 0; i + 1 < jobs.size(); i += 2)
+            {
+                const auto [repo_index, solvable_index] = solvable_positions.at(jobs[i + 1]);
+                lock_jobs.push_back({ jobs[i], repo_index, solvable_index });
+            }
+
+            const auto metadata_offset = std::ftell(file.raw());
+            const auto metadata = nlohmann::json{
+                { "version", snapshot_version },
+                { "key", key },
+                { "repos", std::move(repos) },
+                { "virtual_package_lock_jobs", std::move(lock_jobs) },
+            }.dump();
+            const auto trailer = fmt::format("{:020d}\n", metadata_offset);
+            static_assert(snapshot_trailer_size == 21);
+            if ((std::fwrite(metadata.data(), 1, metadata.size(), file.raw()) != metadata.size())
+                || (std::fwrite(trailer.data(), 1, trailer.size(), file.raw()) != trailer.size()))
+            {
+                return make_unexpected(
+                    "Could not write snapshot",
+                    mamba_error_code::internal_failure
+                );
+            }
+            return file.try_close().transform_error(
+                [](std::error_code&& ec)
+                { return mamba_error(ec.message(), mamba_error_code::internal_failure); }
+            );
+        };
+
+        std::error_code ec;
+        fs::create_directories(path.parent_path(), ec);
+        auto out = util::CFile::try_open(tmp_path, "wb")
+                       .transform_error(
+                           [](std::error_code&& err)
+                           {
+                               return mamba_error(
+                                   err.message(),
+                                   mamba_error_code::internal_failure
+                               );
+                           }
+                       )
+                       .and_then(write);
+        if (out)
+        {
+            // Readers never see a partially written snapshot
+            fs::rename(tmp_path, path, ec);
+            if (!ec)
+            {
+                return out;
+            }
+            out = make_unexpected(ec.message(), mamba_error_code::internal_failure);
+        }
+        fs::remove(tmp_path, ec);
+        return out;
+    }
+
+    auto Database::add_repos_from_snapshot(const fs::u8path& path, std::string_view key)
+        -> expected_t<std::vector<RepoInfo>>
+    {
+        auto file = util::CFile::try_open(path, "rb");
+        if (!file)
+        {
+            return tl::make_unexpected(snapshot_error(path, file.error().message()));
+        }
+        auto* const fp = file->raw();
+
+        // Check the header and read the metadata from the trailer
+        auto magic = std::string(snapshot_magic.size(), '\0');
+        auto trailer = std::string(snapshot_trailer_size, '\0');
+        if ((std::fread(magic.data(), 1, magic.size(), fp) != magic.size())
+            || (magic != snapshot_magic)
+            || (std::fseek(fp, -static_cast<long>(snapshot_trailer_size), SEEK_END) != 0))
+        {
+            return tl::make_unexpected(snapshot_error(path, "not a snapshot"));
+        }
+        const auto trailer_offset = std::ftell(fp);
+        long metadata_offset = 0;
+        if ((std::fread(trailer.data(), 1, trailer.size(), fp) != trailer.size())
+            || (std::sscanf(trailer.c_str(), "%20ld", &metadata_offset) != 1)
+            || (metadata_offset <= 0) || (metadata_offset > trailer_offset)
+            || (std::fseek(fp, metadata_offset, SEEK_SET) != 0))
+        {
+            return tl::make_unexpected(snapshot_error(path, "invalid trailer"));
+        }
+        const auto metadata_size = static_cast<std::size_t>(trailer_offset - metadata_offset);
+        auto metadata_str = std::string(metadata_size, '\0');
+        if (std::fread(metadata_str.data(), 1, metadata_str.size(), fp) != metadata_str.size())
+        {
+            return tl::make_unexpected(snapshot_error(path, "truncated metadata"));
+        }
+        const auto metadata = nlohmann::json::parse(metadata_str, nullptr, false);
+        if (metadata.is_discarded() || (metadata.value("version", 0) != snapshot_version))
+        {
+            return tl::make_unexpected(snapshot_error(path, "unsupported metadata"));
+        }
+        if (metadata.value("key", "") != key)
+        {
+            return tl::make_unexpected(snapshot_error(path, "outdated"));
+        }
+
+        m_data->invalidate_reverse_dependencies();
+        auto added = std::vector<RepoInfo>();
+        auto solvable_ids = std::vector<std::vector<solv::SolvableId>>();
+        auto lock_jobs = std::vector<std::pair<int, solv::SolvableId>>();
+        auto remove_added = [&]()
+        {
+            for (auto& repo : added)
+            {
+                remove_repo(repo);
+            }
+        };
+
+        try
+        {
+            for (const auto& jrepo : metadata.at("repos"))
+            {
+                auto [id, repo] = pool().add_repo(jrepo.at("name").get<std::string>());
+                added.push_back(RepoInfo(repo.raw()));
+                if (std::fseek(fp, jrepo.at("offset").get<long>(), SEEK_SET) != 0)
+                {
+                    throw std::runtime_error("invalid repository offset");
+                }
+                if (auto read = repo.read(fp); !read)
+                {
+                    throw std::runtime_error(read.error());
+                }
+                if (const auto url = jrepo.at("url").get<std::string>(); !url.empty())
+                {
+                    repo.set_url(url);
+                }
+                repo.internalize();
+                repo.raw()->priority = jrepo.at("priority").get<int>();
+                repo.raw()->subpriority = jrepo.at("subpriority").get<int>();
+                if (jrepo.at("installed").get<bool>())
+                {
+                    pool().set_installed_repo(id);
+                }
+                if (const auto& origin = jrepo.at("origin"); origin.is_string())
+                {
+                    m_data->repo_origins.insert_or_assign(id, origin.get<std::string>());
+                }
+                auto& ids = solvable_ids.emplace_back();
+                repo.for_each_solvable_id([&](solv::SolvableId sid) { ids.push_back(sid); });
+            }
+
+            for (const auto& job : metadata.at("virtual_package_lock_jobs"))
+            {
+                const auto repo_index = job.at(1).get<std::size_t>();
+                const auto solvable_index = job.at(2).get<std::size_t>();
+                lock_jobs.emplace_back(
+                    job.at(0).get<int>(),
+                    solvable_ids.at(repo_index).at(solvable_index)
+                );
+            }
+        }
+        catch (const std::exception& e)
+        {
+            remove_added();
+            return tl::make_unexpected(snapshot_error(path, e.what()));
+        }
+
+        for (const auto& [how, id] : lock_jobs)
+        {
+            m_data->virtual_package_lock_jobs.push_back(how, id);
+        }
+        return added;
+    }
+
     auto Database::installed_repo() const -> std::optional<RepoInfo>
     {
         if (auto repo = pool().installed_repo())
@@ -334,6 +809,7 @@ namespace mamba::solver::libsolv
                 mamba_error_code::internal_failure
             );
         }
+        m_data->invalidate_reverse_dependencies();
         auto s_repo = solv::ObjRepoView(*repo.m_ptr);
         auto [id, solv] = s_repo.add_solvable();
         set_solvable(pool(), solv, pkg, settings().matchspec_parser);
@@ -346,6 +822,7 @@ namespace mamba::solver::libsolv
 
     void Database::internalize_repo(const RepoInfo& repo)
     {
+        m_data->invalidate_reverse_dependencies();
         solv::ObjRepoView(*repo.m_ptr).internalize();
     }
 
@@ -416,20 +893,108 @@ namespace mamba::solver::libsolv
         return out;
     }
 
+    namespace
+    {
+        /**
+         * Add the names that ``dep`` can match on to ``out``.
+         *
+         * ``pool_match_dep`` only matches two dependencies if the names at the root of their
+         * relations are identical, looking into both sides of boolean relations.
+         */
+        void collect_dependency_names(
+            const ::Pool* pool,
+            solv::DependencyId dep,
+            std::vector<solv::StringId>& out
+        )
+        {
+            while (ISRELDEP(dep))
+            {
+                const auto* rd = GETRELDEP(pool, dep);
+                switch (rd->flags)
+                {
+                    case REL_AND:
+                    case REL_OR:
+                    case REL_WITH:
+                    case REL_WITHOUT:
+                    case REL_COND:
+                    case REL_UNLESS:
+                    case REL_ELSE:
+                        collect_dependency_names(pool, rd->evr, out);
+                        break;
+                    default:
+                        break;
+                }
+                dep = rd->name;
+            }
+            out.push_back(dep);
+        }
+    }
+
     auto Database::packages_depending_on_ids(const specs::MatchSpec& ms) -> std::vector<PackageId>
     {
         static_assert(std::is_same_v<std::underlying_type_t<PackageId>, solv::SolvableId>);
 
         pool().ensure_whatprovides();
         const auto ms_id = pool_add_matchspec_throwing(pool(), ms, settings().matchspec_parser);
-        auto solvables = pool().what_matches_dep(SOLVABLE_REQUIRES, ms_id);
-        auto out = std::vector<PackageId>(solvables.size());
-        std::transform(
-            solvables.begin(),
-            solvables.end(),
-            out.begin(),
-            [](auto id) { return static_cast<PackageId>(id); }
-        );
+        auto* const raw_pool = pool().raw();
+
+        auto& index = m_data->requiring_solvables;
+        if (!m_data->requiring_solvables_valid
+            || (m_data->requiring_solvables_pool_size != pool().solvable_count()))
+        {
+            index.clear();
+            auto names = std::vector<solv::StringId>();
+            pool().for_each_solvable(
+                [&](solv::ObjSolvableViewConst s)
+                {
+                    names.clear();
+                    for (const auto dep : s.dependencies())
+                    {
+                        collect_dependency_names(raw_pool, dep, names);
+                    }
+                    std::sort(names.begin(), names.end());
+                    names.erase(std::unique(names.begin(), names.end()), names.end());
+                    for (const auto name : names)
+                    {
+                        index[name].push_back(s.id());
+                    }
+                }
+            );
+            m_data->requiring_solvables_pool_size = pool().solvable_count();
+            m_data->requiring_solvables_valid = true;
+        }
+
+        auto candidates = std::vector<solv::SolvableId>();
+        auto names = std::vector<solv::StringId>();
+        collect_dependency_names(raw_pool, ms_id, names);
+        for (const auto name : names)
+        {
+            if (const auto it = index.find(name); it != index.cend())
+            {
+                candidates.insert(candidates.end(), it->second.cbegin(), it->second.cend());
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+        // Same filtering as ``pool_whatmatchesdep`` on the few candidates only
+        auto out = std::vector<PackageId>();
+        for (const auto id : candidates)
+        {
+            auto* const s = raw_pool->solvables + id;
+            if ((s->repo == nullptr) || s->repo->disabled)
+            {
+                continue;
+            }
+            if ((s->repo != raw_pool->installed) && !::pool_installable(raw_pool, s))
+            {
+                continue;
+            }
+            if (::solvable_matchesdep(s, SOLVABLE_REQUIRES, ms_id, -1) != 0)
+            {
+                out.push_back(static_cast<PackageId>(id));
+            }
+        }
         return out;
     }
 }
@@ -365,8 +365,7 @@ namespace mamba::solver::libsolv
                         }
                         else
                         {
-                            fmt::print(
-                                LOG_WARNING,
+                            LOG_WARNING << fmt::format(
                                 R"(Found invalid MatchSpec "{}" in "{}")",
                                 ms,
                                 filename
@@ -394,8 +393,7 @@ namespace mamba::solver::libsolv
                         }
                         else
                         {
-                            fmt::print(
-                                LOG_WARNING,
+                            LOG_WARNING << fmt::format(
                                 R"(Found invalid MatchSpec "{}" in "{}")",
                                 ms,
                                 filename
@@ -60,6 +60,14 @@ namespace mamba::solver::libsolv
     {
         m_packages_buffer.clear();  // Reuse the buffer
 
+        // The compiled version spec rejects most packages with a binary search on the version
+        // key, before gathering all the package attributes.
+        auto version_spec = std::shared_ptr<const specs::CompiledVersionSpec>();
+        if (!ms.version().is_explicitly_free())
+        {
+            version_spec = specs::CompiledVersionSpec::compile_cached(ms.version());
+        }
+
         auto add_pkg_if_matching = [&](solv::ObjSolvableViewConst s)
         {
             if (flags.skip_installed && s.installed())
@@ -67,6 +75,11 @@ namespace mamba::solver::libsolv
                 return;
             }
 
+            if (version_spec && !pkg_may_match_version(s, *version_spec))
+            {
+                return;
+            }
+
             if (pkg_match_except_channel(pool, s, ms) && pkg_match_channels(s, ms))
             {
                 m_packages_buffer.push_back(s.id());
@@ -110,31 +123,42 @@ namespace mamba::solver::libsolv
             .value();
     }
 
-    namespace
+    auto Matcher::get_cached_version(std::string_view version)
+        -> specs::expected_parse_t<std::reference_wrapper<const CachedVersion>>
     {
-        template <typename Map>
-        [[nodiscard]] auto make_cached_version(Map& cache, std::string version)
-            -> specs::expected_parse_t<std::reference_wrapper<const specs::Version>>
+        auto str = std::string(version);
+        if (auto it = m_version_cache.find(str); it != m_version_cache.cend())
         {
-            if (auto it = cache.find(version); it != cache.cend())
-            {
-                return { std::cref(it->second) };
-            }
-            if (version.empty())
-            {
-                auto [it, inserted] = cache.emplace(std::move(version), specs::Version());
-                assert(inserted);
-                return { std::cref(it->second) };
-            }
-            return specs::Version::parse(version).transform(
-                [&](specs::Version&& ver) -> std::reference_wrapper<const specs::Version>
-                {
-                    auto [it, inserted] = cache.emplace(std::move(version), std::move(ver));
-                    assert(inserted);
-                    return { std::cref(it->second) };
-                }
+            return { std::cref(it->second) };
+        }
+
+        auto add = [&](specs::Version&& ver) -> std::reference_wrapper<const CachedVersion>
+        {
+            auto key = specs::version_key(ver);
+            auto [it, inserted] = m_version_cache.emplace(
+                std::move(str),
+                CachedVersion{ std::move(ver), std::move(key) }
             );
+            assert(inserted);
+            return { std::cref(it->second) };
+        };
+
+        if (str.empty())
+        {
+            return add(specs::Version());
         }
+        return specs::Version::parse(str).transform(add);
+    }
+
+    auto Matcher::pkg_may_match_version(
+        solv::ObjSolvableViewConst solv,
+        const specs::CompiledVersionSpec& version_spec
+    ) -> bool
+    {
+        // Unparsable versions are rejected later on with the other attributes
+        return get_cached_version(solv.version())
+            .transform([&](const CachedVersion& ver) { return version_spec.may_contain(ver.key); })
+            .value_or(true);
     }
 
     auto Matcher::get_pkg_attributes(solv::ObjPoolView pool, solv::ObjSolvableViewConst solv)
@@ -146,13 +170,13 @@ namespace mamba::solver::libsolv
             track_features.insert(std::string(pool.get_string(id)));
         }
 
-        return make_cached_version(m_version_cache, std::string(solv.version()))
+        return get_cached_version(solv.version())
             .transform(
-                [&](auto ver_ref)
+                [&](const CachedVersion& ver)
                 {
                     return Pkg{
                         /* .name= */ solv.name(),
-                        /* .version= */ ver_ref,
+                        /* .version= */ std::cref(ver.version),
                         /* .build_string= */ solv.build_string(),
                         /* .build_number= */ solv.build_number(),
                         /* .md5= */ solv.md5(),
@@ -8,12 +8,14 @@
 #define MAMBA_SOLVER_LIBSOLV_MATCHER
 
 #include <functional>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <unordered_map>
 
 #include "mamba/core/error_handling.hpp"
 #include "mamba/specs/channel.hpp"
+#include "mamba/specs/compiled_version_spec.hpp"
 #include "mamba/specs/match_spec.hpp"
 #include "mamba/specs/version.hpp"
 #include "solv-cpp/pool.hpp"
@@ -62,6 +64,13 @@ namespace mamba::solver::libsolv
         using channel_list = specs::ChannelResolveParams::channel_list;
         using channel_list_const_ref = std::reference_wrapper<const channel_list>;
 
+        struct CachedVersion
+        {
+            specs::Version version;
+            /** The ``specs::version_key`` of the version. */
+            std::string key;
+        };
+
         struct Pkg
         {
             std::string_view name;
@@ -80,6 +89,15 @@ namespace mamba::solver::libsolv
             solv::ObjSolvableViewConst solv
         ) -> expected_t<Pkg>;
 
+        auto get_cached_version(std::string_view version)
+            -> specs::expected_parse_t<std::reference_wrapper<const CachedVersion>>;
+
+        /** Reject packages on their version only, without evaluating the spec. */
+        auto pkg_may_match_version(  //
+            solv::ObjSolvableViewConst solv,
+            const specs::CompiledVersionSpec& version_spec
+        ) -> bool;
+
         auto pkg_match_except_channel(  //
             solv::ObjPoolView pool,
             solv::ObjSolvableViewConst solv,
@@ -103,7 +121,7 @@ namespace mamba::solver::libsolv
         solv::ObjQueue m_packages_buffer = {};
         // No need for matchspec cache since they have the same string id they should be handled
         // by libsolv.
-        std::unordered_map<std::string, specs::Version> m_version_cache = {};
+        std::unordered_map<std::string, CachedVersion> m_version_cache = {};
         std::unordered_map<std::string, channel_list> m_channel_cache = {};
     };
 }
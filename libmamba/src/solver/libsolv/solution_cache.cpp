@@ -0,0 +1,220 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <type_traits>
+#include <variant>
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include "mamba/core/output.hpp"
+#include "mamba/core/util.hpp"
+#include "mamba/solver/libsolv/database.hpp"
+#include "mamba/solver/libsolv/solution_cache.hpp"
+#include "mamba/specs/match_spec.hpp"
+#include "mamba/util/cryptography.hpp"
+#include "mamba/util/loop_control.hpp"
+#include "mamba/util/random.hpp"
+#include "mamba/util/string.hpp"
+#include "mamba/version.hpp"
+
+namespace mamba::solver::libsolv
+{
+    namespace
+    {
+        auto job_to_string(const Request::Job& job) -> std::string
+        {
+            return std::visit(
+                [](const auto& j) -> std::string
+                {
+                    using Job = std::decay_t<decltype(j)>;
+                    if constexpr (std::is_same_v<Job, Request::Install>)
+                    {
+                        return fmt::format("install|{}", j.spec.to_string());
+                    }
+                    else if constexpr (std::is_same_v<Job, Request::Remove>)
+                    {
+                        return fmt::format(
+                            "remove|{}|{}",
+                            j.spec.to_string(),
+                            j.clean_dependencies
+                        );
+                    }
+                    else if constexpr (std::is_same_v<Job, Request::Update>)
+                    {
+                        return fmt::format(
+                            "update|{}|{}",
+                            j.spec.to_string(),
+                            j.clean_dependencies
+                        );
+                    }
+                    else if constexpr (std::is_same_v<Job, Request::UpdateAll>)
+                    {
+                        return fmt::format("update_all|{}", j.clean_dependencies);
+                    }
+                    else if constexpr (std::is_same_v<Job, Request::Keep>)
+                    {
+                        return fmt::format("keep|{}", j.spec.to_string());
+                    }
+                    else if constexpr (std::is_same_v<Job, Request::Freeze>)
+                    {
+                        return fmt::format("freeze|{}", j.spec.to_string());
+                    }
+                    else if constexpr (std::is_same_v<Job, Request::Pin>)
+                    {
+                        return fmt::format("pin|{}", j.spec.to_string());
+                    }
+                },
+                job
+            );
+        }
+
+        /** Replace ``pkg`` with the identical package from the database, if there is one. */
+        auto refresh_from_database(Database& database, specs::PackageInfo& pkg) -> bool
+        {
+            auto ms = specs::MatchSpec::parse(fmt::format("{}=={}", pkg.name, pkg.version));
+            if (!ms.has_value())
+            {
+                return false;
+            }
+
+            bool found = false;
+            database.for_each_package_matching(
+                ms.value(),
+                [&](specs::PackageInfo&& candidate)
+                {
+                    if ((candidate.version == pkg.version)
+                        && (candidate.build_string == pkg.build_string)
+                        && (candidate.channel == pkg.channel)
+                        && (candidate.package_url == pkg.package_url)
+                        && (candidate.sha256 == pkg.sha256) && (candidate.md5 == pkg.md5))
+                    {
+                        pkg = std::move(candidate);
+                        found = true;
+                        return util::LoopControl::Break;
+                    }
+                    return util::LoopControl::Continue;
+                }
+            );
+            return found;
+        }
+    }
+
+    SolutionCache::SolutionCache(fs::u8path cache_dir)
+        : m_cache_dir(std::move(cache_dir))
+    {
+    }
+
+    auto
+    SolutionCache::key(const Database& database, const Request& request, MatchSpecParser ms_parser)
+        -> std::string
+    {
+        const auto& flags = request.flags;
+        auto data = fmt::format(
+            "{}|{}|{}\n{}|{}|{}|{}|{}|{}|{}\n",
+            version,
+            mamba::version(),
+            static_cast<int>(ms_parser),
+            flags.keep_dependencies,
+            flags.keep_user_specs,
+            flags.force_reinstall,
+            flags.allow_downgrade,
+            flags.allow_uninstall,
+            flags.strict_repo_priority,
+            flags.order_request
+        );
+        for (const auto& job : request.jobs)
+        {
+            data += job_to_string(job);
+            data += '\n';
+        }
+        data += database.fingerprint();
+        return util::Sha256Hasher().str_hex_str(data);
+    }
+
+    auto SolutionCache::cache_dir() const -> const fs::u8path&
+    {
+        return m_cache_dir;
+    }
+
+    auto SolutionCache::cache_file(std::string_view key) const -> fs::u8path
+    {
+        return m_cache_dir / util::concat(key, ".json");
+    }
+
+    auto SolutionCache::load(Database& database, std::string_view key) const
+        -> std::optional<Solution>
+    {
+        const auto path = cache_file(key);
+        std::error_code ec;
+        if (!fs::exists(path, ec))
+        {
+            return std::nullopt;
+        }
+
+        auto solution = Solution();
+        try
+        {
+            auto in = open_ifstream(path);
+            const auto j = nlohmann::json::parse(in);
+            if ((j.at("version").get<int>() != version) || (j.at("key").get<std::string>() != key))
+            {
+                return std::nullopt;
+            }
+            solution = j.at("actions").get<Solution>();
+        }
+        catch (const std::exception& e)
+        {
+            LOG_DEBUG << "Ignoring invalid cached solution '" << path.string() << "': " << e.what();
+            return std::nullopt;
+        }
+
+        for (auto& pkg : solution.packages())
+        {
+            if (!refresh_from_database(database, pkg))
+            {
+                LOG_DEBUG << "Cached solution '" << path.string() << "' refers to package '"
+                          << pkg.str() << "' which is no longer available";
+                return std::nullopt;
+            }
+        }
+        LOG_INFO << "Using cached solution '" << path.string() << "'";
+        return solution;
+    }
+
+    void SolutionCache::store(std::string_view key, const Solution& solution) const
+    {
+        const auto j = nlohmann::json{
+            { "version", version },
+            { "key", key },
+            { "actions", solution },
+        };
+
+        const auto path = cache_file(key);
+        const auto tmp_path = m_cache_dir
+                              / util::concat(
+                                  key,
+                                  ".",
+                                  util::generate_random_alphanumeric_string(8),
+                                  ".tmp"
+                              );
+        try
+        {
+            fs::create_directories(m_cache_dir);
+            {
+                auto out = open_ofstream(tmp_path);
+                out << j.dump();
+            }
+            fs::rename(tmp_path, path);
+        }
+        catch (const std::exception& e)
+        {
+            LOG_DEBUG << "Could not store solution in '" << path.string() << "': " << e.what();
+            std::error_code ec;
+            fs::remove(tmp_path, ec);
+        }
+    }
+}
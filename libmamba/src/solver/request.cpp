@@ -0,0 +1,155 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <variant>
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include "mamba/solver/request.hpp"
+
+namespace mamba::solver
+{
+    namespace
+    {
+        auto job_to_json(const Request::Job& job) -> nlohmann::json
+        {
+            return std::visit(
+                [](const auto& j) -> nlohmann::json
+                {
+                    using Job = std::decay_t<decltype(j)>;
+                    if constexpr (std::is_same_v<Job, Request::Install>)
+                    {
+                        return { { "type", "install" }, { "spec", j.spec.to_string() } };
+                    }
+                    else if constexpr (std::is_same_v<Job, Request::Remove>)
+                    {
+                        return {
+                            { "type", "remove" },
+                            { "spec", j.spec.to_string() },
+                            { "clean_dependencies", j.clean_dependencies },
+                        };
+                    }
+                    else if constexpr (std::is_same_v<Job, Request::Update>)
+                    {
+                        return {
+                            { "type", "update" },
+                            { "spec", j.spec.to_string() },
+                            { "clean_dependencies", j.clean_dependencies },
+                        };
+                    }
+                    else if constexpr (std::is_same_v<Job, Request::UpdateAll>)
+                    {
+                        return {
+                            { "type", "update_all" },
+                            { "clean_dependencies", j.clean_dependencies },
+                        };
+                    }
+                    else if constexpr (std::is_same_v<Job, Request::Keep>)
+                    {
+                        return { { "type", "keep" }, { "spec", j.spec.to_string() } };
+                    }
+                    else if constexpr (std::is_same_v<Job, Request::Freeze>)
+                    {
+                        return { { "type", "freeze" }, { "spec", j.spec.to_string() } };
+                    }
+                    else if constexpr (std::is_same_v<Job, Request::Pin>)
+                    {
+                        return { { "type", "pin" }, { "spec", j.spec.to_string() } };
+                    }
+                },
+                job
+            );
+        }
+
+        auto job_from_json(const nlohmann::json& j) -> Request::Job
+        {
+            const auto type = j.at("type").get<std::string>();
+            auto spec = [&]()
+            {
+                return specs::MatchSpec::parse(j.at("spec").get<std::string>())
+                    .or_else([](specs::ParseError&& err) { throw std::move(err); })
+                    .value();
+            };
+            auto clean = [&]() { return j.at("clean_dependencies").get<bool>(); };
+            if (type == "install")
+            {
+                return Request::Install{ spec() };
+            }
+            if (type == "remove")
+            {
+                return Request::Remove{ spec(), clean() };
+            }
+            if (type == "update")
+            {
+                return Request::Update{ spec(), clean() };
+            }
+            if (type == "update_all")
+            {
+                return Request::UpdateAll{ clean() };
+            }
+            if (type == "keep")
+            {
+                return Request::Keep{ spec() };
+            }
+            if (type == "freeze")
+            {
+                return Request::Freeze{ spec() };
+            }
+            if (type == "pin")
+            {
+                return Request::Pin{ spec() };
+            }
+            throw std::invalid_argument(fmt::format(R"(Unknown request job "{}")", type));
+        }
+    }
+
+    void to_json(nlohmann::json& j, const Request& request)
+    {
+        const auto& flags = request.flags;
+        j = {
+            {
+                "flags",
+                {
+                    { "keep_dependencies", flags.keep_dependencies },
+                    { "keep_user_specs", flags.keep_user_specs },
+                    { "force_reinstall", flags.force_reinstall },
+                    { "allow_downgrade", flags.allow_downgrade },
+                    { "allow_uninstall", flags.allow_uninstall },
+                    { "strict_repo_priority", flags.strict_repo_priority },
+                    { "order_request", flags.order_request },
+                },
+            },
+            { "jobs", nlohmann::json::array() },
+        };
+        for (const auto& job : request.jobs)
+        {
+            j["jobs"].push_back(job_to_json(job));
+        }
+    }
+
+    void from_json(const nlohmann::json& j, Request& request)
+    {
+        const auto& flags = j.at("flags");
+        request.flags = {
+            /* .keep_dependencies= */ flags.at("keep_dependencies").get<bool>(),
+            /* .keep_user_specs= */ flags.at("keep_user_specs").get<bool>(),
+            /* .force_reinstall= */ flags.at("force_reinstall").get<bool>(),
+            /* .allow_downgrade= */ flags.at("allow_downgrade").get<bool>(),
+            /* .allow_uninstall= */ flags.at("allow_uninstall").get<bool>(),
+            /* .strict_repo_priority= */ flags.at("strict_repo_priority").get<bool>(),
+            /* .order_request= */ flags.at("order_request").get<bool>(),
+        };
+        request.jobs.clear();
+        for (const auto& job : j.at("jobs"))
+        {
+            request.jobs.push_back(job_from_json(job));
+        }
+    }
+}
@@ -0,0 +1,125 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <stdexcept>
+#include <type_traits>
+#include <variant>
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include "mamba/solver/solution.hpp"
+
+namespace mamba::solver
+{
+    namespace
+    {
+        auto action_to_json(const Solution::Action& action) -> nlohmann::json
+        {
+            return std::visit(
+                [](const auto& a) -> nlohmann::json
+                {
+                    using Action = std::decay_t<decltype(a)>;
+                    if constexpr (std::is_same_v<Action, Solution::Omit>)
+                    {
+                        return { { "type", "omit" }, { "what", a.what } };
+                    }
+                    else if constexpr (std::is_same_v<Action, Solution::Upgrade>)
+                    {
+                        return {
+                            { "type", "upgrade" },
+                            { "remove", a.remove },
+                            { "install", a.install },
+                        };
+                    }
+                    else if constexpr (std::is_same_v<Action, Solution::Downgrade>)
+                    {
+                        return {
+                            { "type", "downgrade" },
+                            { "remove", a.remove },
+                            { "install", a.install },
+                        };
+                    }
+                    else if constexpr (std::is_same_v<Action, Solution::Change>)
+                    {
+                        return {
+                            { "type", "change" },
+                            { "remove", a.remove },
+                            { "install", a.install },
+                        };
+                    }
+                    else if constexpr (std::is_same_v<Action, Solution::Reinstall>)
+                    {
+                        return { { "type", "reinstall" }, { "what", a.what } };
+                    }
+                    else if constexpr (std::is_same_v<Action, Solution::Remove>)
+                    {
+                        return { { "type", "remove" }, { "remove", a.remove } };
+                    }
+                    else if constexpr (std::is_same_v<Action, Solution::Install>)
+                    {
+                        return { { "type", "install" }, { "install", a.install } };
+                    }
+                },
+                action
+            );
+        }
+
+        auto action_from_json(const nlohmann::json& j) -> Solution::Action
+        {
+            const auto type = j.at("type").get<std::string>();
+            auto pkg = [&](const char* key) { return j.at(key).get<specs::PackageInfo>(); };
+            if (type == "omit")
+            {
+                return Solution::Omit{ pkg("what") };
+            }
+            if (type == "upgrade")
+            {
+                return Solution::Upgrade{ pkg("remove"), pkg("install") };
+            }
+            if (type == "downgrade")
+            {
+                return Solution::Downgrade{ pkg("remove"), pkg("install") };
+            }
+            if (type == "change")
+            {
+                return Solution::Change{ pkg("remove"), pkg("install") };
+            }
+            if (type == "reinstall")
+            {
+                return Solution::Reinstall{ pkg("what") };
+            }
+            if (type == "remove")
+            {
+                return Solution::Remove{ pkg("remove") };
+            }
+            if (type == "install")
+            {
+                return Solution::Install{ pkg("install") };
+            }
+            throw std::invalid_argument(fmt::format(R"(Unknown solution action "{}")", type));
+        }
+    }
+
+    void to_json(nlohmann::json& j, const Solution& solution)
+    {
+        j = nlohmann::json::array();
+        for (const auto& action : solution.actions)
+        {
+            j.push_back(action_to_json(action));
+        }
+    }
+
+    void from_json(const nlohmann::json& j, Solution& solution)
+    {
+        solution.actions.clear();
+        solution.actions.reserve(j.size());
+        for (const auto& action : j)
+        {
+            solution.actions.push_back(action_from_json(action));
+        }
+    }
+}
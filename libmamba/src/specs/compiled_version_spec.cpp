@@ -0,0 +1,583 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <algorithm>
+#include <cassert>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+
+#include "mamba/specs/compiled_version_spec.hpp"
+
+namespace mamba::specs
+{
+    /***********************************
+     *  Implementation of version_key  *
+     ***********************************/
+
+    namespace
+    {
+        // A sequence (of atoms or parts) is compared with an infinite padding of empty
+        // elements, so each element is preceded by a tag telling how the rest of the sequence,
+        // starting at this element, compares with the padding.
+        // Trailing padding elements are not encoded.
+        constexpr char tag_less = '\x01';
+        constexpr char tag_end = '\x02';
+        constexpr char tag_greater = '\x03';
+
+        void append_uint(std::string& out, std::uint64_t n)
+        {
+            for (int shift = 56; shift >= 0; shift -= 8)
+            {
+                out.push_back(static_cast<char>((n >> shift) & 0xFF));
+            }
+        }
+
+        /** Same priorities as in the VersionPartAtom comparison. */
+        auto literal_priority(const std::string& lit) -> int
+        {
+            if (lit == "*")
+            {
+                return -3;
+            }
+            if (lit == "dev")
+            {
+                return -2;
+            }
+            if (lit == "_")
+            {
+                return -1;
+            }
+            if (lit.empty())
+            {
+                return 1;
+            }
+            if (lit == "post")
+            {
+                return 2;
+            }
+            return 0;
+        }
+
+        /** Comparison with the padding atom ``{0, ""}``. */
+        auto atom_sign(const VersionPartAtom& atom) -> int
+        {
+            if (atom.numeral() > 0)
+            {
+                return 1;
+            }
+            const auto priority = literal_priority(atom.literal());
+            return (priority > 1) - (priority < 1);
+        }
+
+        void append_atom(std::string& out, const VersionPartAtom& atom)
+        {
+            append_uint(out, atom.numeral());
+            const auto priority = literal_priority(atom.literal());
+            out.push_back(static_cast<char>(priority + 3));
+            if (priority == 0)
+            {
+                // Literals do not contain null characters, so this keeps the strcmp ordering
+                out += atom.literal();
+                out.push_back('\0');
+            }
+        }
+
+        template <typename T, typename Sign, typename Append>
+        void
+        append_sequence(std::string& out, const std::vector<T>& elems, Sign sign, Append append)
+        {
+            std::size_t i = 0;
+            while (i < elems.size())
+            {
+                // Find the next element that is not padding, it decides the tag of all the
+                // elements until then.
+                std::size_t j = i;
+                int s = 0;
+                for (; j < elems.size(); ++j)
+                {
+                    if ((s = sign(elems[j])) != 0)
+                    {
+                        break;
+                    }
+                }
+                if (j == elems.size())
+                {
+                    break;
+                }
+                for (; i <= j; ++i)
+                {
+                    out.push_back(s < 0 ? tag_less : tag_greater);
+                    append(out, elems[i]);
+                }
+            }
+            out.push_back(tag_end);
+        }
+
+        /** Comparison with the padding part, made of padding atoms. */
+        auto part_sign(const VersionPart& part) -> int
+        {
+            for (const auto& atom : part.atoms)
+            {
+                if (const auto s = atom_sign(atom); s != 0)
+                {
+                    return s;
+                }
+            }
+            return 0;
+        }
+
+        void append_part(std::string& out, const VersionPart& part)
+        {
+            append_sequence(out, part.atoms, atom_sign, append_atom);
+        }
+
+        void append_common_version(std::string& out, const CommonVersion& version)
+        {
+            append_sequence(out, version, part_sign, append_part);
+        }
+
+        auto epoch_key(const Version& version) -> std::string
+        {
+            auto out = std::string();
+            append_uint(out, version.epoch());
+            return out;
+        }
+
+        /** The smallest key greater than all the keys starting with ``prefix``. */
+        auto prefix_end(std::string prefix) -> std::optional<std::string>
+        {
+            while (!prefix.empty() && (static_cast<unsigned char>(prefix.back()) == 0xFF))
+            {
+                prefix.pop_back();
+            }
+            if (prefix.empty())
+            {
+                return std::nullopt;
+            }
+            prefix.back() = static_cast<char>(static_cast<unsigned char>(prefix.back()) + 1);
+            return prefix;
+        }
+    }
+
+    auto version_key(const Version& version) -> std::string
+    {
+        auto out = epoch_key(version);
+        append_common_version(out, version.version());
+        append_common_version(out, version.local());
+        return out;
+    }
+
+    /*******************************************
+     *  Implementation of CompiledVersionSpec  *
+     *******************************************/
+
+    namespace
+    {
+        /** An interval ``[lower, upper)``, unbounded if ``upper`` is empty. */
+        struct KeyRange
+        {
+            std::string lower;
+            std::optional<std::string> upper;
+        };
+
+        /** Keys of the versions with the same epoch. */
+        auto epoch_range(const Version& version) -> KeyRange
+        {
+            auto lower = epoch_key(version);
+            auto upper = prefix_end(lower);
+            return { std::move(lower), std::move(upper) };
+        }
+
+        /**
+         * Keys of all the versions starting with the given prefix, and some more.
+         *
+         * Version starting with the prefix have the same epoch and the same first numeral.
+         */
+        auto starts_with_range(const Version& prefix) -> KeyRange
+        {
+            const auto& parts = prefix.version();
+            if (parts.empty() || parts.front().atoms.empty())
+            {
+                return epoch_range(prefix);
+            }
+            const auto numeral = parts.front().atoms.front().numeral();
+            auto key_of_numeral = [&](std::size_t n)
+            {
+                auto out = epoch_key(prefix);
+                out.push_back(tag_greater);
+                out.push_back(tag_greater);
+                append_uint(out, n);
+                return out;
+            };
+            if (numeral == 0)
+            {
+                // Non-positive first parts are not all prefixed by the same bytes
+                return { epoch_key(prefix), key_of_numeral(1) };
+            }
+            auto lower = key_of_numeral(numeral);
+            auto upper = prefix_end(lower);
+            return { std::move(lower), std::move(upper) };
+        }
+
+        /**
+         * Keys of all the versions compatible with the given one, and some more.
+         *
+         * Compatible versions are greater, and share the first part for non-zero levels.
+         */
+        auto compatible_with_range(const Version& older, std::size_t level) -> KeyRange
+        {
+            const auto& parts = older.version();
+            auto prefix = epoch_key(older);
+            if ((level > 0) && !parts.empty() && (part_sign(parts.front()) > 0))
+            {
+                prefix.push_back(tag_greater);
+                append_part(prefix, parts.front());
+            }
+            return { version_key(older), prefix_end(std::move(prefix)) };
+        }
+
+        template <typename Match, typename Cut, typename Intervals>
+        auto make_range_intervals(KeyRange range, Match outside, Match inside) -> Intervals
+        {
+            auto out = Intervals{ { Cut{ std::move(range.lower), false } }, { outside, inside } };
+            if (range.upper.has_value())
+            {
+                out.cuts.push_back(Cut{ std::move(range.upper).value(), false });
+                out.matches.push_back(outside);
+            }
+            return out;
+        }
+
+        template <typename Cut>
+        auto cut_less(const Cut& lhs, const Cut& rhs) -> bool
+        {
+            return std::tie(lhs.key, lhs.after) < std::tie(rhs.key, rhs.after);
+        }
+    }
+
+    auto CompiledVersionSpec::compile_predicate(const VersionPredicate& pred) -> Intervals
+    {
+        const auto& ver = pred.m_version;
+        auto point = [&](Match outside, Match at) -> Intervals
+        {
+            auto key = version_key(ver);
+            return { { Cut{ key, false }, Cut{ key, true } }, { outside, at, outside } };
+        };
+        auto cut = [&](bool after, Match before_cut, Match after_cut) -> Intervals
+        { return { { Cut{ version_key(ver), after } }, { before_cut, after_cut } }; };
+        auto range = [&](KeyRange r, Match outside, Match inside) -> Intervals
+        { return make_range_intervals<Match, Cut, Intervals>(std::move(r), outside, inside); };
+
+        return std::visit(
+            [&](const auto& op) -> Intervals
+            {
+                using Op = std::decay_t<decltype(op)>;
+                if constexpr (std::is_same_v<Op, VersionPredicate::free_interval>)
+                {
+                    return { {}, { Match::all } };
+                }
+                else if constexpr (std::is_same_v<Op, std::equal_to<Version>>)
+                {
+                    return point(Match::none, Match::all);
+                }
+                else if constexpr (std::is_same_v<Op, std::not_equal_to<Version>>)
+                {
+                    return point(Match::all, Match::none);
+                }
+                else if constexpr (std::is_same_v<Op, std::greater<Version>>)
+                {
+                    return cut(true, Match::none, Match::all);
+                }
+                else if constexpr (std::is_same_v<Op, std::greater_equal<Version>>)
+                {
+                    return cut(false, Match::none, Match::all);
+                }
+                else if constexpr (std::is_same_v<Op, std::less<Version>>)
+                {
+                    return cut(false, Match::all, Match::none);
+                }
+                else if constexpr (std::is_same_v<Op, std::less_equal<Version>>)
+                {
+                    return cut(true, Match::all, Match::none);
+                }
+                else if constexpr (std::is_same_v<Op, VersionPredicate::starts_with>)
+                {
+                    return range(starts_with_range(ver), Match::none, Match::maybe);
+                }
+                else if constexpr (std::is_same_v<Op, VersionPredicate::not_starts_with>)
+                {
+                    return range(starts_with_range(ver), Match::all, Match::maybe);
+                }
+                else if constexpr (std::is_same_v<Op, VersionPredicate::compatible_with>)
+                {
+                    return range(compatible_with_range(ver, op.level), Match::none, Match::maybe);
+                }
+                else if constexpr (std::is_same_v<Op, VersionPredicate::version_glob>)
+                {
+                    return range(epoch_range(ver), Match::none, Match::maybe);
+                }
+                else
+                {
+                    static_assert(std::is_same_v<Op, VersionPredicate::not_version_glob>);
+                    return range(epoch_range(ver), Match::all, Match::maybe);
+                }
+            },
+            pred.m_operator
+        );
+    }
+
+    auto
+    CompiledVersionSpec::combine(const Intervals& lhs, const Intervals& rhs, util::BoolOperator op)
+        -> Intervals
+    {
+        // With none < maybe < all, intersection is the minimum and union the maximum
+        auto merge = [op](Match a, Match b)
+        { return (op == util::BoolOperator::logical_and) ? std::min(a, b) : std::max(a, b); };
+
+        auto out = Intervals();
+        out.cuts.reserve(lhs.cuts.size() + rhs.cuts.size());
+        out.matches.reserve(lhs.matches.size() + rhs.matches.size());
+        out.matches.push_back(merge(lhs.matches.front(), rhs.matches.front()));
+
+        std::size_t i = 0;
+        std::size_t j = 0;
+        while ((i < lhs.cuts.size()) || (j < rhs.cuts.size()))
+        {
+            const Cut* next = nullptr;
+            if ((j == rhs.cuts.size())
+                || ((i < lhs.cuts.size()) && cut_less(lhs.cuts[i], rhs.cuts[j])))
+            {
+                next = &lhs.cuts[i++];
+            }
+            else if ((i == lhs.cuts.size()) || cut_less(rhs.cuts[j], lhs.cuts[i]))
+            {
+                next = &rhs.cuts[j++];
+            }
+            else
+            {
+                next = &lhs.cuts[i++];
+                ++j;
+            }
+            // Adjacent intervals with the same match are merged
+            if (const auto m = merge(lhs.matches[i], rhs.matches[j]); m != out.matches.back())
+            {
+                out.cuts.push_back(*next);
+                out.matches.push_back(m);
+            }
+        }
+        return out;
+    }
+
+    auto CompiledVersionSpec::compile_tree(const VersionSpec& spec) -> Intervals
+    {
+        if (spec.m_tree.empty())
+        {
+            return { {}, { Match::all } };
+        }
+
+        // The infix traversal only puts parentheses around non-leaf operands, so each level
+        // holds at most one operator.
+        struct Frame
+        {
+            std::optional<Intervals> value = {};
+            std::optional<util::BoolOperator> op = {};
+        };
+
+        auto stack = std::vector<Frame>(1);
+        auto push_operand = [&](Intervals&& operand)
+        {
+            auto& frame = stack.back();
+            if (frame.op.has_value())
+            {
+                assert(frame.value.has_value());
+                frame.value = combine(frame.value.value(), operand, frame.op.value());
+                frame.op.reset();
+            }
+            else
+            {
+                frame.value = std::move(operand);
+            }
+        };
+
+        spec.m_tree.infix_for_each(
+            [&](const auto& token)
+            {
+                using Token = std::decay_t<decltype(token)>;
+                if constexpr (std::is_same_v<Token, VersionPredicate>)
+                {
+                    push_operand(compile_predicate(token));
+                }
+                else if constexpr (std::is_same_v<Token, util::BoolOperator>)
+                {
+                    stack.back().op = token;
+                }
+                else if constexpr (std::is_same_v<Token, VersionSpec::tree_type::LeftParenthesis>)
+                {
+                    stack.emplace_back();
+                }
+                else
+                {
+                    static_assert(std::is_same_v<Token, VersionSpec::tree_type::RightParenthesis>);
+                    assert(stack.size() > 1);
+                    auto inner = std::move(stack.back().value).value();
+                    stack.pop_back();
+                    push_operand(std::move(inner));
+                }
+            }
+        );
+
+        assert(stack.size() == 1);
+        return std::move(stack.front().value).value();
+    }
+
+    auto CompiledVersionSpec::parse_cached(std::string_view str)
+        -> expected_parse_t<std::shared_ptr<const CompiledVersionSpec>>
+    {
+        static auto mutex = std::mutex();
+        using compiled_ptr = std::shared_ptr<const CompiledVersionSpec>;
+        static auto cache = std::unordered_map<std::string, compiled_ptr>();
+        // Specs are small but the cache is process wide, so avoid growing it indefinitely.
+        static constexpr std::size_t max_cache_size = 1 << 14;
+
+        auto key = std::string(str);
+        {
+            auto lock = std::lock_guard(mutex);
+            if (const auto it = cache.find(key); it != cache.end())
+            {
+                return it->second;
+            }
+        }
+
+        return VersionSpec::parse(str).transform(
+            [&](VersionSpec&& spec)
+            {
+                auto compiled = std::make_shared<const CompiledVersionSpec>(std::move(spec));
+                auto lock = std::lock_guard(mutex);
+                if (cache.size() >= max_cache_size)
+                {
+                    cache.clear();
+                }
+                return cache.emplace(std::move(key), std::move(compiled)).first->second;
+            }
+        );
+    }
+
+    auto CompiledVersionSpec::compile_cached(const VersionSpec& spec)
+        -> std::shared_ptr<const CompiledVersionSpec>
+    {
+        // Reparsing the string representation gives the same spec
+        auto compiled = parse_cached(spec.to_string());
+        if (compiled.has_value())
+        {
+            return std::move(compiled).value();
+        }
+        return std::make_shared<const CompiledVersionSpec>(spec);
+    }
+
+    CompiledVersionSpec::CompiledVersionSpec(VersionSpec spec)
+        : m_spec(std::move(spec))
+        , m_intervals(compile_tree(m_spec))
+    {
+    }
+
+    auto CompiledVersionSpec::spec() const -> const VersionSpec&
+    {
+        return m_spec;
+    }
+
+    auto CompiledVersionSpec::is_exact() const -> bool
+    {
+        return std::find(m_intervals.matches.cbegin(), m_intervals.matches.cend(), Match::maybe)
+               == m_intervals.matches.cend();
+    }
+
+    auto CompiledVersionSpec::interval_count() const -> std::size_t
+    {
+        return static_cast<std::size_t>(
+            std::count(m_intervals.matches.cbegin(), m_intervals.matches.cend(), Match::all)
+            + std::count(m_intervals.matches.cbegin(), m_intervals.matches.cend(), Match::maybe)
+        );
+    }
+
+    auto CompiledVersionSpec::match_of(std::string_view point_key) const -> Match
+    {
+        // Number of cuts located before the key
+        const auto it = std::partition_point(
+            m_intervals.cuts.cbegin(),
+            m_intervals.cuts.cend(),
+            [&](const Cut& cut)
+            {
+                const auto cmp = point_key.compare(cut.key);
+                return (cmp > 0) || ((cmp == 0) && !cut.after);
+            }
+        );
+        return m_intervals.matches[static_cast<std::size_t>(it - m_intervals.cuts.cbegin())];
+    }
+
+    auto CompiledVersionSpec::contains(const Version& point) const -> bool
+    {
+        return contains(point, version_key(point));
+    }
+
+    auto CompiledVersionSpec::contains(const Version& point, std::string_view point_key) const
+        -> bool
+    {
+        switch (match_of(point_key))
+        {
+            case Match::none:
+                return false;
+            case Match::all:
+                return true;
+            case Match::maybe:
+                return m_spec.contains(point);
+        }
+        assert(false);
+        return false;
+    }
+
+    auto CompiledVersionSpec::may_contain(std::string_view point_key) const -> bool
+    {
+        return match_of(point_key) != Match::none;
+    }
+
+    auto CompiledVersionSpec::matching_indices(std::span<const Version> points) const
+        -> std::vector<std::size_t>
+    {
+        auto out = std::vector<std::size_t>();
+        if (m_intervals.cuts.empty() && (m_intervals.matches.front() != Match::maybe))
+        {
+            if (m_intervals.matches.front() == Match::all)
+            {
+                out.resize(points.size());
+                for (std::size_t i = 0; i < points.size(); ++i)
+                {
+                    out[i] = i;
+                }
+            }
+            return out;
+        }
+
+        auto key = std::string();
+        for (std::size_t i = 0; i < points.size(); ++i)
+        {
+            // Reuse the key buffer for all versions
+            key.clear();
+            append_uint(key, points[i].epoch());
+            append_common_version(key, points[i].version());
+            append_common_version(key, points[i].local());
+            if (contains(points[i], key))
+            {
+                out.push_back(i);
+            }
+        }
+        return out;
+    }
+}
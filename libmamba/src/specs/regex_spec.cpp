@@ -5,8 +5,16 @@
 // The full license is in the file LICENSE, distributed with this software.
 
 #include <algorithm>
+#include <bitset>
 #include <cassert>
+#include <cstdint>
+#include <optional>
+#include <regex>
 #include <sstream>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
 
 #include "mamba/specs/regex_spec.hpp"
 #include "mamba/util/string.hpp"
@@ -87,6 +95,789 @@ namespace mamba::specs
         return ss.str();
     }
 
+    namespace
+    {
+        // Characters with a special meaning in ECMAScript regexes.
+        constexpr std::string_view syntax_chars = "^$\\.*+?()[]{}|";
+
+        auto is_syntax_char(char c) -> bool
+        {
+            return syntax_chars.find(c) != std::string_view::npos;
+        }
+
+        auto is_quantifier(char c) -> bool
+        {
+            return (c == '*') || (c == '+') || (c == '?') || (c == '{');
+        }
+
+        /** Same as ``.`` in ECMAScript regexes. */
+        auto is_any_char(char c) -> bool
+        {
+            return (c != '\n') && (c != '\r');
+        }
+
+        /**
+         * Matcher for patterns made of literals, any characters ``.``, and ``.*`` wildcards.
+         *
+         * The pattern is split on wildcards in segments of fixed size, where null characters
+         * stand for any character.
+         * The segments after the first and before the last wildcard are matched at their first
+         * occurrence, which does not require backtracking.
+         */
+        struct SegmentsMatcher
+        {
+            static constexpr char any_char = '\0';
+
+            std::vector<std::string> segments = { std::string() };
+            bool has_wildcard = false;
+
+            [[nodiscard]] static auto compile(std::string_view pattern)
+                -> std::optional<SegmentsMatcher>;
+
+            [[nodiscard]] static auto matches_at(std::string_view segment, std::string_view str)
+                -> bool;
+            [[nodiscard]] static auto find(std::string_view segment, std::string_view str)
+                -> std::size_t;
+
+            [[nodiscard]] auto contains(std::string_view str) const -> bool;
+        };
+
+        auto SegmentsMatcher::compile(std::string_view pattern) -> std::optional<SegmentsMatcher>
+        {
+            auto out = SegmentsMatcher();
+            std::size_t i = 0;
+            while (i < pattern.size())
+            {
+                char atom = pattern[i];
+                if (atom == '.')
+                {
+                    atom = any_char;
+                    ++i;
+                    if ((i < pattern.size()) && (pattern[i] == '*'))
+                    {
+                        ++i;
+                        // Lazy repetition matches the same strings
+                        if ((i < pattern.size()) && (pattern[i] == '?'))
+                        {
+                            ++i;
+                        }
+                        out.has_wildcard = true;
+                        out.segments.emplace_back();
+                        continue;
+                    }
+                }
+                else if (atom == '\\')
+                {
+                    if ((i + 1 >= pattern.size()) || !is_syntax_char(pattern[i + 1]))
+                    {
+                        return std::nullopt;
+                    }
+                    atom = pattern[i + 1];
+                    i += 2;
+                }
+                else if (is_syntax_char(atom) || (atom == any_char) || !is_any_char(atom))
+                {
+                    return std::nullopt;
+                }
+                else
+                {
+                    ++i;
+                }
+
+                if ((i < pattern.size()) && is_quantifier(pattern[i]))
+                {
+                    return std::nullopt;
+                }
+                out.segments.back().push_back(atom);
+            }
+            return out;
+        }
+
+        auto SegmentsMatcher::matches_at(std::string_view segment, std::string_view str) -> bool
+        {
+            assert(str.size() >= segment.size());
+            for (std::size_t i = 0; i < segment.size(); ++i)
+            {
+                const bool match = (segment[i] == any_char) ? is_any_char(str[i])
+                                                            : (segment[i] == str[i]);
+                if (!match)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        auto SegmentsMatcher::find(std::string_view segment, std::string_view str) -> std::size_t
+        {
+            if (segment.find(any_char) == std::string_view::npos)
+            {
+                return str.find(segment);
+            }
+            for (std::size_t pos = 0; pos + segment.size() <= str.size(); ++pos)
+            {
+                if (matches_at(segment, str.substr(pos)))
+                {
+                    return pos;
+                }
+            }
+            return std::string_view::npos;
+        }
+
+        auto SegmentsMatcher::contains(std::string_view str) const -> bool
+        {
+            const auto& prefix = segments.front();
+            if (!has_wildcard)
+            {
+                return (str.size() == prefix.size()) && matches_at(prefix, str);
+            }
+
+            // Wildcards do not match line terminators, and literals cannot contain them
+            if (str.find_first_of("\n\r") != std::string_view::npos)
+            {
+                return false;
+            }
+
+            const auto& suffix = segments.back();
+            if ((str.size() < prefix.size() + suffix.size()) || !matches_at(prefix, str)
+                || !matches_at(suffix, str.substr(str.size() - suffix.size())))
+            {
+                return false;
+            }
+            str = str.substr(prefix.size(), str.size() - prefix.size() - suffix.size());
+            for (std::size_t i = 1; i + 1 < segments.size(); ++i)
+            {
+                const auto pos = find(segments[i], str);
+                if (pos == std::string_view::npos)
+                {
+                    return false;
+                }
+                str.remove_prefix(pos + segments[i].size());
+            }
+            return true;
+        }
+
+        using ByteSet = std::bitset<256>;
+
+        auto byte_index(char c) -> std::size_t
+        {
+            return static_cast<unsigned char>(c);
+        }
+
+        /** A Thompson automaton, simulated without backtracking. */
+        struct NfaProgram
+        {
+            enum struct Kind : std::uint8_t
+            {
+                bytes,
+                split,
+                match,
+            };
+
+            struct State
+            {
+                Kind kind = Kind::split;
+                std::uint32_t out = 0;
+                std::uint32_t alt = 0;
+                ByteSet bytes = {};
+            };
+
+            std::vector<State> states = {};
+            std::uint32_t start = 0;
+
+            /**
+             * Whether the program matches the whole string, or a prefix of it.
+             */
+            [[nodiscard]] auto matches(std::string_view str, bool whole) const -> bool;
+        };
+
+        auto NfaProgram::matches(std::string_view str, bool whole) const -> bool
+        {
+            auto current = std::vector<std::uint32_t>();
+            auto next = std::vector<std::uint32_t>();
+            auto marks = std::vector<std::size_t>(states.size(), 0);
+            current.reserve(states.size());
+            next.reserve(states.size());
+            std::size_t generation = 1;
+            bool has_match = false;
+
+            // Follow the epsilon transitions
+            auto add = [&](auto& self, std::vector<std::uint32_t>& list, std::uint32_t idx) -> void
+            {
+                if (marks[idx] == generation)
+                {
+                    return;
+                }
+                marks[idx] = generation;
+                const auto& state = states[idx];
+                if (state.kind == Kind::split)
+                {
+                    self(self, list, state.out);
+                    self(self, list, state.alt);
+                    return;
+                }
+                has_match |= (state.kind == Kind::match);
+                list.push_back(idx);
+            };
+
+            add(add, current, start);
+            for (const char c : str)
+            {
+                if (has_match && !whole)
+                {
+                    return true;
+                }
+                ++generation;
+                has_match = false;
+                next.clear();
+                for (const auto idx : current)
+                {
+                    const auto& state = states[idx];
+                    if ((state.kind == Kind::bytes) && state.bytes.test(byte_index(c)))
+                    {
+                        add(add, next, state.out);
+                    }
+                }
+                std::swap(current, next);
+                if (current.empty())
+                {
+                    return false;
+                }
+            }
+            return has_match;
+        }
+
+        /**
+         * Compile a subset of ECMAScript regexes into NfaProgram.
+         *
+         * Unsupported constructs, such as backreferences, counted repetitions, or anchors and
+         * lookarounds in the middle of the pattern, make the compilation fail.
+         */
+        class NfaCompiler
+        {
+        public:
+
+            static constexpr std::size_t max_states = 4096;
+
+            explicit NfaCompiler(std::string_view pattern)
+                : m_pattern(pattern)
+            {
+            }
+
+            [[nodiscard]] auto at_negative_lookahead() const -> bool
+            {
+                return m_pattern.substr(m_pos, 3) == "(?!";
+            }
+
+            /** Compile a ``(?!...)`` lookahead, and whether it is anchored at the end. */
+            [[nodiscard]] auto compile_negative_lookahead()
+                -> std::optional<std::pair<NfaProgram, bool>>;
+
+            /**
+             * Compile the rest of the pattern.
+             *
+             * Top level alternatives can be disallowed since a leading lookahead only applies
+             * to the first one.
+             */
+            [[nodiscard]] auto compile_remaining(bool allow_alternation)
+                -> std::optional<NfaProgram>;
+
+        private:
+
+            using Outs = std::vector<std::pair<std::uint32_t, bool>>;
+
+            /** A part of the automaton whose dangling transitions are to be patched. */
+            struct Fragment
+            {
+                std::uint32_t start;
+                Outs outs;
+            };
+
+            std::string_view m_pattern;
+            std::size_t m_pos = 0;
+            std::vector<NfaProgram::State> m_states = {};
+            bool m_stop_at_end_anchor = false;
+
+            [[nodiscard]] auto peek(std::size_t offset = 0) const -> std::optional<char>
+            {
+                if (m_pos + offset < m_pattern.size())
+                {
+                    return m_pattern[m_pos + offset];
+                }
+                return std::nullopt;
+            }
+
+            [[nodiscard]] auto add_state(NfaProgram::State state) -> std::optional<std::uint32_t>
+            {
+                if (m_states.size() >= max_states)
+                {
+                    return std::nullopt;
+                }
+                m_states.push_back(std::move(state));
+                return static_cast<std::uint32_t>(m_states.size() - 1);
+            }
+
+            void patch(const Outs& outs, std::uint32_t target)
+            {
+                for (const auto& [idx, is_alt] : outs)
+                {
+                    (is_alt ? m_states[idx].alt : m_states[idx].out) = target;
+                }
+            }
+
+            [[nodiscard]] auto finish(Fragment frag) -> std::optional<NfaProgram>;
+            [[nodiscard]] auto parse_alternation() -> std::optional<Fragment>;
+            [[nodiscard]] auto continue_alternation(Fragment first) -> std::optional<Fragment>;
+            [[nodiscard]] auto parse_concatenation() -> std::optional<Fragment>;
+            [[nodiscard]] auto parse_repetition() -> std::optional<Fragment>;
+            [[nodiscard]] auto parse_atom() -> std::optional<Fragment>;
+            [[nodiscard]] auto parse_class() -> std::optional<ByteSet>;
+            [[nodiscard]] auto parse_escape(bool in_class) -> std::optional<ByteSet>;
+        };
+
+        auto NfaCompiler::finish(Fragment frag) -> std::optional<NfaProgram>
+        {
+            const auto match = add_state({ NfaProgram::Kind::match });
+            if (!match.has_value())
+            {
+                return std::nullopt;
+            }
+            patch(frag.outs, match.value());
+            auto out = NfaProgram{ std::move(m_states), frag.start };
+            m_states = {};
+            return out;
+        }
+
+        auto NfaCompiler::compile_negative_lookahead() -> std::optional<std::pair<NfaProgram, bool>>
+        {
+            assert(at_negative_lookahead());
+            m_pos += 3;
+
+            // An end anchor is only supported when it applies to the whole lookahead
+            m_stop_at_end_anchor = true;
+            auto frag = parse_concatenation();
+            m_stop_at_end_anchor = false;
+            if (!frag.has_value())
+            {
+                return std::nullopt;
+            }
+            bool anchored = false;
+            if (peek() == '$')
+            {
+                ++m_pos;
+                anchored = true;
+            }
+            else
+            {
+                frag = continue_alternation(std::move(frag).value());
+            }
+            if (!frag.has_value() || (peek() != ')'))
+            {
+                return std::nullopt;
+            }
+            ++m_pos;
+
+            auto program = finish(std::move(frag).value());
+            if (!program.has_value())
+            {
+                return std::nullopt;
+            }
+            return { { std::move(program).value(), anchored } };
+        }
+
+        auto NfaCompiler::compile_remaining(bool allow_alternation) -> std::optional<NfaProgram>
+        {
+            auto frag = parse_concatenation();
+            if (frag.has_value() && (peek() == '|'))
+            {
+                if (!allow_alternation)
+                {
+                    return std::nullopt;
+                }
+                frag = continue_alternation(std::move(frag).value());
+            }
+            if (!frag.has_value() || peek().has_value())
+            {
+                return std::nullopt;
+            }
+            return finish(std::move(frag).value());
+        }
+
+        auto NfaCompiler::parse_alternation() -> std::optional<Fragment>
+        {
+            auto first = parse_concatenation();
+            if (!first.has_value())
+            {
+                return std::nullopt;
+            }
+            return continue_alternation(std::move(first).value());
+        }
+
+        auto NfaCompiler::continue_alternation(Fragment first) -> std::optional<Fragment>
+        {
+            auto out = std::move(first);
+            while (peek() == '|')
+            {
+                ++m_pos;
+                auto rhs = parse_concatenation();
+                if (!rhs.has_value())
+                {
+                    return std::nullopt;
+                }
+                const auto split = add_state(
+                    { NfaProgram::Kind::split, out.start, rhs.value().start }
+                );
+                if (!split.has_value())
+                {
+                    return std::nullopt;
+                }
+                out.start = split.value();
+                out.outs.insert(out.outs.end(), rhs.value().outs.cbegin(), rhs.value().outs.cend());
+            }
+            return out;
+        }
+
+        auto NfaCompiler::parse_concatenation() -> std::optional<Fragment>
+        {
+            // An empty sequence is an epsilon transition
+            const auto empty = add_state({ NfaProgram::Kind::split });
+            if (!empty.has_value())
+            {
+                return std::nullopt;
+            }
+            auto out = Fragment{
+                empty.value(),
+                { { empty.value(), false }, { empty.value(), true } },
+            };
+
+            while (true)
+            {
+                const auto c = peek();
+                if (!c.has_value() || (c == '|') || (c == ')')
+                    || (m_stop_at_end_anchor && (c == '$')))
+                {
+                    return out;
+                }
+                auto next = parse_repetition();
+                if (!next.has_value())
+                {
+                    return std::nullopt;
+                }
+                patch(out.outs, next.value().start);
+                out.outs = std::move(next).value().outs;
+            }
+        }
+
+        auto NfaCompiler::parse_repetition() -> std::optional<Fragment>
+        {
+            auto atom = parse_atom();
+            if (!atom.has_value())
+            {
+                return std::nullopt;
+            }
+            const auto quantifier = peek();
+            if (!quantifier.has_value() || !is_quantifier(quantifier.value()))
+            {
+                return atom;
+            }
+            if (quantifier == '{')
+            {
+                return std::nullopt;
+            }
+            ++m_pos;
+            // Lazy repetitions match the same strings
+            if (peek() == '?')
+            {
+                ++m_pos;
+            }
+            if (const auto c = peek(); c.has_value() && is_quantifier(c.value()))
+            {
+                return std::nullopt;
+            }
+
+            const auto split = add_state({ NfaProgram::Kind::split, atom.value().start });
+            if (!split.has_value())
+            {
+                return std::nullopt;
+            }
+            switch (quantifier.value())
+            {
+                case '*':
+                    patch(atom.value().outs, split.value());
+                    return Fragment{ split.value(), { { split.value(), true } } };
+                case '+':
+                    patch(atom.value().outs, split.value());
+                    return Fragment{ atom.value().start, { { split.value(), true } } };
+                default:
+                    assert(quantifier == '?');
+                    atom.value().outs.emplace_back(split.value(), true);
+                    return Fragment{ split.value(), std::move(atom).value().outs };
+            }
+        }
+
+        auto NfaCompiler::parse_atom() -> std::optional<Fragment>
+        {
+            const auto c = peek();
+            assert(c.has_value());
+
+            auto bytes = std::optional<ByteSet>();
+            if (c == '(')
+            {
+                ++m_pos;
+                if (peek() == '?')
+                {
+                    // Only non capturing groups, lookarounds are only supported at the start
+                    if (peek(1) != ':')
+                    {
+                        return std::nullopt;
+                    }
+                    m_pos += 2;
+                }
+                auto group = parse_alternation();
+                if (!group.has_value() || (peek() != ')'))
+                {
+                    return std::nullopt;
+                }
+                ++m_pos;
+                return group;
+            }
+            if (c == '[')
+            {
+                ++m_pos;
+                bytes = parse_class();
+            }
+            else if (c == '.')
+            {
+                ++m_pos;
+                bytes.emplace().set();
+                bytes->reset(byte_index('\n'));
+                bytes->reset(byte_index('\r'));
+            }
+            else if (c == '\\')
+            {
+                ++m_pos;
+                bytes = parse_escape(false);
+            }
+            else if (!is_syntax_char(c.value()))
+            {
+                ++m_pos;
+                bytes.emplace().set(byte_index(c.value()));
+            }
+
+            if (!bytes.has_value())
+            {
+                return std::nullopt;
+            }
+            const auto state = add_state({ NfaProgram::Kind::bytes, 0, 0, bytes.value() });
+            if (!state.has_value())
+            {
+                return std::nullopt;
+            }
+            return Fragment{ state.value(), { { state.value(), false } } };
+        }
+
+        auto NfaCompiler::parse_escape(bool in_class) -> std::optional<ByteSet>
+        {
+            const auto c = peek();
+            if (!c.has_value())
+            {
+                return std::nullopt;
+            }
+            ++m_pos;
+
+            auto out = ByteSet();
+            auto add_range = [&](char first, char last)
+            {
+                for (auto i = byte_index(first); i <= byte_index(last); ++i)
+                {
+                    out.set(i);
+                }
+            };
+            switch (c.value())
+            {
+                case 'd':
+                case 'D':
+                    add_range('0', '9');
+                    break;
+                case 'w':
+                case 'W':
+                    add_range('0', '9');
+                    add_range('a', 'z');
+                    add_range('A', 'Z');
+                    out.set(byte_index('_'));
+                    break;
+                case 's':
+                case 'S':
+                    for (const char space : std::string_view(" \t\n\v\f\r"))
+                    {
+                        out.set(byte_index(space));
+                    }
+                    break;
+                case 't':
+                    out.set(byte_index('\t'));
+                    return out;
+                case 'n':
+                    out.set(byte_index('\n'));
+                    return out;
+                case 'r':
+                    out.set(byte_index('\r'));
+                    return out;
+                case 'f':
+                    out.set(byte_index('\f'));
+                    return out;
+                case 'v':
+                    out.set(byte_index('\v'));
+                    return out;
+                default:
+                    if (is_syntax_char(c.value()) || (in_class && (c == '-')))
+                    {
+                        out.set(byte_index(c.value()));
+                        return out;
+                    }
+                    return std::nullopt;
+            }
+            if (util::is_upper(c.value()))
+            {
+                out.flip();
+            }
+            return out;
+        }
+
+        auto NfaCompiler::parse_class() -> std::optional<ByteSet>
+        {
+            auto out = ByteSet();
+            const bool negated = (peek() == '^');
+            if (negated)
+            {
+                ++m_pos;
+            }
+            // Empty classes and posix classes are left to std::regex
+            if (peek() == ']')
+            {
+                return std::nullopt;
+            }
+
+            // Read a single character, or nothing if it is a class escape such as ``\d``
+            auto read_char = [&](ByteSet& set) -> std::optional<std::optional<char>>
+            {
+                const auto c = peek();
+                if (!c.has_value() || (c == '['))
+                {
+                    return std::nullopt;
+                }
+                ++m_pos;
+                if (c != '\\')
+                {
+                    return { c };
+                }
+                auto escaped = parse_escape(true);
+                if (!escaped.has_value())
+                {
+                    return std::nullopt;
+                }
+                set = escaped.value();
+                if (set.count() == 1)
+                {
+                    for (std::size_t i = 0; i < set.size(); ++i)
+                    {
+                        if (set.test(i))
+                        {
+                            return { static_cast<char>(i) };
+                        }
+                    }
+                }
+                return { std::optional<char>() };
+            };
+
+            while (peek() != ']')
+            {
+                auto escaped = ByteSet();
+                const auto first = read_char(escaped);
+                if (!first.has_value())
+                {
+                    return std::nullopt;
+                }
+                if (!first.value().has_value())
+                {
+                    out |= escaped;
+                    continue;
+                }
+                const char lower = first.value().value();
+                if ((peek() == '-') && peek(1).has_value() && (peek(1) != ']'))
+                {
+                    ++m_pos;
+                    const auto last = read_char(escaped);
+                    if (!last.has_value() || !last.value().has_value()
+                        || (byte_index(last.value().value()) < byte_index(lower)))
+                    {
+                        return std::nullopt;
+                    }
+                    for (auto i = byte_index(lower); i <= byte_index(last.value().value()); ++i)
+                    {
+                        out.set(i);
+                    }
+                }
+                else
+                {
+                    out.set(byte_index(lower));
+                }
+            }
+            ++m_pos;
+
+            if (negated)
+            {
+                out.flip();
+            }
+            return out;
+        }
+
+        /** A pattern with optional leading negative lookaheads. */
+        struct NfaMatcher
+        {
+            std::vector<std::pair<NfaProgram, bool>> negative_lookaheads = {};
+            NfaProgram program = {};
+
+            [[nodiscard]] static auto compile(std::string_view pattern) -> std::optional<NfaMatcher>
+            {
+                auto compiler = NfaCompiler(pattern);
+                auto out = NfaMatcher();
+                while (compiler.at_negative_lookahead())
+                {
+                    auto lookahead = compiler.compile_negative_lookahead();
+                    if (!lookahead.has_value())
+                    {
+                        return std::nullopt;
+                    }
+                    out.negative_lookaheads.push_back(std::move(lookahead).value());
+                }
+                auto program = compiler.compile_remaining(out.negative_lookaheads.empty());
+                if (!program.has_value())
+                {
+                    return std::nullopt;
+                }
+                out.program = std::move(program).value();
+                return out;
+            }
+
+            [[nodiscard]] auto contains(std::string_view str) const -> bool
+            {
+                for (const auto& [lookahead, anchored] : negative_lookaheads)
+                {
+                    if (lookahead.matches(str, anchored))
+                    {
+                        return false;
+                    }
+                }
+                return program.matches(str, true);
+            }
+        };
+    }
+
+    struct RegexSpec::Matcher
+    {
+        std::variant<SegmentsMatcher, NfaMatcher, std::regex> impl;
+    };
+
     RegexSpec::RegexSpec()
         : RegexSpec(std::string(free_pattern))
     {
@@ -94,13 +885,43 @@ namespace mamba::specs
 
     RegexSpec::RegexSpec(std::string raw_pattern)
         : m_raw_pattern(regexify(std::move(raw_pattern)))
-        , m_pattern(std::regex(m_raw_pattern))
     {
+        assert(util::starts_with(m_raw_pattern, pattern_start));
+        assert(util::ends_with(m_raw_pattern, pattern_end));
+        // The whole string is always matched, so the outer anchors can be dropped
+        const auto inner = std::string_view(m_raw_pattern).substr(1, m_raw_pattern.size() - 2);
+        if (auto segments = SegmentsMatcher::compile(inner))
+        {
+            m_matcher = std::make_shared<const Matcher>(Matcher{ std::move(segments).value() });
+        }
+        else if (auto nfa = NfaMatcher::compile(inner))
+        {
+            m_matcher = std::make_shared<const Matcher>(Matcher{ std::move(nfa).value() });
+        }
+        else
+        {
+            // Throws on invalid patterns
+            m_matcher = std::make_shared<const Matcher>(Matcher{ std::regex(m_raw_pattern) });
+        }
     }
 
     auto RegexSpec::contains(std::string_view str) const -> bool
     {
-        return std::regex_match(str.cbegin(), str.cend(), m_pattern);
+        return std::visit(
+            [&](const auto& matcher) -> bool
+            {
+                using T = std::decay_t<decltype(matcher)>;
+                if constexpr (std::is_same_v<T, std::regex>)
+                {
+                    return std::regex_match(str.cbegin(), str.cend(), matcher);
+                }
+                else
+                {
+                    return matcher.contains(str);
+                }
+            },
+            m_matcher->impl
+        );
     }
 
     auto RegexSpec::is_explicitly_free() const -> bool
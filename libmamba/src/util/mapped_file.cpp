@@ -0,0 +1,182 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "mamba/util/mapped_file.hpp"
+
+namespace mamba::util
+{
+    MappedFile::MappedFile(const char* data, std::size_t size)
+        : m_data(data)
+        , m_size(size)
+    {
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr))
+        , m_size(std::exchange(other.m_size, 0))
+    {
+    }
+
+    auto MappedFile::operator=(MappedFile&& other) noexcept -> MappedFile&
+    {
+        if (this != &other)
+        {
+            unmap();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+        }
+        return *this;
+    }
+
+    MappedFile::~MappedFile()
+    {
+        unmap();
+    }
+
+    auto MappedFile::try_open(const fs::u8path& path, std::error_code& ec) -> MappedFile
+    {
+#ifdef _WIN32
+        HANDLE file = ::CreateFileW(
+            path.wstring().c_str(),
+            GENERIC_READ,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            nullptr,
+            OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+            nullptr
+        );
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            ec = std::error_code(static_cast<int>(::GetLastError()), std::system_category());
+            return {};
+        }
+
+        LARGE_INTEGER file_size;
+        if (!::GetFileSizeEx(file, &file_size))
+        {
+            ec = std::error_code(static_cast<int>(::GetLastError()), std::system_category());
+            ::CloseHandle(file);
+            return {};
+        }
+        if (file_size.QuadPart == 0)
+        {
+            ::CloseHandle(file);
+            return {};
+        }
+
+        HANDLE mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr)
+        {
+            ec = std::error_code(static_cast<int>(::GetLastError()), std::system_category());
+            ::CloseHandle(file);
+            return {};
+        }
+
+        // The view keeps the mapping alive after the handles are closed.
+        const void* data = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (data == nullptr)
+        {
+            ec = std::error_code(static_cast<int>(::GetLastError()), std::system_category());
+        }
+        ::CloseHandle(mapping);
+        ::CloseHandle(file);
+        if (data == nullptr)
+        {
+            return {};
+        }
+        return { static_cast<const char*>(data), static_cast<std::size_t>(file_size.QuadPart) };
+#else
+        const std::string name = path.string();
+        const int fd = ::open(name.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            ec = std::error_code(errno, std::generic_category());
+            return {};
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0)
+        {
+            ec = std::error_code(errno, std::generic_category());
+            ::close(fd);
+            return {};
+        }
+        const auto size = static_cast<std::size_t>(st.st_size);
+        if (size == 0)
+        {
+            ::close(fd);
+            return {};
+        }
+
+        // The mapping stays valid after the file descriptor is closed.
+        void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            ec = std::error_code(errno, std::generic_category());
+        }
+        ::close(fd);
+        if (data == MAP_FAILED)
+        {
+            return {};
+        }
+        // Files are mostly read once from start to end
+        ::madvise(data, size, MADV_SEQUENTIAL);
+        return { static_cast<const char*>(data), size };
+#endif
+    }
+
+    auto MappedFile::try_open(const fs::u8path& path) -> tl::expected<MappedFile, std::error_code>
+    {
+        auto io_error = std::error_code();
+        auto file = MappedFile::try_open(path, io_error);
+        if (io_error)
+        {
+            return tl::unexpected(io_error);
+        }
+        return { std::move(file) };
+    }
+
+    auto MappedFile::data() const noexcept -> const char*
+    {
+        return m_data;
+    }
+
+    auto MappedFile::size() const noexcept -> std::size_t
+    {
+        return m_size;
+    }
+
+    auto MappedFile::view() const noexcept -> std::string_view
+    {
+        return { m_data, m_size };
+    }
+
+    void MappedFile::unmap() noexcept
+    {
+        if (m_data == nullptr)
+        {
+            return;
+        }
+#ifdef _WIN32
+        ::UnmapViewOfFile(m_data);
+#else
+        ::munmap(const_cast<char*>(m_data), m_size);
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+}
@@ -155,49 +155,45 @@ namespace mamba::util
      *  glob  *
      **********/
 
-    namespace
+    auto glob_match(std::string_view pattern, std::string_view str, char glob) -> bool
     {
-        auto glob_match_impl(std::string_view pattern, std::string_view str, char glob) -> bool
+        static constexpr auto npos = std::string_view::npos;
+
+        const auto first_glob = pattern.find(glob);
+        if (first_glob == npos)
         {
-            static constexpr auto npos = std::string_view::npos;
+            return str == pattern;
+        }
+        const auto last_glob = pattern.rfind(glob);
 
-            assert(starts_with(pattern, glob));
-            pattern = lstrip(pattern, glob);  // Drop leading '*'
-            if (pattern.empty())              // input pattern was "*"
-            {
-                return true;
-            }
+        // The words before the first glob and after the last one are anchored
+        const auto prefix = pattern.substr(0, first_glob);
+        const auto suffix = pattern.substr(last_glob + 1);
+        if ((str.size() < prefix.size() + suffix.size()) || !starts_with(str, prefix)
+            || !ends_with(str, suffix))
+        {
+            return false;
+        }
+        str = str.substr(prefix.size(), str.size() - prefix.size() - suffix.size());
 
-            const auto next_glob = pattern.find(glob);
-            const auto word = pattern.substr(0, next_glob);
-            if (const auto wpos = str.find(word); wpos != npos)
+        // The words in between can be matched at their first occurrence without backtracking
+        auto middle = pattern.substr(first_glob, last_glob - first_glob);
+        while (!middle.empty())
+        {
+            middle = lstrip(middle, glob);
+            const auto next_glob = middle.find(glob);
+            const auto word = middle.substr(0, next_glob);
+            if (!word.empty())
             {
-                if (next_glob == npos)
+                const auto pos = str.find(word);
+                if (pos == npos)
                 {
-                    // Return ends_with(str, word);
-                    return (wpos + word.size()) == str.size();
+                    return false;
                 }
-                return glob_match_impl(pattern.substr(next_glob), str.substr(wpos + word.size()), glob);
+                str.remove_prefix(pos + word.size());
             }
-            return false;
-        }
-    }
-
-    auto glob_match(std::string_view pattern, std::string_view str, char glob) -> bool
-    {
-        static constexpr auto npos = std::string_view::npos;
-
-        if (starts_with(pattern, glob))
-        {
-            return glob_match_impl(pattern, str, glob);
-        }
-        if (const auto next_glob = pattern.find(glob); next_glob != npos)
-        {
-            const auto word = pattern.substr(0, next_glob);
-            return starts_with(str, word)
-                   && glob_match_impl(pattern.substr(next_glob), remove_prefix(str, word), glob);
-            ;
+            middle = (next_glob == npos) ? std::string_view() : middle.substr(next_glob);
         }
-        return str == pattern;
+        return true;
     }
 }
@@ -7,6 +7,8 @@
 #include <algorithm>
 #include <deque>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <catch2/catch_all.hpp>
 #include <fmt/format.h>
@@ -67,6 +69,77 @@ namespace mamba::logging
         }
     }
 
+    TEST_CASE("details::MPSCRingBuffer")
+    {
+        SECTION("capacity is a power of two")
+        {
+            CHECK(details::MPSCRingBuffer<int>(5).capacity() == 8);
+            CHECK(details::MPSCRingBuffer<int>(8).capacity() == 8);
+        }
+
+        SECTION("values are popped in order until empty")
+        {
+            details::MPSCRingBuffer<std::string> queue(4);
+            for (int lap = 0; lap < 3; ++lap)
+            {
+                for (std::string value : { "A", "B", "C", "D" })
+                {
+                    REQUIRE(queue.try_push(value));
+                }
+                std::string rejected = "E";
+                REQUIRE_FALSE(queue.try_push(rejected));
+                REQUIRE(rejected == "E");
+
+                for (std::string expected : { "A", "B", "C", "D" })
+                {
+                    REQUIRE(queue.try_pop() == expected);
+                }
+                REQUIRE_FALSE(queue.try_pop().has_value());
+            }
+        }
+
+        SECTION("concurrent producers")
+        {
+            static constexpr int producers_count = 8;
+            static constexpr int values_count = 10000;
+
+            details::MPSCRingBuffer<std::pair<int, int>> queue(64);
+            std::vector<std::thread> producers;
+            for (int producer = 0; producer < producers_count; ++producer)
+            {
+                producers.emplace_back(
+                    [&queue, producer]
+                    {
+                        for (int i = 0; i < values_count; ++i)
+                        {
+                            auto value = std::pair(producer, i);
+                            while (not queue.try_push(value))
+                            {
+                                std::this_thread::yield();
+                            }
+                        }
+                    }
+                );
+            }
+
+            // Values of each producer are received in the order they were pushed
+            std::vector<int> next(producers_count, 0);
+            for (int received = 0; received < producers_count * values_count;)
+            {
+                if (auto value = queue.try_pop())
+                {
+                    REQUIRE(value->second == next.at(static_cast<std::size_t>(value->first))++);
+                    ++received;
+                }
+            }
+            for (auto& thread : producers)
+            {
+                thread.join();
+            }
+            REQUIRE_FALSE(queue.try_pop().has_value());
+        }
+    }
+
     TEST_CASE("details::BasicBacktrace")
     {
         using namespace std::string_view_literals;
@@ -491,4 +564,71 @@ namespace mamba::logging
         }
     }
 
+    TEST_CASE("LogHandler_Async logging API basic tests")
+    {
+        // The records must reach the wrapped handler as if it was used directly
+        const testing::LogHandlerTestsOptions options{ .log_count = 42 };
+        std::vector<LogRecord> expected_output;
+        testing::expected_output_test_classic_inline(
+            [&](LogRecord log_record) { expected_output.push_back(log_record); },
+            options
+        );
+
+        LogHandler_History history{ { .clear_on_stop = false } };
+        const auto results = testing::test_classic_inline_logging_api_usage(
+            // Queue all the records, and more than it can hold
+            LogHandler_Async{ &history,
+                              { .queue_capacity = 4, .synchronous_level = log_level::off } },
+            options
+        );
+        REQUIRE(results.handler.has_value());
+        REQUIRE(results.handler.unsafe_get<LogHandler_Async>() != nullptr);
+        REQUIRE(history.capture_history() == expected_output);
+    }
+
+    TEST_CASE("LogHandler_Async keeps the records logged while stopping")
+    {
+        constexpr std::size_t thread_count = 4;
+        constexpr std::size_t log_count = 2000;
+
+        LogHandler_History history{ { .clear_on_stop = false } };
+        LogHandler_Async handler{ &history,
+                                  { .queue_capacity = 8, .synchronous_level = log_level::off } };
+        handler.start_log_handling({ .logging_level = log_level::all }, {});
+
+        std::vector<std::thread> producers;
+        for (std::size_t t = 0; t < thread_count; ++t)
+        {
+            producers.emplace_back(
+                [&]
+                {
+                    for (std::size_t i = 0; i < log_count; ++i)
+                    {
+                        // Records which do not fit in the queue, or are logged after stopping,
+                        // are passed directly to the wrapped handler
+                        handler.log({ .message = "record", .level = log_level::info });
+                    }
+                }
+            );
+        }
+        std::this_thread::yield();
+        handler.stop_log_handling(stop_reason::manual_stop);
+        CHECK_FALSE(handler.is_started());
+        for (auto& producer : producers)
+        {
+            producer.join();
+        }
+
+        CHECK(history.capture_history().size() == thread_count * log_count);
+    }
+
+    TEST_CASE("LogHandler_Async concurrency")
+    {
+        LogHandler_History history;
+        testing::test_concurrent_logging_api_support(
+            LogHandler_Async{ &history,
+                              { .queue_capacity = 16, .synchronous_level = log_level::off } }
+        );
+    }
+
 }
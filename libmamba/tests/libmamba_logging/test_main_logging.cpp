@@ -62,4 +62,38 @@ namespace mamba::logging
         }
     }
 
+    TEST_CASE("logging::is_enabled")
+    {
+        stop_logging(stop_reason::manual_stop);
+        const auto previous_params = set_logging_params({ .logging_level = log_level::warn });
+
+        CHECK_FALSE(is_enabled(log_level::debug));
+        CHECK(is_enabled(log_level::warn));
+        CHECK(is_enabled(log_level::critical));
+
+        // The backtrace needs all the records
+        enable_backtrace(10);
+        CHECK(is_enabled(log_level::trace));
+        disable_backtrace();
+        CHECK_FALSE(is_enabled(log_level::info));
+
+        set_log_level(log_level::off);
+        CHECK_FALSE(is_enabled(log_level::critical));
+        set_log_level(log_level::all);
+        CHECK(is_enabled(log_level::trace));
+
+        // Disabled records are not even built
+        set_log_level(log_level::err);
+        bool evaluated = false;
+        const auto side_effect = [&]
+        {
+            evaluated = true;
+            return "side effect";
+        };
+        LOG_DEBUG << side_effect();
+        CHECK_FALSE(evaluated);
+
+        set_logging_params(previous_params);
+    }
+
 }
@@ -1,7 +1,12 @@
+#include <chrono>
+#include <fstream>
+
 #include <catch2/catch_all.hpp>
 
 #include "mamba/core/activation.hpp"
 #include "mamba/core/context.hpp"
+#include "mamba/core/util.hpp"
+#include "mamba/util/string.hpp"
 
 #include "mambatests.hpp"
 
@@ -34,5 +39,107 @@ namespace mamba
             const fs::u8path& alt_folder = "/home/user/some/env";
             REQUIRE(a.get_default_env(alt_folder) == alt_folder);
         }
+
+        TEST_CASE("load_activation_plan")
+        {
+            const auto tmp_dir = TemporaryDirectory();
+            const auto prefix = tmp_dir.path() / "prefix";
+            const auto cache_dir = tmp_dir.path() / "cache";
+            const auto write_file = [](const fs::u8path& path, std::string_view content)
+            {
+                fs::create_directories(path.parent_path());
+                auto out = std::ofstream(path.std_path());
+                out << content;
+            };
+            const auto age = [&](std::initializer_list<fs::u8path> paths)
+            {
+                // Recently modified inputs are not cached
+                const auto past = fs::file_time_type::clock::now() - std::chrono::hours(1);
+                for (const auto& p : paths)
+                {
+                    fs::last_write_time(prefix / p, past);
+                }
+            };
+
+            write_file(prefix / "conda-meta" / "state", R"({"env_vars": {"foo": "state"}})");
+            write_file(prefix / "etc/conda/env_vars.d/pkg.json", R"({"foo": "pkg", "bar": "1"})");
+            write_file(prefix / "etc/conda/activate.d/b.sh", "");
+            write_file(prefix / "etc/conda/activate.d/a.sh", "");
+            write_file(prefix / "etc/conda/activate.d/a.bat", "");
+            write_file(prefix / "etc/conda/deactivate.d/a.sh", "");
+            write_file(prefix / "etc/conda/deactivate.d/b.sh", "");
+            const auto inputs = {
+                fs::u8path("conda-meta/state"),       fs::u8path("etc/conda/env_vars.d/pkg.json"),
+                fs::u8path("etc/conda/env_vars.d"),   fs::u8path("etc/conda/activate.d"),
+                fs::u8path("etc/conda/deactivate.d"),
+            };
+            age(inputs);
+
+            const auto plan = load_activation_plan(prefix, cache_dir);
+            using env_vars = std::vector<std::pair<std::string, std::string>>;
+            REQUIRE(plan.env_vars == env_vars{ { "FOO", "state" }, { "BAR", "1" } });
+            const auto activate_d = prefix / "etc/conda/activate.d";
+            REQUIRE(
+                plan.activate_scripts
+                == std::vector{ activate_d / "a.bat", activate_d / "a.sh", activate_d / "b.sh" }
+            );
+            const auto deactivate_d = prefix / "etc/conda/deactivate.d";
+            REQUIRE(
+                plan.deactivate_scripts
+                == std::vector{ deactivate_d / "b.sh", deactivate_d / "a.sh" }
+            );
+            const auto cache_files = std::distance(
+                fs::directory_iterator(cache_dir),
+                fs::directory_iterator()
+            );
+            REQUIRE(cache_files == 1);
+
+            SECTION("Cached plan")
+            {
+                const auto cached = load_activation_plan(prefix, cache_dir);
+                REQUIRE(cached.env_vars == plan.env_vars);
+                REQUIRE(cached.env_vars_files == plan.env_vars_files);
+                REQUIRE(cached.activate_scripts == plan.activate_scripts);
+                REQUIRE(cached.deactivate_scripts == plan.deactivate_scripts);
+            }
+
+            SECTION("Cached warnings")
+            {
+                write_file(prefix / "etc/conda/env_vars.d/bad.json", "{");
+                age(inputs);
+                fs::last_write_time(
+                    prefix / "etc/conda/env_vars.d/bad.json",
+                    fs::file_time_type::clock::now() - std::chrono::hours(1)
+                );
+
+                const auto updated = load_activation_plan(prefix, cache_dir);
+                REQUIRE(updated.warnings.size() == 1);
+                REQUIRE(util::starts_with(updated.warnings.front(), "Could not read JSON at "));
+                const auto cached = load_activation_plan(prefix, cache_dir);
+                REQUIRE(cached.warnings == updated.warnings);
+            }
+
+            SECTION("Invalidated plan")
+            {
+                write_file(prefix / "etc/conda/env_vars.d/pkg.json", R"({"bar": "22"})");
+                write_file(prefix / "etc/conda/activate.d/c.sh", "");
+                age(inputs);
+
+                const auto updated = load_activation_plan(prefix, cache_dir);
+                REQUIRE(updated.env_vars == env_vars{ { "BAR", "22" }, { "FOO", "state" } });
+                REQUIRE(updated.activate_scripts.size() == 4);
+            }
+
+            SECTION("Activator")
+            {
+                auto ctx = Context();
+                auto activator = PosixActivator(ctx);
+                REQUIRE(
+                    activator.get_activate_scripts(prefix)
+                    == std::vector{ activate_d / "a.sh", activate_d / "b.sh" }
+                );
+                REQUIRE(activator.get_environment_vars(prefix) == plan.env_vars);
+            }
+        }
     }
 }  // namespace mamba
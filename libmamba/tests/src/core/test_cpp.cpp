@@ -5,6 +5,7 @@
 // The full license is in the file LICENSE, distributed with this software.
 
 #include <chrono>
+#include <regex>
 #include <sstream>
 #include <tuple>
 
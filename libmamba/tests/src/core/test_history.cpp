@@ -24,6 +24,7 @@
 #include "mamba/core/execution.hpp"
 #include "mamba/core/history.hpp"
 #include "mamba/core/prefix_data.hpp"
+#include "mamba/core/util.hpp"
 
 #include "mambatests.hpp"
 
@@ -172,6 +173,125 @@ namespace mamba
             REQUIRE(installed_pkg_diff.find("xtl")->second.version == "0.8.0");
         }
 
+        TEST_CASE("History index")
+        {
+            auto channel_context = ChannelContext::make_conda_compatible(mambatests::context());
+            auto tmp_dir = TemporaryDirectory();
+            fs::create_directories(tmp_dir.path() / "conda-meta");
+            History history_instance(tmp_dir.path(), channel_context);
+            const auto index_path = History::index_file_path(history_instance.m_history_file_path);
+
+            auto make_request = [](std::string date, std::string link, std::string unlink)
+            {
+                History::UserRequest req;
+                req.date = std::move(date);
+                req.cmd = "micromamba install";
+                req.conda_version = "3.8.0";
+                if (!link.empty())
+                {
+                    req.link_dists.push_back(std::move(link));
+                    req.update.push_back("xtl");
+                }
+                if (!unlink.empty())
+                {
+                    req.unlink_dists.push_back(std::move(unlink));
+                }
+                return req;
+            };
+
+            history_instance.add_entry(
+                make_request("2024-01-01 00:00:00", "conda-forge/linux-64::xtl-0.7.2-h1_0", "")
+            );
+            history_instance.add_entry(make_request("2024-01-02 00:00:00", "", ""));
+            history_instance.add_entry(make_request(
+                "2024-01-03 00:00:00",
+                "conda-forge/linux-64::xtl-0.8.0-h1_0",
+                "conda-forge/linux-64::xtl-0.7.2-h1_0"
+            ));
+            REQUIRE(fs::exists(index_path));
+
+            auto check_tail = [&](std::size_t revision)
+            {
+                const auto all = history_instance.get_user_requests();
+                const auto after = history_instance.get_user_requests_after(revision);
+                auto first = std::find_if(
+                    all.cbegin(),
+                    all.cend(),
+                    [&](const auto& req)
+                    { return !req.link_dists.empty() && (req.revision_num > revision); }
+                );
+                REQUIRE(static_cast<std::size_t>(std::distance(first, all.cend())) == after.size());
+                for (const auto& req : after)
+                {
+                    CHECK(req.date == first->date);
+                    CHECK(req.revision_num == first->revision_num);
+                    CHECK(req.link_dists == first->link_dists);
+                    CHECK(req.unlink_dists == first->unlink_dists);
+                    ++first;
+                }
+            };
+
+            SECTION("Revisions are read from the index")
+            {
+                const auto after = history_instance.get_user_requests_after(0);
+                REQUIRE(after.size() == 1);
+                CHECK(after.front().date == "2024-01-03 00:00:00");
+                CHECK(after.front().revision_num == 1);
+                CHECK(after.front().unlink_dists.size() == 1);
+                CHECK(history_instance.get_user_requests_after(1).empty());
+                check_tail(0);
+            }
+
+            SECTION("Entries appended by other tools are indexed")
+            {
+                {
+                    std::ofstream out(
+                        history_instance.m_history_file_path.std_path(),
+                        std::ios::app
+                    );
+                    out << "==>  2024-01-04 00:00:00  <==\n"
+                        << "# cmd: conda install wheel\n"
+                        << "+conda-forge/noarch::wheel-0.40.0-pyhd8ed1ab_0\n"
+                        << "# update specs: [\"wheel\"]\n";
+                }
+                const auto after = history_instance.get_user_requests_after(1);
+                REQUIRE(after.size() == 1);
+                CHECK(after.front().date == "2024-01-04 00:00:00");
+                CHECK(after.front().revision_num == 2);
+                CHECK(after.front().update == std::vector<std::string>{ "wheel" });
+                check_tail(0);
+                CHECK(history_instance.get_requested_specs_map().contains("wheel"));
+
+                // The index was brought up to date and is appended to again
+                history_instance.add_entry(
+                    make_request("2024-01-05 00:00:00", "conda-forge/linux-64::zlib-1.3-h1_0", "")
+                );
+                check_tail(1);
+                CHECK(history_instance.get_user_requests_after(2).front().revision_num == 3);
+            }
+
+            SECTION("A rewritten history is reindexed")
+            {
+                {
+                    std::ofstream out(history_instance.m_history_file_path.std_path());
+                    out << "==> 2025-01-01 00:00:00 <==\n"
+                        << "+conda-forge/linux-64::xtl-0.8.0-h1_0\n";
+                }
+                CHECK(history_instance.get_user_requests_after(0).empty());
+                check_tail(0);
+            }
+
+            SECTION("An invalid index is rebuilt")
+            {
+                {
+                    std::ofstream out(index_path.std_path());
+                    out << "garbage\n";
+                }
+                check_tail(0);
+                check_tail(1);
+            }
+        }
+
 #ifndef _WIN32
         TEST_CASE("parse_segfault")
         {
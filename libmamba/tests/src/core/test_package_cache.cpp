@@ -4,6 +4,7 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <chrono>
 #include <fstream>
 
 #include <catch2/catch_all.hpp>
@@ -105,6 +106,69 @@ namespace mamba
             REQUIRE(cache.get_extracted_dir_path(pkg_info) == pkgs_dir);
         }
 
+        SECTION("Validated extracted directories are persisted")
+        {
+            const auto record = hierarchical_dir / "info" / "repodata_record.json";
+            write_repodata_record(record, pkg_info);
+            const auto index = pkgs_dir / "cache"
+                               / PackageCacheData::extracted_dirs_index_filename;
+
+            {
+                MultiPackageCache cache({ pkgs_dir }, params);
+                cache.validate_extracted_dirs({ pkg_info });
+                REQUIRE(cache.get_extracted_dir_path(pkg_info) == pkgs_dir / rel_path);
+            }
+            REQUIRE(fs::exists(index));
+            const auto j = nlohmann::json::parse(open_ifstream(index));
+            CHECK(j.at("dirs").contains((rel_path / "test-pkg-1.0.0-h123456_0").generic_string()));
+
+            // Rewrite the record with the same size, but a checksum that does not match
+            const auto mtime = fs::last_write_time(record);
+            auto other = pkg_info;
+            other.md5 = "00000000000000000000000000000000";
+            write_repodata_record(record, other);
+
+            SECTION("Verdict is reused while the record is unchanged")
+            {
+                fs::last_write_time(record, mtime);
+                MultiPackageCache cache({ pkgs_dir }, params);
+                cache.validate_extracted_dirs({ pkg_info });
+                CHECK(cache.get_extracted_dir_path(pkg_info) == pkgs_dir / rel_path);
+            }
+
+            SECTION("Verdict is invalidated by a new record")
+            {
+                fs::last_write_time(record, mtime + std::chrono::seconds(10));
+                MultiPackageCache cache({ pkgs_dir }, params);
+                cache.validate_extracted_dirs({ pkg_info });
+                CHECK(cache.get_extracted_dir_path(pkg_info).empty());
+            }
+        }
+
+        SECTION("Verdicts are not reused with extra safety checks")
+        {
+            const auto record = hierarchical_dir / "info" / "repodata_record.json";
+            write_repodata_record(record, pkg_info);
+            auto extra_params = params;
+            extra_params.extra_safety_checks = true;
+            {
+                MultiPackageCache cache({ pkgs_dir }, extra_params);
+                cache.validate_extracted_dirs({ pkg_info });
+                REQUIRE(cache.get_extracted_dir_path(pkg_info) == pkgs_dir / rel_path);
+            }
+
+            // Modified after the verdict was saved, with the same record stamps
+            const auto mtime = fs::last_write_time(record);
+            auto other = pkg_info;
+            other.md5 = "00000000000000000000000000000000";
+            write_repodata_record(record, other);
+            fs::last_write_time(record, mtime);
+
+            MultiPackageCache cache({ pkgs_dir }, extra_params);
+            cache.validate_extracted_dirs({ pkg_info });
+            CHECK(cache.get_extracted_dir_path(pkg_info).empty());
+        }
+
         SECTION("Tarball: Find in flat cache")
         {
             write_empty_file(pkgs_dir / pkg_info.filename);
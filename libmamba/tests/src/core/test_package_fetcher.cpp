@@ -4,6 +4,7 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <cstdio>
 #include <fstream>
 #include <stdexcept>
 
@@ -1300,4 +1301,29 @@ namespace
         REQUIRE(repodata_record.contains("size"));
         CHECK(repodata_record["size"] == tarball_size);
     }
+
+    TEST_CASE("extract_archive from a stream")
+    {
+        TemporaryDirectory temp_dir;
+        const auto src_dir = temp_dir.path() / "src";
+        fs::create_directories(src_dir / "info");
+        {
+            std::ofstream out((src_dir / "info" / "index.json").std_path());
+            out << R"({"name": "test-pkg"})";
+        }
+        const auto tarball_path = temp_dir.path() / "test-pkg.tar.bz2";
+        create_archive(src_dir, tarball_path, compression_algorithm::bzip2, 1, 1, nullptr);
+
+        // Read sequentially, as stdin would be
+        std::FILE* stream = std::fopen(tarball_path.string().c_str(), "rb");
+        REQUIRE(stream != nullptr);
+        const auto dest_dir = temp_dir.path() / "dest";
+        extract_archive(stream, dest_dir, ExtractOptions{});
+        std::fclose(stream);
+
+        std::ifstream index_file((dest_dir / "info" / "index.json").std_path());
+        nlohmann::json index;
+        index_file >> index;
+        CHECK(index["name"] == "test-pkg");
+    }
 }
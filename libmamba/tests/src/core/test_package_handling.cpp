@@ -0,0 +1,146 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_all.hpp>
+
+#include "mamba/core/package_handling.hpp"
+#include "mamba/core/util.hpp"
+#include "mamba/fs/filesystem.hpp"
+
+using namespace mamba;
+
+namespace
+{
+    auto make_package_dir(const fs::u8path& dir, const std::string& name) -> fs::u8path
+    {
+        const auto pkg_dir = dir / name;
+        fs::create_directories(pkg_dir / "info");
+        fs::create_directories(pkg_dir / "lib");
+        {
+            std::ofstream out((pkg_dir / "info" / "index.json").std_path());
+            out << R"({"name": ")" << name << R"("})";
+        }
+        {
+            std::ofstream out((pkg_dir / "lib" / "data.txt").std_path());
+            for (int i = 0; i < 1000; ++i)
+            {
+                out << name << " " << i << "\n";
+            }
+        }
+        return pkg_dir;
+    }
+
+    TEST_CASE("transmute_target", "[mamba::core][mamba::core::package_handling]")
+    {
+        CHECK(transmute_target("/pkgs/foo-1.0-0.tar.bz2") == "/pkgs/foo-1.0-0.conda");
+        CHECK(transmute_target("/pkgs/foo-1.0-0.conda") == "/pkgs/foo-1.0-0.tar.bz2");
+        CHECK_THROWS(transmute_target("/pkgs/foo-1.0-0.zip"));
+    }
+
+    TEST_CASE("balance_compression_threads", "[mamba::core][mamba::core::package_handling]")
+    {
+        using threads = std::pair<std::size_t, int>;
+        CHECK(balance_compression_threads(100, 8) == threads{ 8, 1 });
+        CHECK(balance_compression_threads(2, 8) == threads{ 2, 4 });
+        CHECK(balance_compression_threads(3, 8) == threads{ 3, 2 });
+        CHECK(balance_compression_threads(1, 8) == threads{ 1, 8 });
+        CHECK(balance_compression_threads(0, 8) == threads{ 1, 8 });
+        CHECK(balance_compression_threads(5, 0) == threads{ 1, 1 });
+    }
+
+    TEST_CASE("transmute tar.bz2 to conda", "[mamba::core][mamba::core::package_handling]")
+    {
+        TemporaryDirectory temp_dir;
+        const auto pkg_dir = make_package_dir(temp_dir.path() / "src", "foo-1.0-0");
+        const auto pkg_file = temp_dir.path() / "foo-1.0-0.tar.bz2";
+        const auto target = temp_dir.path() / "foo-1.0-0.conda";
+        create_package(pkg_dir, pkg_file, 9, 1);
+
+        REQUIRE(transmute(pkg_file, target, 3, 1, ExtractOptions{}));
+        // Only the package and its conversion are left
+        CHECK(
+            std::distance(fs::directory_iterator(temp_dir.path()), fs::directory_iterator())
+            == 3
+        );
+
+        SECTION("Info only")
+        {
+            const auto dest_dir = temp_dir.path() / "info_only";
+            extract_conda(target, dest_dir, ExtractOptions{}, { "info" });
+            CHECK(fs::exists(dest_dir / "info" / "index.json"));
+            CHECK_FALSE(fs::exists(dest_dir / "lib"));
+        }
+
+        SECTION("Full package")
+        {
+            const auto dest_dir = temp_dir.path() / "dest";
+            extract_conda(target, dest_dir, ExtractOptions{});
+            CHECK(
+                fs::file_size(dest_dir / "info" / "index.json")
+                == fs::file_size(pkg_dir / "info" / "index.json")
+            );
+            CHECK(
+                fs::file_size(dest_dir / "lib" / "data.txt")
+                == fs::file_size(pkg_dir / "lib" / "data.txt")
+            );
+        }
+    }
+
+    TEST_CASE("transmute_batch", "[mamba::core][mamba::core::package_handling]")
+    {
+        TemporaryDirectory temp_dir;
+        std::vector<fs::u8path> pkg_files;
+        for (const auto* name : { "foo-1.0-0", "bar-1.0-0" })
+        {
+            const auto pkg_dir = make_package_dir(temp_dir.path() / "src", name);
+            pkg_files.push_back(temp_dir.path() / (std::string(name) + ".tar.bz2"));
+            create_package(pkg_dir, pkg_files.back(), 9, 1);
+        }
+        pkg_files.push_back(temp_dir.path() / "missing-1.0-0.tar.bz2");
+
+        // A single thread converts in process
+        const auto result = transmute_batch(pkg_files, -1, 0, 1, ExtractOptions{});
+
+        CHECK(result.converted == 2);
+        REQUIRE(result.failures.size() == 1);
+        CHECK(result.failures.front().first == pkg_files.back());
+        CHECK(result.input_bytes > 0);
+        CHECK(result.output_bytes > 0);
+
+        SECTION("Concurrent streaming conversions")
+        {
+            fs::remove(temp_dir.path() / "foo-1.0-0.conda");
+            fs::remove(temp_dir.path() / "bar-1.0-0.conda");
+            pkg_files.pop_back();
+            const auto concurrent = transmute_batch(pkg_files, -1, 0, 2, ExtractOptions{});
+            CHECK(concurrent.converted == 2);
+            CHECK(concurrent.failures.empty());
+        }
+
+        SECTION("Explicit compression threads")
+        {
+            fs::remove(temp_dir.path() / "foo-1.0-0.conda");
+            fs::remove(temp_dir.path() / "bar-1.0-0.conda");
+            pkg_files.pop_back();
+            const auto explicit_threads = transmute_batch(pkg_files, -1, 4, 2, ExtractOptions{});
+            CHECK(explicit_threads.converted == 2);
+            CHECK(explicit_threads.failures.empty());
+        }
+
+        const auto dest_dir = temp_dir.path() / "dest";
+        extract_conda(temp_dir.path() / "foo-1.0-0.conda", dest_dir, ExtractOptions{});
+        CHECK(fs::exists(dest_dir / "info" / "index.json"));
+        CHECK(
+            fs::file_size(dest_dir / "lib" / "data.txt")
+            == fs::file_size(temp_dir.path() / "src" / "foo-1.0-0" / "lib" / "data.txt")
+        );
+    }
+}
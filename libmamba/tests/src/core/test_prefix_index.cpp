@@ -0,0 +1,126 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <algorithm>
+#include <string>
+
+#include <catch2/catch_all.hpp>
+
+#include "mamba/core/util.hpp"
+#include "mamba/fs/filesystem.hpp"
+
+#include "core/prefix_index.hpp"
+
+namespace mamba
+{
+    namespace
+    {
+        void write_record(
+            const fs::u8path& conda_meta,
+            const std::string& name,
+            const std::string& version
+        )
+        {
+            auto out = open_ofstream(conda_meta / (name + "-" + version + "-0.json"));
+            out << R"({"name": ")" << name << R"(", "version": ")" << version
+                << R"(", "build": "0", "build_number": 0, "depends": ["python"],)"
+                << R"( "files": ["lib/a", "lib/b"], "paths_data": {"paths": []}})";
+        }
+
+        auto versions(const PrefixIndex& index) -> std::vector<std::string>
+        {
+            auto out = std::vector<std::string>();
+            for (const auto& entry : index.entries())
+            {
+                out.push_back(entry.record.name + "=" + entry.record.version);
+            }
+            std::ranges::sort(out);
+            return out;
+        }
+
+        TEST_CASE("read_conda_meta_record")
+        {
+            auto tmp_dir = TemporaryDirectory();
+            write_record(tmp_dir.path(), "foo", "1.0");
+
+            const auto record = read_conda_meta_record(tmp_dir.path() / "foo-1.0-0.json");
+            CHECK(record.name == "foo");
+            CHECK(record.version == "1.0");
+            CHECK(record.build_string == "0");
+            CHECK(record.dependencies == std::vector<std::string>{ "python" });
+        }
+
+        TEST_CASE("PrefixIndex")
+        {
+            auto tmp_dir = TemporaryDirectory();
+            const auto& conda_meta = tmp_dir.path();
+            write_record(conda_meta, "foo", "1.0");
+            write_record(conda_meta, "bar", "2.0");
+            {
+                // Not a record
+                auto out = open_ofstream(conda_meta / "history");
+                out << "==> 2026-01-01 00:00:00 <==\n";
+            }
+
+            const auto first = PrefixIndex::load(conda_meta);
+            CHECK(first.is_stale());
+            CHECK(versions(first) == std::vector<std::string>{ "bar=2.0", "foo=1.0" });
+            first.write(conda_meta);
+            REQUIRE(fs::exists(conda_meta / std::string(PrefixIndex::filename)));
+
+            SECTION("Up to date")
+            {
+                const auto index = PrefixIndex::load(conda_meta);
+                CHECK_FALSE(index.is_stale());
+                CHECK(versions(index) == versions(first));
+            }
+
+            SECTION("New record")
+            {
+                write_record(conda_meta, "baz", "3.0");
+                const auto index = PrefixIndex::load(conda_meta);
+                CHECK(index.is_stale());
+                CHECK(
+                    versions(index) == std::vector<std::string>{ "bar=2.0", "baz=3.0", "foo=1.0" }
+                );
+            }
+
+            SECTION("Removed record")
+            {
+                fs::remove(conda_meta / "bar-2.0-0.json");
+                const auto index = PrefixIndex::load(conda_meta);
+                CHECK(index.is_stale());
+                CHECK(versions(index) == std::vector<std::string>{ "foo=1.0" });
+            }
+
+            SECTION("Refresh")
+            {
+                write_record(conda_meta, "baz", "3.0");
+                PrefixIndex::refresh(conda_meta);
+                const auto index = PrefixIndex::load(conda_meta);
+                CHECK_FALSE(index.is_stale());
+                CHECK(index.entries().size() == 3);
+            }
+
+            SECTION("Unwritable directory")
+            {
+                CHECK_THROWS_AS(first.write(conda_meta / "missing"), std::runtime_error);
+                CHECK_FALSE(fs::exists(conda_meta / "missing"));
+            }
+
+            SECTION("Corrupted index")
+            {
+                {
+                    auto out = open_ofstream(conda_meta / std::string(PrefixIndex::filename));
+                    out << "{ not json";
+                }
+                const auto index = PrefixIndex::load(conda_meta);
+                CHECK(index.is_stale());
+                CHECK(versions(index) == versions(first));
+            }
+        }
+    }
+}
@@ -0,0 +1,169 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_all.hpp>
+
+#include "mamba/core/util.hpp"
+#include "mamba/util/cryptography.hpp"
+
+#include "core/prefix_replacement.hpp"
+
+using namespace std::string_literals;
+
+namespace mamba
+{
+    namespace
+    {
+        constexpr std::string_view placeholder = "/opt/placeholder_placehold";
+
+        auto binary_replaced(std::string_view data, std::string_view new_prefix) -> std::string
+        {
+            std::ostringstream out;
+            write_binary_prefix_replaced(
+                out,
+                data,
+                placeholder,
+                new_prefix,
+                find_prefix_placeholder(data, placeholder)
+            );
+            return out.str();
+        }
+
+        TEST_CASE("find_prefix_placeholder")
+        {
+            CHECK(find_prefix_placeholder("", placeholder).empty());
+            CHECK(find_prefix_placeholder("no placeholder here", placeholder).empty());
+            CHECK(find_prefix_placeholder("abc", "").empty());
+            CHECK(find_prefix_placeholder("aaaa", "aa") == std::vector<std::size_t>{ 0, 2 });
+
+            const auto data = "ab/opt/placeholder_placehold:x/opt/placeholder_placehold"s;
+            CHECK(find_prefix_placeholder(data, placeholder) == std::vector<std::size_t>{ 2, 30 });
+        }
+
+        TEST_CASE("write_text_prefix_replaced")
+        {
+            const auto data = "#!/opt/placeholder_placehold/bin/python\nimport sys\n"
+                              "PATH=/opt/placeholder_placehold/lib:/opt/placeholder_placehold/x\n"s;
+            const auto expected = "#!/env/bin/python\nimport sys\nPATH=/env/lib:/env/x\n"s;
+            CHECK(replace_prefix_placeholder(data, placeholder, "/env") == expected);
+
+            CHECK(replace_prefix_placeholder("unchanged", placeholder, "/env") == "unchanged");
+        }
+
+        TEST_CASE("write_binary_prefix_replaced")
+        {
+            SECTION("Single occurrence")
+            {
+                const auto data = "ab\0/opt/placeholder_placehold/lib\0cd"s;
+                const auto out = binary_replaced(data, "/env");
+                CHECK(out.size() == data.size());
+                CHECK(out == "ab\0/env/lib"s + std::string(22, '\0') + "\0cd"s);
+            }
+
+            SECTION("Several occurrences in one string")
+            {
+                // The padding of all replacements goes at the end of the string
+                const auto data = "/opt/placeholder_placehold/a:/opt/placeholder_placehold/b\0z"s;
+                const auto out = binary_replaced(data, "/env");
+                CHECK(out.size() == data.size());
+                CHECK(out == "/env/a:/env/b"s + std::string(44, '\0') + "\0z"s);
+            }
+
+            SECTION("Unterminated string")
+            {
+                const auto data = "x/opt/placeholder_placehold/end"s;
+                const auto out = binary_replaced(data, "/env");
+                CHECK(out == "x/env/end"s + std::string(22, '\0'));
+            }
+
+            SECTION("Longer prefix")
+            {
+                const auto new_prefix = "/a/very/long/prefix/longer/than/the/placeholder"s;
+                const auto data = "/opt/placeholder_placehold/lib\0"s;
+                CHECK(binary_replaced(data, new_prefix) == new_prefix + "/lib\0"s);
+            }
+
+            SECTION("No occurrence")
+            {
+                const auto data = "\0\0binary\0data"s;
+                CHECK(binary_replaced(data, "/env") == data);
+            }
+        }
+
+        TEST_CASE("Sha256OutputBuffer")
+        {
+            const auto data = "#!/opt/placeholder_placehold/bin/python\n"s;
+
+            std::ostringstream sink;
+            Sha256OutputBuffer hashing_buffer(sink.rdbuf());
+            std::ostream out(&hashing_buffer);
+            out << replace_prefix_placeholder(data, placeholder, "/env");
+            out.put('x');
+            out.flush();
+
+            CHECK(sink.str() == "#!/env/bin/python\nx");
+            CHECK(hashing_buffer.hex_digest() == util::Sha256Hasher().str_hex_str(sink.str()));
+        }
+
+        TEST_CASE("PrefixPlaceholderIndex")
+        {
+            auto tmp_dir = TemporaryDirectory();
+            const auto& pkg_dir = tmp_dir.path();
+            fs::create_directories(pkg_dir / "info");
+            fs::create_directories(pkg_dir / "bin");
+
+            const auto script = "#!/opt/placeholder_placehold/bin/python\nprint(1)\n"s;
+            {
+                auto out = open_ofstream(pkg_dir / "bin" / "script");
+                out << script;
+            }
+
+            auto script_path = PathData{};
+            script_path.path = "bin/script";
+            script_path.prefix_placeholder = placeholder;
+            script_path.file_mode = FileMode::TEXT;
+            auto plain_path = PathData{};
+            plain_path.path = "bin/plain";
+
+            const auto index = PrefixPlaceholderIndex::build(pkg_dir, { script_path, plain_path });
+            REQUIRE(index.size() == 1);
+            index.write(pkg_dir);
+
+            const auto read_index = PrefixPlaceholderIndex::read(pkg_dir);
+            REQUIRE(read_index.size() == 1);
+
+            SECTION("Valid entry")
+            {
+                const auto* offsets = read_index.find("bin/script", placeholder, script);
+                REQUIRE(offsets != nullptr);
+                CHECK(*offsets == std::vector<std::size_t>{ 2 });
+            }
+
+            SECTION("Missing entry")
+            {
+                CHECK(read_index.find("bin/plain", placeholder, "") == nullptr);
+            }
+
+            SECTION("Stale entry")
+            {
+                CHECK(read_index.find("bin/script", "/other/placeholder", script) == nullptr);
+                CHECK(read_index.find("bin/script", placeholder, script + "x") == nullptr);
+                auto modified = script;
+                modified[3] = 'x';
+                CHECK(read_index.find("bin/script", placeholder, modified) == nullptr);
+            }
+
+            SECTION("No index")
+            {
+                CHECK(PrefixPlaceholderIndex::read(pkg_dir / "bin").empty());
+            }
+        }
+    }
+}
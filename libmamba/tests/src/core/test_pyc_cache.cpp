@@ -0,0 +1,159 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include <catch2/catch_all.hpp>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+#include "mamba/core/util.hpp"
+#include "mamba/fs/filesystem.hpp"
+#include "mamba/util/string.hpp"
+
+#include "core/pyc_cache.hpp"
+
+namespace mamba
+{
+    namespace
+    {
+        auto le32(std::uint32_t value) -> std::string
+        {
+            std::string out(4, '\0');
+            for (std::size_t i = 0; i < 4; ++i)
+            {
+                out[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+            }
+            return out;
+        }
+
+        void write_file(const fs::u8path& path, const std::string& content)
+        {
+            fs::create_directories(path.parent_path());
+            auto out = open_ofstream(path);
+            out << content;
+        }
+
+        auto make_pyc(std::uint32_t flags, std::uint32_t mtime, std::uint32_t size) -> std::string
+        {
+            return util::concat("\x55\x0d\x0d\x0a", le32(flags), le32(mtime), le32(size), "code");
+        }
+
+        const std::string source_sha256 = "ab5ebe0fbdc88e8d3a1a6f6a63e3e8e1"
+                                          "bca8d7d7e6b1b7ec1ba10a3d0f0d7f11";
+        const std::string source = "print('hello')\n";
+
+        TEST_CASE("pyc_cache_tag")
+        {
+            REQUIRE(pyc_cache_tag("3.12") == "cpython-312");
+            REQUIRE(pyc_cache_tag("3.13t") == "cpython-313");
+            REQUIRE(pyc_cache_tag("2.7") == "");
+            REQUIRE(pyc_cache_tag("") == "");
+        }
+
+        TEST_CASE("PycCache")
+        {
+            const auto tmp_dir = TemporaryDirectory();
+            const auto cache = PycCache(tmp_dir.path() / "cache" / "pyc");
+            const auto key = PycCache::Key{ source_sha256, "cpython-312" };
+
+            const auto env_a = tmp_dir.path() / "env_a";
+            const auto env_b = tmp_dir.path() / "env_b";
+            const auto py_rel = fs::u8path("lib") / "site-packages" / "mod.py";
+            const auto pyc_rel = fs::u8path("lib") / "site-packages" / "__pycache__"
+                                 / "mod.cpython-312.pyc";
+            write_file(env_a / py_rel, source);
+            write_file(env_b / py_rel, source);
+
+            SECTION("Entry layout")
+            {
+                REQUIRE(
+                    cache.entry_path(key)
+                    == cache.path() / "cpython-312" / "opt-0" / "ab" / (source_sha256 + ".pyc")
+                );
+            }
+
+            SECTION("Missing entry")
+            {
+                REQUIRE_FALSE(cache.fetch(key, env_b / py_rel, env_b / pyc_rel));
+                REQUIRE_FALSE(fs::exists(env_b / pyc_rel));
+            }
+
+            SECTION("Missing compiled file is not stored")
+            {
+                REQUIRE_FALSE(cache.store(key, env_a / py_rel, env_a / pyc_rel));
+                REQUIRE_FALSE(fs::exists(cache.entry_path(key)));
+            }
+
+            SECTION("Hash based pyc roundtrip")
+            {
+                write_file(env_a / pyc_rel, make_pyc(0b11, 0, 0));
+                REQUIRE(cache.store(key, env_a / py_rel, env_a / pyc_rel));
+                REQUIRE(fs::exists(cache.entry_path(key)));
+                // Storing twice is fine
+                REQUIRE(cache.store(key, env_a / py_rel, env_a / pyc_rel));
+
+                REQUIRE(cache.fetch(key, env_b / py_rel, env_b / pyc_rel));
+                REQUIRE(read_contents(env_b / pyc_rel) == make_pyc(0b11, 0, 0));
+
+                SECTION("Other keys do not match")
+                {
+                    auto other_key = key;
+                    other_key.cache_tag = "cpython-313";
+                    REQUIRE_FALSE(cache.fetch(other_key, env_b / py_rel, env_b / pyc_rel));
+                    other_key = key;
+                    other_key.optimization = 1;
+                    REQUIRE_FALSE(cache.fetch(other_key, env_b / py_rel, env_b / pyc_rel));
+                }
+            }
+
+            SECTION("Existing entry is replaced")
+            {
+                write_file(cache.entry_path(key), "stale");
+                write_file(env_a / pyc_rel, make_pyc(0b11, 0, 0));
+                REQUIRE(cache.store(key, env_a / py_rel, env_a / pyc_rel));
+                REQUIRE(read_contents(cache.entry_path(key)) == make_pyc(0b11, 0, 0));
+            }
+
+            SECTION("Stale timestamp pyc is rejected")
+            {
+                const auto size = static_cast<std::uint32_t>(source.size());
+                write_file(env_a / pyc_rel, make_pyc(0, 1, size));
+                REQUIRE_FALSE(cache.store(key, env_a / py_rel, env_a / pyc_rel));
+                REQUIRE_FALSE(fs::exists(cache.entry_path(key)));
+            }
+
+#ifndef _WIN32
+            SECTION("Timestamp pyc roundtrip")
+            {
+                struct stat st;
+                REQUIRE(::stat((env_a / py_rel).string().c_str(), &st) == 0);
+                const auto mtime = static_cast<std::uint32_t>(st.st_mtime);
+                const auto size = static_cast<std::uint32_t>(source.size());
+                write_file(env_a / pyc_rel, make_pyc(0, mtime, size));
+                REQUIRE(cache.store(key, env_a / py_rel, env_a / pyc_rel));
+
+                // Same source content but a different mtime
+                fs::last_write_time(
+                    env_b / py_rel,
+                    fs::last_write_time(env_a / py_rel) - std::chrono::hours(1)
+                );
+                REQUIRE_FALSE(cache.fetch(key, env_b / py_rel, env_b / pyc_rel));
+
+                // Hard-linked source, as when linking from the package cache
+                fs::remove(env_b / py_rel);
+                fs::create_hard_link(env_a / py_rel, env_b / py_rel);
+                REQUIRE(cache.fetch(key, env_b / py_rel, env_b / pyc_rel));
+                REQUIRE(read_contents(env_b / pyc_rel) == make_pyc(0, mtime, size));
+            }
+#endif
+        }
+    }
+}
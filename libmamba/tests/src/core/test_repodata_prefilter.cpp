@@ -0,0 +1,219 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_all.hpp>
+
+#include "mamba/core/repodata_prefilter.hpp"
+#include "mamba/core/util.hpp"
+#include "mamba/solver/libsolv/database.hpp"
+#include "mamba/specs/package_info.hpp"
+#include "mamba/specs/version.hpp"
+
+using namespace mamba;
+
+namespace
+{
+    auto mkpkg(std::string name, std::string version, std::vector<std::string> deps = {})
+        -> specs::PackageInfo
+    {
+        auto out = specs::PackageInfo();
+        out.name = std::move(name);
+        out.version = std::move(version);
+        out.build_string = "0";
+        out.dependencies = std::move(deps);
+        return out;
+    }
+
+    auto linux_virtual_packages() -> std::vector<specs::PackageInfo>
+    {
+        return {
+            mkpkg("__unix", "0"),
+            mkpkg("__linux", "6.1"),
+            mkpkg("__glibc", "2.28"),
+        };
+    }
+
+    auto py(std::string_view str) -> specs::Version
+    {
+        return specs::Version::parse(str).value();
+    }
+
+    TEST_CASE("RepodataPrefilter inactive", "[mamba::core][mamba::core::RepodataPrefilter]")
+    {
+        const auto prefilter = RepodataPrefilter();
+        REQUIRE_FALSE(prefilter.is_active());
+        REQUIRE(prefilter.key().empty());
+        REQUIRE(prefilter.accepts_dependency("__cuda >=12"));
+        REQUIRE(prefilter.accepts_dependency("python >=3.12,<3.13"));
+    }
+
+    TEST_CASE("RepodataPrefilter virtual packages", "[mamba::core][mamba::core::RepodataPrefilter]")
+    {
+        const auto prefilter = RepodataPrefilter(std::nullopt, linux_virtual_packages());
+        REQUIRE(prefilter.is_active());
+
+        SECTION("Missing virtual packages")
+        {
+            REQUIRE_FALSE(prefilter.accepts_dependency("__cuda"));
+            REQUIRE_FALSE(prefilter.accepts_dependency("__cuda >=12"));
+            REQUIRE_FALSE(prefilter.accepts_dependency("__osx >=10.13"));
+            REQUIRE_FALSE(prefilter.accepts_dependency("__win"));
+        }
+
+        SECTION("Matching virtual packages")
+        {
+            REQUIRE(prefilter.accepts_dependency("__unix"));
+            REQUIRE(prefilter.accepts_dependency("__glibc >=2.17,<3.0.a0"));
+            REQUIRE(prefilter.accepts_dependency("__glibc >=2.28"));
+        }
+
+        SECTION("Non matching virtual packages")
+        {
+            REQUIRE_FALSE(prefilter.accepts_dependency("__glibc >=2.34"));
+            // Cached verdict
+            REQUIRE_FALSE(prefilter.accepts_dependency("__glibc >=2.34"));
+        }
+
+        SECTION("Other dependencies")
+        {
+            REQUIRE(prefilter.accepts_dependency("python >=3.12,<3.13"));
+            REQUIRE(prefilter.accepts_dependency("libfoo__bar"));
+            REQUIRE(prefilter.accepts_dependency("numpy >=1.0"));
+        }
+
+        SECTION("Depends")
+        {
+            const auto ok = std::array<std::string, 2>{ "__glibc >=2.17", "libzlib" };
+            REQUIRE(prefilter.accepts_depends(ok));
+            const auto ko = std::array<std::string, 2>{ "libzlib", "__cuda" };
+            REQUIRE_FALSE(prefilter.accepts_depends(ko));
+        }
+    }
+
+    TEST_CASE("RepodataPrefilter python minor", "[mamba::core][mamba::core::RepodataPrefilter]")
+    {
+        const auto prefilter = RepodataPrefilter(py("3.12"), std::nullopt);
+        REQUIRE(prefilter.is_active());
+        REQUIRE(prefilter.python_minor() == py("3.12"));
+
+        REQUIRE(prefilter.accepts_dependency("python >=3.12,<3.13.0a0"));
+        REQUIRE(prefilter.accepts_dependency("python_abi 3.11.* *_cp311"));
+        REQUIRE(prefilter.accepts_dependency("__cuda"));
+        REQUIRE_FALSE(prefilter.accepts_dependency("python >=3.11,<3.12.0a0"));
+
+        const auto other = prefilter.with_python_minor(py("3.11"));
+        REQUIRE(other.accepts_dependency("python >=3.11,<3.12.0a0"));
+        REQUIRE(other.key() != prefilter.key());
+    }
+
+    TEST_CASE("RepodataPrefilter filter_repo", "[mamba::core][mamba::core::RepodataPrefilter]")
+    {
+        auto db = solver::libsolv::Database({});
+        const auto pkgs = std::array{
+            mkpkg("foo", "1.0", { "python >=3.11,<3.12.0a0", "__glibc >=2.17" }),
+            mkpkg("foo", "1.0", { "python >=3.12,<3.13.0a0", "__glibc >=2.17" }),
+            mkpkg("foo", "1.1", { "python >=3.12,<3.13.0a0", "__glibc >=2.34" }),
+            mkpkg("bar", "1.0", { "__cuda >=12" }),
+            mkpkg("baz", "1.0"),
+        };
+        auto repo = db.add_repo_from_packages(pkgs, "repo");
+        REQUIRE(repo.package_count() == 5);
+        const auto fingerprint = db.fingerprint();
+
+        SECTION("Inactive prefilter")
+        {
+            REQUIRE(RepodataPrefilter().filter_repo(db, repo) == 0);
+            REQUIRE(repo.package_count() == 5);
+        }
+
+        SECTION("Active prefilter")
+        {
+            const auto prefilter = RepodataPrefilter(py("3.12"), linux_virtual_packages());
+            REQUIRE(prefilter.filter_repo(db, repo) == 3);
+            REQUIRE(repo.package_count() == 2);
+
+            auto versions = std::vector<std::string>();
+            db.for_each_package_in_repo(
+                repo,
+                [&](const specs::PackageInfo& pkg)
+                { versions.push_back(pkg.name + "=" + pkg.version); }
+            );
+            std::sort(versions.begin(), versions.end());
+            REQUIRE(versions == std::vector<std::string>{ "baz=1.0", "foo=1.0" });
+            // Repositories built from packages are identified by their content
+            REQUIRE(db.fingerprint() != fingerprint);
+        }
+    }
+
+    TEST_CASE(
+        "RepodataPrefilter filter_repo from repodata",
+        "[mamba::core][mamba::core::RepodataPrefilter]"
+    )
+    {
+        // The Mamba parser stores dependencies in namespaces that must be decoded
+        const auto matchspec_parser = GENERATE(
+            solver::libsolv::MatchSpecParser::Libsolv,
+            solver::libsolv::MatchSpecParser::Mamba
+        );
+
+        auto tmp_dir = TemporaryDirectory();
+        const auto repodata = tmp_dir.path() / "repodata.json";
+        std::ofstream out_file(repodata.std_path());
+        out_file << R"({
+            "packages": {
+                "foo-1.0-py311.tar.bz2": {
+                    "name": "foo",
+                    "version": "1.0",
+                    "build": "py311",
+                    "build_number": 0,
+                    "subdir": "linux-64",
+                    "depends": ["python >=3.11,<3.12.0a0", "__glibc >=2.17"]
+                },
+                "foo-1.0-py312.tar.bz2": {
+                    "name": "foo",
+                    "version": "1.0",
+                    "build": "py312",
+                    "build_number": 0,
+                    "subdir": "linux-64",
+                    "depends": ["python >=3.12,<3.13.0a0", "__glibc >=2.17"]
+                },
+                "bar-1.0-0.tar.bz2": {
+                    "name": "bar",
+                    "version": "1.0",
+                    "build": "0",
+                    "build_number": 0,
+                    "subdir": "linux-64",
+                    "depends": ["__cuda >=12"]
+                }
+            },
+            "packages.conda": {}
+        })";
+        out_file.close();
+
+        auto db = solver::libsolv::Database({}, { matchspec_parser });
+        auto repo = db.add_repo_from_repodata_json(
+            repodata,
+            "https://conda.anaconda.org/conda-forge/linux-64",
+            "conda-forge"
+        );
+        REQUIRE(repo.has_value());
+        REQUIRE(repo->package_count() == 3);
+
+        const auto prefilter = RepodataPrefilter(py("3.12"), linux_virtual_packages());
+        REQUIRE(prefilter.filter_repo(db, *repo) == 2);
+        REQUIRE(repo->package_count() == 1);
+        db.for_each_package_in_repo(
+            *repo,
+            [](const specs::PackageInfo& pkg) { REQUIRE(pkg.build_string == "py312"); }
+        );
+    }
+}
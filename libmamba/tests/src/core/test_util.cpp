@@ -4,6 +4,9 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <fstream>
+#include <string>
+
 #include <catch2/catch_all.hpp>
 
 #include "mamba/core/context.hpp"
@@ -110,6 +113,62 @@ namespace mamba
         }
     }
 
+    namespace
+    {
+        TEST_CASE("walk_directories")
+        {
+            const auto tmp_dir = TemporaryDirectory();
+            const auto root = tmp_dir.path();
+
+            auto write_file = [](const fs::u8path& path, std::size_t size)
+            {
+                fs::create_directories(path.parent_path());
+                std::ofstream out{ path.std_path(), std::ios::binary };
+                out << std::string(size, 'x');
+            };
+            write_file(root / "pkg-1.0-0" / "info" / "index.json", 10);
+            write_file(root / "pkg-1.0-0" / "lib" / "a" / "libpkg.so", 100);
+            write_file(root / "pkg-1.0-0" / "lib" / "b" / "libpkg.a", 1000);
+            write_file(root / "other-2.0-0" / "info" / "index.json", 20);
+            write_file(root / "pkg-1.0-0.conda", 5);
+            write_file(root / "cache" / "repodata.json", 50);
+            write_file(root / "cache" / "old.conda", 5);
+
+            const auto entries = mamba_fs::walk_directories(
+                { root, root / "does-not-exist" },
+                {
+                    /* .skip_directory= */
+                    [&](const fs::u8path& p) { return p == root / "cache"; },
+                    /* .collect_directory= */
+                    [](const fs::u8path& p) { return fs::exists(p / "info" / "index.json"); },
+                    /* .collect_file= */
+                    [](const fs::u8path& p) { return p.extension() == ".conda"; },
+                    /* .max_threads= */ 4,
+                }
+            );
+
+            REQUIRE(entries.size() == 3);
+            CHECK(entries[0].path == root / "other-2.0-0");
+            CHECK(entries[0].is_directory);
+            CHECK(entries[0].size == 20);
+            CHECK(entries[1].path == root / "pkg-1.0-0");
+            CHECK(entries[1].is_directory);
+            CHECK(entries[1].size == 1110);
+            CHECK(entries[2].path == root / "pkg-1.0-0.conda");
+            CHECK_FALSE(entries[2].is_directory);
+            CHECK(entries[2].size == 5);
+
+            const auto failed = mamba_fs::remove_all_parallel(
+                { root / "pkg-1.0-0", root / "other-2.0-0", root / "pkg-1.0-0.conda" }
+            );
+            CHECK(failed.empty());
+            CHECK_FALSE(fs::exists(root / "pkg-1.0-0"));
+            CHECK_FALSE(fs::exists(root / "other-2.0-0"));
+            CHECK_FALSE(fs::exists(root / "pkg-1.0-0.conda"));
+            CHECK(fs::exists(root / "cache" / "repodata.json"));
+        }
+    }
+
     namespace
     {
         TEST_CASE("proxy_match")
@@ -4,13 +4,17 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <fstream>
+
 #include <catch2/catch_all.hpp>
 
 #include "mamba/core/context.hpp"
+#include "mamba/core/util.hpp"
 #include "mamba/core/virtual_packages.hpp"
 #include "mamba/specs/version.hpp"
 #include "mamba/util/build.hpp"
 #include "mamba/util/environment.hpp"
+#include "mamba/util/string.hpp"
 
 #include "mambatests.hpp"
 
@@ -114,6 +118,47 @@ namespace mamba
                 REQUIRE(pkgs[1].build_string == "wasm32");
             }
 
+            TEST_CASE("cached_probe")
+            {
+                auto tmp_dir = TemporaryDirectory();
+                const auto file = tmp_dir.path() / "cache" / "probe.json";
+
+                REQUIRE_FALSE(detail::read_cached_probe(file, "abc").has_value());
+
+                detail::write_cached_probe(file, "abc", "12.4");
+                REQUIRE(detail::read_cached_probe(file, "abc") == "12.4");
+                REQUIRE_FALSE(detail::read_cached_probe(file, "def").has_value());
+
+                detail::write_cached_probe(file, "def", "");
+                REQUIRE(detail::read_cached_probe(file, "def") == "");
+                REQUIRE_FALSE(detail::read_cached_probe(file, "abc").has_value());
+
+                {
+                    auto f = std::ofstream(file.std_path());
+                    f << "{ not json";
+                }
+                REQUIRE_FALSE(detail::read_cached_probe(file, "def").has_value());
+            }
+
+            TEST_CASE("cuda_probe_fingerprint")
+            {
+                const auto fingerprint = detail::cuda_probe_fingerprint();
+                REQUIRE_FALSE(fingerprint.empty());
+                REQUIRE(detail::cuda_probe_fingerprint() == fingerprint);
+
+                const auto path = util::get_env("PATH");
+                util::set_env("PATH", util::concat(path.value_or(""), "-other"));
+                REQUIRE(detail::cuda_probe_fingerprint() != fingerprint);
+                if (path.has_value())
+                {
+                    util::set_env("PATH", path.value());
+                }
+                else
+                {
+                    util::unset_env("PATH");
+                }
+            }
+
             TEST_CASE("get_virtual_packages")
             {
                 util::set_env("CONDA_OVERRIDE_CUDA", "9.0");
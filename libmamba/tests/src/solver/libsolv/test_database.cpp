@@ -79,6 +79,81 @@ namespace
                 }
             }
 
+            SECTION("Clone")
+            {
+                db.set_installed_repo(repo1);
+                auto repo2 = db.add_repo_from_packages(std::array{ mkpkg("y", "1.0") }, "repo2");
+                db.set_repo_priority(repo2, { /* .priority= */ 2, /* .subpriority= */ 1 });
+
+                auto other = db.clone();
+                REQUIRE(other.repo_count() == 2);
+                REQUIRE(other.package_count() == 4);
+                REQUIRE(other.installed_repo().has_value());
+                REQUIRE(other.installed_repo()->name() == "repo1");
+                REQUIRE(other.fingerprint() == db.fingerprint());
+
+                std::size_t count = 0;
+                other.for_each_package_matching(
+                    specs::MatchSpec::parse("x>1.5").value(),
+                    [&](const auto& p)
+                    {
+                        count++;
+                        REQUIRE(p.version == "2.0");
+                    }
+                );
+                REQUIRE(count == 1);
+
+                // The copies are independent
+                db.remove_repo(repo2);
+                REQUIRE(db.repo_count() == 1);
+                REQUIRE(other.repo_count() == 2);
+            }
+
+            SECTION("Snapshot")
+            {
+                db.set_installed_repo(repo1);
+                auto repo2 = db.add_repo_from_packages(std::array{ mkpkg("y", "1.0") }, "repo2");
+                db.set_repo_priority(repo2, { /* .priority= */ 2, /* .subpriority= */ 1 });
+                auto virtual_repo = db.add_repo_from_packages(
+                    std::array<PackageInfo, 0>{},
+                    "virtual"
+                );
+                db.add_virtual_packages(virtual_repo, std::array{ mkpkg("__unix", "0") });
+
+                auto tmp_dir = TemporaryDirectory();
+                const auto snapshot = tmp_dir.path() / "snapshots" / "db.solvs";
+                REQUIRE(db.write_snapshot(snapshot, "key").has_value());
+
+                auto other = libsolv::Database({}, { matchspec_parser });
+                SECTION("Restore")
+                {
+                    const auto repos = other.add_repos_from_snapshot(snapshot, "key");
+                    REQUIRE(repos.has_value());
+                    REQUIRE(repos->size() == 3);
+                    REQUIRE(other.repo_count() == 3);
+                    REQUIRE(other.package_count() == db.package_count());
+                    REQUIRE(other.installed_repo().has_value());
+                    REQUIRE(other.installed_repo()->name() == "repo1");
+                    REQUIRE(other.fingerprint() == db.fingerprint());
+                }
+
+                SECTION("Wrong key")
+                {
+                    REQUIRE_FALSE(other.add_repos_from_snapshot(snapshot, "other").has_value());
+                    REQUIRE(other.repo_count() == 0);
+                }
+
+                SECTION("Corrupted snapshot")
+                {
+                    {
+                        auto out = open_ofstream(snapshot);
+                        out << "mamba-database-snapshot\nnot a snapshot";
+                    }
+                    REQUIRE_FALSE(other.add_repos_from_snapshot(snapshot, "key").has_value());
+                    REQUIRE(other.repo_count() == 0);
+                }
+            }
+
             SECTION("Serialize repo")
             {
                 auto tmp_dir = TemporaryDirectory();
@@ -187,6 +262,28 @@ namespace
                         }
                     );
                     REQUIRE(count == 1);
+
+                    auto count_depending_on = [&](std::string_view spec)
+                    {
+                        std::size_t n = 0;
+                        db.for_each_package_depending_on(
+                            specs::MatchSpec::parse(spec).value(),
+                            [&](const auto&) { n++; }
+                        );
+                        return n;
+                    };
+                    REQUIRE(count_depending_on("y") == 0);
+
+                    // The reverse dependency index follows the repositories
+                    auto repo3 = db.add_repo_from_packages(
+                        std::array{ mkpkg("w", "1.0", { "x" }), mkpkg("v", "1.0", { "y" }) },
+                        "repo3"
+                    );
+                    REQUIRE(count_depending_on("x") == 2);
+                    REQUIRE(count_depending_on("y") == 1);
+                    db.remove_repo(repo3);
+                    REQUIRE(count_depending_on("x") == 1);
+                    REQUIRE(count_depending_on("y") == 0);
                 }
             }
         }
@@ -0,0 +1,99 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <array>
+#include <variant>
+
+#include <catch2/catch_all.hpp>
+
+#include "mamba/core/util.hpp"
+#include "mamba/solver/libsolv/database.hpp"
+#include "mamba/solver/libsolv/solution_cache.hpp"
+#include "mamba/solver/libsolv/solver.hpp"
+#include "mamba/specs/match_spec.hpp"
+#include "mamba/specs/package_info.hpp"
+
+#include "mambatests.hpp"
+
+using namespace mamba;
+using namespace mamba::solver;
+
+namespace
+{
+    using namespace specs::match_spec_literals;
+
+    auto mkpkg(std::string name, std::string version) -> specs::PackageInfo
+    {
+        auto out = specs::PackageInfo(std::move(name));
+        out.version = std::move(version);
+        out.build_string = "0";
+        return out;
+    }
+
+    TEST_CASE("SolutionCache", "[mamba::solver][mamba::solver::libsolv]")
+    {
+        auto db = libsolv::Database({}, { libsolv::MatchSpecParser::Libsolv });
+        const auto repo = db.add_repo_from_repodata_json(
+            mambatests::test_data_dir / "repodata/conda-forge-numpy-linux-64.json",
+            "https://conda.anaconda.org/conda-forge/linux-64",
+            "conda-forge"
+        );
+        REQUIRE(repo.has_value());
+        auto installed = db.add_repo_from_packages(std::array{ mkpkg("foo", "1.0") }, "installed");
+        db.set_installed_repo(installed);
+
+        const auto request = Request{
+            /* .flags= */ {},
+            /* .jobs= */ { Request::Install{ "numpy"_ms }, Request::Remove{ "foo"_ms } },
+        };
+        const auto parser = libsolv::MatchSpecParser::Mixed;
+        const auto outcome = libsolv::Solver().solve(db, request, parser);
+        REQUIRE(outcome.has_value());
+        REQUIRE(std::holds_alternative<Solution>(outcome.value()));
+        const auto& solution = std::get<Solution>(outcome.value());
+
+        auto tmp_dir = TemporaryDirectory();
+        const auto cache = libsolv::SolutionCache(tmp_dir.path() / "solutions");
+        const auto key = libsolv::SolutionCache::key(db, request, parser);
+        CHECK(key == libsolv::SolutionCache::key(db, request, parser));
+        CHECK_FALSE(cache.load(db, key).has_value());
+
+        cache.store(key, solution);
+
+        SECTION("Hit")
+        {
+            const auto cached = cache.load(db, key);
+            REQUIRE(cached.has_value());
+            CHECK(cached.value() == solution);
+        }
+
+        SECTION("Different request")
+        {
+            auto other = request;
+            other.flags.allow_downgrade = false;
+            CHECK(libsolv::SolutionCache::key(db, other, parser) != key);
+            other = Request{ {}, { Request::Install{ "numpy>=1"_ms } } };
+            CHECK(libsolv::SolutionCache::key(db, other, parser) != key);
+            CHECK(libsolv::SolutionCache::key(db, request, libsolv::MatchSpecParser::Mamba) != key);
+        }
+
+        SECTION("Different installed packages")
+        {
+            db.remove_repo(installed);
+            installed = db.add_repo_from_packages(std::array{ mkpkg("foo", "2.0") }, "installed");
+            db.set_installed_repo(installed);
+            CHECK(libsolv::SolutionCache::key(db, request, parser) != key);
+            // The removed package is no longer in the database
+            CHECK_FALSE(cache.load(db, key).has_value());
+        }
+
+        SECTION("Different priorities")
+        {
+            db.set_repo_priority(repo.value(), { /* .priority= */ 1, /* .subpriority= */ 0 });
+            CHECK(libsolv::SolutionCache::key(db, request, parser) != key);
+        }
+    }
+}
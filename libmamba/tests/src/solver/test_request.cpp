@@ -5,8 +5,10 @@
 // The full license is in the file LICENSE, distributed with this software.
 
 #include <type_traits>
+#include <variant>
 
 #include <catch2/catch_all.hpp>
+#include <nlohmann/json.hpp>
 
 #include "mamba/solver/request.hpp"
 #include "mamba/specs/match_spec.hpp"
@@ -77,4 +79,38 @@ namespace
             REQUIRE(count_install == 1);
         }
     }
+
+    TEST_CASE("Request JSON round trip", "[mamba::solver]")
+    {
+        auto request = Request{
+            {},
+            {
+                Request::Install{ "a>1.2"_ms },
+                Request::Remove{ "b>1.2"_ms, false },
+                Request::Update{ "c"_ms, true },
+                Request::UpdateAll{ false },
+                Request::Keep{ "d"_ms },
+                Request::Freeze{ "e"_ms },
+                Request::Pin{ "conda-forge::f=1.0"_ms },
+            },
+        };
+        request.flags.force_reinstall = true;
+        request.flags.strict_repo_priority = false;
+
+        const auto j = nlohmann::json(request);
+        REQUIRE(j["jobs"].size() == request.jobs.size());
+        CHECK(j["jobs"][1]["type"] == "remove");
+
+        const auto parsed = j.get<Request>();
+        CHECK(parsed.flags.force_reinstall);
+        CHECK_FALSE(parsed.flags.strict_repo_priority);
+        REQUIRE(parsed.jobs.size() == request.jobs.size());
+        CHECK(std::get<Request::Remove>(parsed.jobs[1]).spec == "b>1.2"_ms);
+        CHECK_FALSE(std::get<Request::Remove>(parsed.jobs[1]).clean_dependencies);
+        CHECK_FALSE(std::get<Request::UpdateAll>(parsed.jobs[3]).clean_dependencies);
+        CHECK(std::get<Request::Pin>(parsed.jobs[6]).spec == "conda-forge::f=1.0"_ms);
+        CHECK(nlohmann::json(parsed) == j);
+
+        CHECK_THROWS(nlohmann::json::parse(R"({"flags": {}, "jobs": []})").get<Request>());
+    }
 }
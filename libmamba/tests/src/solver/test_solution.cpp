@@ -5,6 +5,7 @@
 // The full license is in the file LICENSE, distributed with this software.
 
 #include <catch2/catch_all.hpp>
+#include <nlohmann/json.hpp>
 
 #include "mamba/solver/solution.hpp"
 #include "mamba/specs/package_info.hpp"
@@ -133,4 +134,25 @@ namespace
             }
         }
     }
+
+    TEST_CASE("Solution JSON round trip", "[mamba::solver]")
+    {
+        const auto solution = Solution{ {
+            Solution::Omit{ PackageInfo("omit") },
+            Solution::Upgrade{ PackageInfo("upgrade_remove"), PackageInfo("upgrade_install") },
+            Solution::Downgrade{ PackageInfo("downgrade_remove"), PackageInfo("downgrade_install") },
+            Solution::Change{ PackageInfo("change_remove"), PackageInfo("change_install") },
+            Solution::Reinstall{ PackageInfo("reinstall") },
+            Solution::Remove{ PackageInfo("remove") },
+            Solution::Install{ PackageInfo("install") },
+        } };
+
+        const auto j = nlohmann::json(solution);
+        REQUIRE(j.is_array());
+        CHECK(j.size() == solution.actions.size());
+        CHECK(j[1]["type"] == "upgrade");
+        CHECK(j.get<Solution>() == solution);
+
+        CHECK_THROWS(nlohmann::json::parse(R"([{"type": "explode"}])").get<Solution>());
+    }
 }
@@ -0,0 +1,146 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <array>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_all.hpp>
+
+#include "mamba/specs/compiled_version_spec.hpp"
+
+using namespace mamba::specs;
+
+namespace
+{
+    using namespace mamba::specs::version_literals;
+    using namespace mamba::specs::version_spec_literals;
+
+    constexpr auto versions_strs = std::array<std::string_view, 44>{
+        "0",        "0.0",       "0.0.1",     "0.1",      "0.1dev",   "0.4",       "0.4.0",
+        "0.4.1.rc", "0.4.1",     "0.5a1",     "0.5b3",    "0.5",      "0.9.6",     "0.960923",
+        "1dev.2",   "1.0dev",    "1.0_",      "1.0a",     "1.0",      "1.0.0",     "1.0post",
+        "1.0.4a3",  "1.0.4b1",   "1.0.4",     "1.1dev1",  "1.1a1",    "1.1.0dev1", "1.1.0post1",
+        "1.1",      "1.1.1",     "1.2",       "1.2.0",    "1.2+abc",  "1.2+abc.1", "1.2.3",
+        "1.2.3.4",  "1.3",       "2.0",       "2.1",      "1!0.1",    "1!1.2",     "1!2.0",
+        "2!1.0",    "20240101",
+    };
+
+    auto all_versions() -> std::vector<Version>
+    {
+        auto out = std::vector<Version>();
+        for (const auto& str : versions_strs)
+        {
+            out.push_back(Version::parse(str).value());
+        }
+        return out;
+    }
+
+    TEST_CASE("version_key", "[mamba::specs][mamba::specs::CompiledVersionSpec]")
+    {
+        const auto versions = all_versions();
+        for (const auto& lhs : versions)
+        {
+            for (const auto& rhs : versions)
+            {
+                CAPTURE(lhs.to_string(), rhs.to_string());
+                const auto lhs_key = version_key(lhs);
+                const auto rhs_key = version_key(rhs);
+                CHECK((lhs < rhs) == (lhs_key < rhs_key));
+                CHECK((lhs == rhs) == (lhs_key == rhs_key));
+            }
+        }
+
+        CHECK(version_key("1.0"_v) == version_key("1.0.0.0"_v));
+        CHECK(version_key("1.0dev"_v) < version_key("1.0"_v));
+        CHECK(version_key("1.0"_v) < version_key("1.0post"_v));
+        CHECK(version_key("1.0a"_v) < version_key("1.0b"_v));
+    }
+
+    TEST_CASE("CompiledVersionSpec", "[mamba::specs][mamba::specs::CompiledVersionSpec]")
+    {
+        const auto versions = all_versions();
+
+        SECTION("Same as VersionSpec")
+        {
+            constexpr auto specs_strs = std::array{
+                "*",
+                "==1.0",
+                "!=1.0",
+                ">1.0",
+                ">=1.0",
+                "<1.0",
+                "<=1.0",
+                ">=1.0,<2.0",
+                "<0.5|>=1.2,<1.3",
+                "(>=0.4,<1.0)|(>1.1,!=1.2.3,<2.0)",
+                "=1.2",
+                "=1.0",
+                "=0.4",
+                "=1",
+                "=0",
+                "!=1.2.*",
+                "~=1.0.4",
+                "~=1.1",
+                "~=0.4.0",
+                "1.*.3",
+                "!=1.*.3",
+                "=1!1.2",
+                ">=1!0,<1!2",
+                "(=1.2|=1.0),!=1.2.3",
+                ">=1.0,(=1.2|<0.5)",
+                "1.2+abc",
+                "=1.2+abc",
+            };
+
+            for (const auto& str : specs_strs)
+            {
+                const auto spec = VersionSpec::parse(str).value();
+                const auto compiled = CompiledVersionSpec(spec);
+                auto expected_indices = std::vector<std::size_t>();
+                for (std::size_t i = 0; i < versions.size(); ++i)
+                {
+                    CAPTURE(str, versions[i].to_string());
+                    const auto expected = spec.contains(versions[i]);
+                    CHECK(compiled.contains(versions[i]) == expected);
+                    if (!compiled.may_contain(version_key(versions[i])))
+                    {
+                        CHECK_FALSE(expected);
+                    }
+                    if (expected)
+                    {
+                        expected_indices.push_back(i);
+                    }
+                }
+                CAPTURE(str);
+                CHECK(compiled.matching_indices(versions) == expected_indices);
+            }
+        }
+
+        SECTION("Exact compilation")
+        {
+            CHECK(CompiledVersionSpec(">=1.0,<2.0|==3.0"_vs).is_exact());
+            CHECK(CompiledVersionSpec(">=1.0,<2.0|==3.0"_vs).interval_count() == 2);
+            CHECK(CompiledVersionSpec(">=1.0,<2.0,>=3.0"_vs).interval_count() == 0);
+            CHECK(CompiledVersionSpec(">=1.0|<2.0"_vs).interval_count() == 1);
+            CHECK(CompiledVersionSpec("!=1.0"_vs).interval_count() == 2);
+            CHECK(CompiledVersionSpec("*"_vs).is_exact());
+            CHECK_FALSE(CompiledVersionSpec("=1.2"_vs).is_exact());
+            // Only the starts with part is evaluated
+            CHECK(CompiledVersionSpec("=1.2,<0.5"_vs).is_exact());
+        }
+
+        SECTION("Cache")
+        {
+            const auto compiled = CompiledVersionSpec::parse_cached(">=1.0,<2.0");
+            REQUIRE(compiled.has_value());
+            CHECK(compiled.value() == CompiledVersionSpec::parse_cached(">=1.0,<2.0").value());
+            CHECK(compiled.value() == CompiledVersionSpec::compile_cached(">=1.0,<2.0"_vs));
+            CHECK(compiled.value()->spec() == ">=1.0,<2.0"_vs);
+            CHECK_FALSE(CompiledVersionSpec::parse_cached(">=1.0,<").has_value());
+        }
+    }
+}
@@ -4,6 +4,10 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <array>
+#include <regex>
+#include <string_view>
+
 #include <catch2/catch_all.hpp>
 
 #include "mamba/specs/regex_spec.hpp"
@@ -96,4 +100,78 @@ namespace
         REQUIRE(spec.contains("py3.10_cuda11.8_cudnn8.7.0_0"));
     }
 
+    TEST_CASE("RegexSpec ^(?!.*cpu).*$")
+    {
+        auto spec = RegexSpec::parse("^(?!.*cpu).*$").value();
+
+        REQUIRE(spec.contains("cuda112py310h0123456_0"));
+        REQUIRE(spec.contains(""));
+        REQUIRE_FALSE(spec.contains("cpu_py310h0123456_0"));
+        REQUIRE_FALSE(spec.contains("py310_cpu"));
+    }
+
+    TEST_CASE("RegexSpec same as std::regex")
+    {
+        constexpr auto patterns = std::array<std::string_view, 24>{
+            "*",
+            "py312*",
+            "*cuda*",
+            "*_cuda*_*",
+            "py3.10_cuda11.8*",
+            "^py3\\.10.*$",
+            "^.*(accelerate|mkl)$",
+            "^(?!.*cpu).*$",
+            "^(?!.*cpu$).*$",
+            "^(?!cpu|mkl)py.*$",
+            "^(?!.*cpu)(?!.*mkl).*_0$",
+            "^py[0-9]+h[0-9a-f]*_[0-9]$",
+            "^py3(9|10|11)[^_]*_\\d+$",
+            "^[\\w.]+$",
+            "^(cuda|cpu)?_?py3.*$",
+            "^(?:a|b)*c+d?$",
+            "^a.*?b$",
+            "^.*_(1|2)$",
+            "^[-a]+$",
+            "^[a-]+$",
+            "^\\*.*$",
+            "^py3{1,2}$",
+            "^(a)\\1$",
+            "^[[:digit:]]+$",
+        };
+        constexpr auto strs = std::array<std::string_view, 20>{
+            "",
+            "py312h0123456_0",
+            "py311h0123456_0",
+            "py310_cuda11.8_cudnn8.7.0_0",
+            "py3.10_cuda11.8_cudnn8.7.0_0",
+            "py3x10_cuda11.8_cudnn8.7.0_0",
+            "cuda112py310h0123456_0",
+            "cpu_py310h0123456_0",
+            "py310_cpu",
+            "mkl",
+            "accelerate",
+            "openblas",
+            "abababcd",
+            "ab",
+            "a-a-",
+            "*py",
+            "py33",
+            "aa",
+            "123",
+            "py3.10_cuda\n11.8",
+        };
+
+        for (const auto& pattern : patterns)
+        {
+            auto spec = RegexSpec::parse(std::string(pattern)).value();
+            const auto regex = std::regex(spec.to_string());
+            for (const auto& str : strs)
+            {
+                CAPTURE(pattern, str);
+                CHECK(spec.contains(str) == std::regex_match(str.cbegin(), str.cend(), regex));
+            }
+        }
+
+        REQUIRE_FALSE(RegexSpec::parse("^py(3$").has_value());
+    }
 }
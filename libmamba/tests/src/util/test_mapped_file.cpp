@@ -0,0 +1,57 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <fstream>
+#include <string>
+#include <utility>
+
+#include <catch2/catch_all.hpp>
+
+#include "mamba/core/util.hpp"
+#include "mamba/util/mapped_file.hpp"
+
+using namespace mamba::util;
+
+namespace
+{
+    TEST_CASE("MappedFile")
+    {
+        SECTION("File content")
+        {
+            auto tmp = mamba::TemporaryFile();
+            const auto content = std::string("Hello\0mapped world\n", 19);
+            {
+                auto file = std::ofstream(tmp.path().std_path(), std::ios::binary);
+                file << content;
+            }
+
+            auto mapped = MappedFile::try_open(tmp.path());
+            REQUIRE(mapped.has_value());
+            CHECK(mapped->size() == content.size());
+            CHECK(mapped->view() == content);
+
+            auto moved = std::move(mapped).value();
+            CHECK(moved.view() == content);
+        }
+
+        SECTION("Empty file")
+        {
+            auto tmp = mamba::TemporaryFile();
+            auto mapped = MappedFile::try_open(tmp.path());
+            REQUIRE(mapped.has_value());
+            CHECK(mapped->size() == 0);
+            CHECK(mapped->view().empty());
+        }
+
+        SECTION("Missing file")
+        {
+            auto tmp = mamba::TemporaryDirectory();
+            auto mapped = MappedFile::try_open(tmp.path() / "does-not-exist");
+            REQUIRE_FALSE(mapped.has_value());
+            CHECK(mapped.error() == std::errc::no_such_file_or_directory);
+        }
+    }
+}
@@ -425,5 +425,11 @@ namespace
         REQUIRE_FALSE(glob_match("**37", "python37-linux64"));
         REQUIRE(glob_match("**py**", "python"));
         REQUIRE_FALSE(glob_match("**py**", "linux"));
+
+        REQUIRE(glob_match("*ab", "abab"));
+        REQUIRE(glob_match("a*a", "aa"));
+        REQUIRE_FALSE(glob_match("a*a", "a"));
+        REQUIRE(glob_match("*a*b*a*", "xaybza"));
+        REQUIRE_FALSE(glob_match("*a*b*a*", "xaybz"));
     }
 }
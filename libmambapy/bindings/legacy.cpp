@@ -542,15 +542,19 @@ bind_submodule_impl(pybind11::module_ m)
         &load_subdir_in_database,
         py::arg("context"),
         py::arg("database"),
-        py::arg("subdir")
+        py::arg("subdir"),
+        py::call_guard<py::gil_scoped_release>()
     );
 
     m.def(
         "load_installed_packages_in_database",
-        &load_installed_packages_in_database,
+        py::overload_cast<const Context&, solver::libsolv::Database&, const PrefixData&>(
+            &load_installed_packages_in_database
+        ),
         py::arg("context"),
         py::arg("database"),
-        py::arg("prefix_data")
+        py::arg("prefix_data"),
+        py::call_guard<py::gil_scoped_release>()
     );
 
     py::class_<MultiPackageCache>(m, "MultiPackageCache")
@@ -586,9 +590,13 @@ bind_submodule_impl(pybind11::module_ m)
         .def("to_conda", &MTransaction::to_conda)
         .def("log_json", &MTransaction::log_json)
         .def("print", &MTransaction::print)
-        .def("fetch_extract_packages", &MTransaction::fetch_extract_packages)
+        .def(
+            "fetch_extract_packages",
+            &MTransaction::fetch_extract_packages,
+            py::call_guard<py::gil_scoped_release>()
+        )
         .def("prompt", &MTransaction::prompt)
-        .def("execute", &MTransaction::execute);
+        .def("execute", &MTransaction::execute, py::call_guard<py::gil_scoped_release>());
 
     py::class_<History>(m, "History")
         .def(
@@ -711,6 +719,8 @@ bind_submodule_impl(pybind11::module_ m)
                 {
                     subdirs.push_back(py::cast<SubdirIndexLoader*>(item));
                 }
+
+                py::gil_scoped_release release;
                 return SubdirIndexLoader::download_required_indexes(
                     subdirs,
                     subdir_download_params,
@@ -865,7 +875,7 @@ bind_submodule_impl(pybind11::module_ m)
             py::arg("repodata_fn"),
             py::arg("url")
         )
-        .def("download", &SubdirIndex::download)
+        .def("download", &SubdirIndex::download, py::call_guard<py::gil_scoped_release>())
         .def("__len__", &SubdirIndex::size)
         .def("__getitem__", &SubdirIndex::operator[])
         .def(
@@ -1141,6 +1151,7 @@ bind_submodule_impl(pybind11::module_ m)
                    bool always_copy,
                    bool always_softlink,
                    bool compile_pyc,
+                   bool pyc_cache,
                    bool skip_run_link_scripts) -> LinkParams
                 {
                     return {
@@ -1148,6 +1159,7 @@ bind_submodule_impl(pybind11::module_ m)
                         .always_copy = always_copy,
                         .always_softlink = always_softlink,
                         .compile_pyc = compile_pyc,
+                        .pyc_cache = pyc_cache,
                         .skip_run_link_scripts = skip_run_link_scripts,
                     };
                 }
@@ -1156,12 +1168,14 @@ bind_submodule_impl(pybind11::module_ m)
             py::arg("always_copy") = default_link_params.always_copy,
             py::arg("always_softlink") = default_link_params.always_softlink,
             py::arg("compile_pyc") = default_link_params.compile_pyc,
+            py::arg("pyc_cache") = default_link_params.pyc_cache,
             py::arg("skip_run_link_scripts") = default_link_params.skip_run_link_scripts
         )
         .def_readwrite("allow_softlinks", &LinkParams::allow_softlinks)
         .def_readwrite("always_copy", &LinkParams::always_copy)
         .def_readwrite("always_softlink", &LinkParams::always_softlink)
         .def_readwrite("compile_pyc", &LinkParams::compile_pyc)
+        .def_readwrite("pyc_cache", &LinkParams::pyc_cache)
         .def_readwrite("skip_run_link_scripts", &LinkParams::skip_run_link_scripts);
 
     static const auto default_validation_params = ValidationParams{};
@@ -4,7 +4,7 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
-#include <ranges>
+#include <vector>
 
 #include <pybind11/functional.h>
 #include <pybind11/operators.h>
@@ -161,6 +161,7 @@ namespace mambapy
                 py::arg("exclude_newer_timestamp") = py::none()
             )
             .def("set_logger", &Database::set_logger, py::call_guard<py::gil_scoped_acquire>())
+            .def("clone", &Database::clone, py::call_guard<py::gil_scoped_release>())
             .def(
                 "add_repo_from_repodata_json",
                 &Database::add_repo_from_repodata_json,
@@ -170,7 +171,8 @@ namespace mambapy
                 py::arg("add_pip_as_python_dependency") = PipAsPythonDependency::No,
                 py::arg("package_types") = PackageTypes::CondaOrElseTarBz2,
                 py::arg("verify_packages") = VerifyPackages::No,
-                py::arg("repodata_parser") = RepodataParser::Mamba
+                py::arg("repodata_parser") = RepodataParser::Mamba,
+                py::call_guard<py::gil_scoped_release>()
             )
             .def(
                 "add_repo_from_native_serialization",
@@ -178,7 +180,8 @@ namespace mambapy
                 py::arg("path"),
                 py::arg("expected"),
                 py::arg("channel_id"),
-                py::arg("add_pip_as_python_dependency") = PipAsPythonDependency::No
+                py::arg("add_pip_as_python_dependency") = PipAsPythonDependency::No,
+                py::call_guard<py::gil_scoped_release>()
             )
             .def(
                 "add_repo_from_packages",
@@ -187,14 +190,16 @@ namespace mambapy
                    std::string_view name,
                    PipAsPythonDependency add)
                 {
-                    static constexpr auto cast = [](py::handle pkg)
-                    { return pkg.cast<specs::PackageInfo>(); };
+                    // Python objects are converted while holding the GIL
+                    auto pkgs = std::vector<specs::PackageInfo>();
+                    pkgs.reserve(py::len_hint(packages));
+                    for (py::handle pkg : packages)
+                    {
+                        pkgs.push_back(pkg.cast<specs::PackageInfo>());
+                    }
 
-                    return database.add_repo_from_packages(
-                        packages | std::ranges::views::transform(cast),
-                        name,
-                        add
-                    );
+                    py::gil_scoped_release release;
+                    return database.add_repo_from_packages(pkgs, name, add);
                 },
                 py::arg("packages"),
                 py::arg("name") = "",
@@ -205,7 +210,8 @@ namespace mambapy
                 &Database::native_serialize_repo,
                 py::arg("repo"),
                 py::arg("path"),
-                py::arg("metadata")
+                py::arg("metadata"),
+                py::call_guard<py::gil_scoped_release>()
             )
             .def("set_installed_repo", &Database::set_installed_repo, py::arg("repo"))
             .def("installed_repo", &Database::installed_repo)
@@ -288,7 +294,8 @@ namespace mambapy
                    MatchSpecParser ms_parser) { return self.solve(database, request, ms_parser); },
                 py::arg("database"),
                 py::arg("request"),
-                py::arg("matchspec_parser") = MatchSpecParser::Mixed
+                py::arg("matchspec_parser") = MatchSpecParser::Mixed,
+                py::call_guard<py::gil_scoped_release>()
             )
             .def("add_jobs", solver_job_v2_migrator)
             .def("add_global_job", solver_job_v2_migrator)
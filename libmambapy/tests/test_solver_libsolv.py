@@ -1,3 +1,4 @@
+import concurrent.futures
 import copy
 import json
 
@@ -182,6 +183,30 @@ def test_Database_RepoInfo_from_packages(add_pip_as_python_dependency, matchspec
     assert db.installed_repo() is None
 
 
+def test_Database_clone():
+    db = libsolv.Database(libmambapy.specs.ChannelResolveParams())
+    repo = db.add_repo_from_packages(
+        [
+            libmambapy.specs.PackageInfo(name="python", version="3.0"),
+            libmambapy.specs.PackageInfo(name="pip", version="24.0"),
+        ],
+        name="duck",
+    )
+    db.set_installed_repo(repo)
+    db.set_repo_priority(repo, libsolv.Priorities(2, 3))
+
+    other = db.clone()
+    assert other.repo_count() == 1
+    assert other.package_count() == 2
+    other_repo = other.installed_repo()
+    assert other_repo.name == "duck"
+    assert other_repo.priority == libsolv.Priorities(2, 3)
+
+    db.remove_repo(repo)
+    assert db.package_count() == 0
+    assert other.package_count() == 2
+
+
 def test_Database_exclude_newer_timestamp_filters_packages():
     cutoff = 2000
     db = libsolv.Database(
@@ -417,3 +442,26 @@ def test_Solver_Solution():
 
     assert isinstance(outcome, libmambapy.solver.Solution)
     assert len(outcome.actions) == 1
+
+
+def test_Solver_concurrent_solves():
+    Request = libmambapy.solver.Request
+
+    db = libsolv.Database(libmambapy.specs.ChannelResolveParams())
+    db.add_repo_from_packages(
+        [
+            libmambapy.specs.PackageInfo(name="foo", version="1.0", depends=["bar"]),
+            libmambapy.specs.PackageInfo(name="bar", version="1.0"),
+        ],
+    )
+    request = Request([Request.Install(libmambapy.specs.MatchSpec.parse("foo"))])
+
+    def solve(database):
+        return libsolv.Solver().solve(database, request)
+
+    with concurrent.futures.ThreadPoolExecutor(max_workers=4) as executor:
+        outcomes = list(executor.map(solve, [db.clone() for _ in range(4)]))
+
+    for outcome in outcomes:
+        assert isinstance(outcome, libmambapy.solver.Solution)
+        assert len(outcome.actions) == 2
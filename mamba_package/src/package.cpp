@@ -83,21 +83,10 @@ set_package_command(CLI::App* com, mamba::Context& context)
     transmute_subcom->callback(
         [&]()
         {
-            if (util::ends_with(infile, ".tar.bz2"))
+            dest = transmute_target(infile).string();
+            if (compression_level == -1)
             {
-                if (compression_level == -1)
-                {
-                    compression_level = 15;
-                }
-                dest = infile.substr(0, infile.size() - 8) + ".conda";
-            }
-            else
-            {
-                if (compression_level == -1)
-                {
-                    compression_level = 9;
-                }
-                dest = infile.substr(0, infile.size() - 8) + ".tar.bz2";
+                compression_level = util::ends_with(dest, ".conda") ? 15 : 9;
             }
             std::cout << "Transmuting " << fs::absolute(infile) << " to " << dest << std::endl;
             transmute(
@@ -50,6 +50,14 @@ init_clean_parser(CLI::App* subcom, Configuration& config)
             )
     );
 
+    auto& clean_move_to_trash = config.insert(
+        Configurable("clean_move_to_trash", false)
+            .group("cli")
+            .description(
+                "Remove unused package folders in the background, after moving them to a trash"
+            )
+    );
+
     subcom->add_flag("-a,--all", clean_all.get_cli_config<bool>(), clean_all.description());
     subcom->add_flag("-i,--index-cache", clean_index.get_cli_config<bool>(), clean_index.description());
     subcom->add_flag("-p,--packages", clean_pkgs.get_cli_config<bool>(), clean_pkgs.description());
@@ -65,6 +73,11 @@ init_clean_parser(CLI::App* subcom, Configuration& config)
         clean_force_pkgs_dirs.get_cli_config<bool>(),
         clean_force_pkgs_dirs.description()
     );
+    subcom->add_flag(
+        "--move-to-trash",
+        clean_move_to_trash.get_cli_config<bool>(),
+        clean_move_to_trash.description()
+    );
 }
 
 void
@@ -109,6 +122,10 @@ set_clean_command(CLI::App* subcom, Configuration& config)
                     options = options | MAMBA_CLEAN_FORCE_PKGS_DIRS;
                 }
             }
+            if (config.at("clean_move_to_trash").compute().value<bool>())
+            {
+                options = options | MAMBA_CLEAN_MOVE_TO_TRASH;
+            }
 
             clean(config, options);
         }
@@ -4,6 +4,14 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
 #include <CLI/App.hpp>
 
 #include "constructor.hpp"
@@ -11,12 +19,85 @@
 #include "mamba/api/install.hpp"
 #include "mamba/core/package_handling.hpp"
 #include "mamba/core/subdir_index.hpp"
+#include "mamba/core/thread_utils.hpp"
 #include "mamba/core/util.hpp"
 #include "mamba/util/string.hpp"
 
 
 using namespace mamba;  // NOLINT(build/namespaces)
 
+namespace
+{
+    /**
+     * Extract the package tarballs on up to ``extract_threads`` threads.
+     *
+     * As in the package fetcher, packages are extracted in subprocesses when more than one
+     * thread is used, since in-process extraction changes the working directory.
+     *
+     * @return The extraction directory of each tarball.
+     */
+    auto extract_packages(const Context& context, const std::vector<fs::u8path>& tarballs)
+        -> std::vector<fs::u8path>
+    {
+        const auto options = ExtractOptions::from_context(context);
+        const std::size_t n_threads = std::min(
+            normalize_to_affinity_concurrency(context.threads_params.extract_threads),
+            tarballs.size()
+        );
+
+        auto base_paths = std::vector<fs::u8path>(tarballs.size());
+        auto next = std::atomic<std::size_t>(0);
+        auto mutex = std::mutex();
+        auto error = std::exception_ptr();
+
+        const auto worker = [&]
+        {
+            for (std::size_t i = next++; i < tarballs.size(); i = next++)
+            {
+                {
+                    auto lock = std::lock_guard(mutex);
+                    if (error)
+                    {
+                        return;
+                    }
+                    LOG_TRACE << "Extracting " << tarballs[i].filename() << std::endl;
+                    std::cout << "Extracting " << tarballs[i].filename().string() << std::endl;
+                }
+                try
+                {
+                    base_paths[i] = (n_threads > 1) ? extract_subproc(tarballs[i], options)
+                                                    : extract(tarballs[i], options);
+                }
+                catch (...)
+                {
+                    auto lock = std::lock_guard(mutex);
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                    return;
+                }
+            }
+        };
+
+        auto threads = std::vector<std::thread>();
+        for (std::size_t t = 1; t < n_threads; ++t)
+        {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+        return base_paths;
+    }
+}
+
 void
 init_constructor_parser(CLI::App* subcom, Configuration& config)
 {
@@ -104,17 +185,24 @@ construct(Configuration& config, const fs::u8path& prefix, bool extract_conda_pk
         fs::u8path pkgs_dir = prefix / "pkgs";
         fs::u8path urls_file = pkgs_dir / "urls";
 
+        std::vector<specs::PackageInfo> pkg_infos;
+        std::vector<fs::u8path> entries;
         for (const auto& raw_url : read_lines(urls_file))
         {
             auto pkg_info = specs::PackageInfo::from_url(raw_url)
                                 .or_else([](specs::ParseError&& err) { throw std::move(err); })
                                 .value();
+            entries.push_back(pkgs_dir / pkg_info.filename);
+            pkg_infos.push_back(std::move(pkg_info));
+        }
 
-            fs::u8path entry = pkgs_dir / pkg_info.filename;
-            LOG_TRACE << "Extracting " << pkg_info.filename << std::endl;
-            std::cout << "Extracting " << pkg_info.filename << std::endl;
+        const auto base_paths = extract_packages(config.context(), entries);
 
-            fs::u8path base_path = extract(entry, ExtractOptions::from_context(config.context()));
+        for (std::size_t i = 0; i < pkg_infos.size(); ++i)
+        {
+            const auto& pkg_info = pkg_infos[i];
+            const fs::u8path& entry = entries[i];
+            const fs::u8path& base_path = base_paths[i];
 
             fs::u8path repodata_record_path = base_path / "info" / "repodata_record.json";
             fs::u8path index_path = base_path / "info" / "index.json";
@@ -210,34 +298,13 @@ construct(Configuration& config, const fs::u8path& prefix, bool extract_conda_pk
 
     if (extract_tarball)
     {
-        fs::u8path extract_tarball_path = prefix / "_tmp.tar.bz2";
-        read_binary_from_stdin_and_write_to_file(extract_tarball_path);
-        extract_archive(extract_tarball_path, prefix, ExtractOptions::from_context(config.context()));
-        fs::remove(extract_tarball_path);
-    }
-}
-
-void
-read_binary_from_stdin_and_write_to_file(fs::u8path& filename)
-{
-    std::ofstream out_stream = open_ofstream(filename, std::ofstream::binary);
-    FILE* stdin_bin;
-    // Need to reopen stdin as binary
-    stdin_bin = std::freopen(nullptr, "rb", stdin);
-    if (std::ferror(stdin_bin))
-    {
-        throw std::runtime_error("Re-opening stdin as binary failed.");
-    }
-    std::size_t len;
-    std::array<char, 1024> buffer;
-
-    while ((len = std::fread(buffer.data(), sizeof(char), buffer.size(), stdin_bin)) > 0)
-    {
-        if (std::ferror(stdin_bin) && !std::feof(stdin_bin))
+        // Need to reopen stdin as binary
+        std::FILE* stdin_bin = std::freopen(nullptr, "rb", stdin);
+        if ((stdin_bin == nullptr) || std::ferror(stdin_bin))
         {
-            throw std::runtime_error("Reading from stdin failed.");
+            throw std::runtime_error("Re-opening stdin as binary failed.");
         }
-        out_stream.write(buffer.data(), static_cast<std::streamsize>(len));
+        // Streamed, without writing the tarball to disk first
+        extract_archive(stdin_bin, prefix, ExtractOptions::from_context(config.context()));
     }
-    out_stream.close();
 }
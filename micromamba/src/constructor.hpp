@@ -23,7 +23,4 @@ construct(
     bool extract_tarball
 );
 
-void
-read_binary_from_stdin_and_write_to_file(mamba::fs::u8path& filename);
-
 #endif
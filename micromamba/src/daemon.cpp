@@ -0,0 +1,54 @@
+// Copyright (c) 2026, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <chrono>
+#include <string>
+
+#include "mamba/api/configuration.hpp"
+#include "mamba/api/daemon.hpp"
+
+#include "common_options.hpp"
+#include "umamba.hpp"
+
+void
+set_daemon_command(CLI::App* subcom, mamba::Configuration& config)
+{
+    init_general_options(subcom, config);
+    init_network_options(subcom, config);
+    init_channel_parser(subcom, config);
+
+    static std::string socket_path;
+    subcom
+        ->add_option(
+            "--socket",
+            socket_path,
+            "Socket to listen on (defaults to a per-user path that clients find automatically)"
+        )
+        ->option_text("PATH");
+
+    static int refresh_interval = 300;
+    subcom
+        ->add_option(
+            "--refresh-interval",
+            refresh_interval,
+            "Seconds between reloads of the channels repodata, using the index cache"
+        )
+        ->check(CLI::PositiveNumber)
+        ->option_text("SECONDS");
+
+    subcom->callback(
+        [&]()
+        {
+            mamba::run_daemon(
+                config,
+                {
+                    /* .socket_path= */ socket_path,
+                    /* .refresh_interval= */ std::chrono::seconds(refresh_interval),
+                }
+            );
+        }
+    );
+}
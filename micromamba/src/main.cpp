@@ -22,6 +22,7 @@
 #include "mamba/api/configuration.hpp"
 #include "mamba/core/context.hpp"
 #include "mamba/core/execution.hpp"
+#include "mamba/core/logging_tools.hpp"
 #include "mamba/core/output.hpp"
 #include "mamba/core/thread_utils.hpp"
 #include "mamba/core/util_os.hpp"
@@ -80,7 +81,8 @@ decide_log_handler(const ContextOptions& options) -> mamba::logging::AnyLogHandl
         return {};
     }
 
-    return mamba::logging::spdlogimpl::LogHandler_spdlog{};
+    // Formatting and writing the verbose logs is done by a background thread
+    return mamba::logging::LogHandler_Async{ mamba::logging::spdlogimpl::LogHandler_spdlog{} };
 }
 
 int
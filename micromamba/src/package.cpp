@@ -4,8 +4,11 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <fmt/format.h>
+
 #include "mamba/api/configuration.hpp"
 #include "mamba/core/package_handling.hpp"
+#include "mamba/core/thread_utils.hpp"
 #include "mamba/util/string.hpp"
 
 #include "common_options.hpp"
@@ -16,8 +19,10 @@ void
 set_package_command(CLI::App* subcom, Configuration& config)
 {
     static std::string infile, dest;
+    static std::vector<std::string> infiles;
     static int compression_level = -1;
     static int compression_threads = 1;
+    static std::size_t jobs = 0;
 
     init_general_options(subcom, config);
 
@@ -89,7 +94,9 @@ set_package_command(CLI::App* subcom, Configuration& config)
 
     auto transmute_subcom = subcom->add_subcommand("transmute");
     init_general_options(transmute_subcom, config);
-    transmute_subcom->add_option("infile", infile, "Folder to compress")->option_text("FOLDER");
+    transmute_subcom->add_option("infile", infiles, "Packages to transmute")
+        ->option_text("PACKAGE")
+        ->required();
     transmute_subcom
         ->add_option(
             "-c,--compression-level",
@@ -97,44 +104,85 @@ set_package_command(CLI::App* subcom, Configuration& config)
             "Compression level from 0-9 (tar.bz2, default is 9), and 1-22 (conda, default is 15)"
         )
         ->option_text("COMP_LEVEL");
+    CLI::Option* compression_threads_option = transmute_subcom
+                                                  ->add_option(
+                                                      "--compression-threads",
+                                                      compression_threads,
+                                                      "Compression threads (only relevant for "
+                                                      ".conda packages, default is 1, or a share "
+                                                      "of --jobs for several packages)"
+                                                  )
+                                                  ->option_text("COMP_THREADS");
     transmute_subcom
         ->add_option(
-            "--compression-threads",
-            compression_threads,
-            "Compression threads (only relevant for .conda packages, default is 1)"
+            "-j,--jobs",
+            jobs,
+            "Threads shared between packages and compression when transmuting several packages "
+            "(default depends on the number of cores)"
         )
-        ->option_text("COMP_THREADS");
+        ->option_text("JOBS");
     transmute_subcom->callback(
-        [&]()
+        [&, compression_threads_option]()
         {
             // load verbose and other options to context
             config.load();
 
-            if (util::ends_with(infile, ".tar.bz2"))
+            if (infiles.size() == 1)
             {
+                infile = infiles.front();
+                dest = transmute_target(infile).string();
                 if (compression_level == -1)
                 {
-                    compression_level = 15;
+                    compression_level = util::ends_with(dest, ".conda") ? 15 : 9;
                 }
-                dest = infile.substr(0, infile.size() - 8) + ".conda";
+                Console::stream() << "Transmuting " << fs::absolute(infile) << " to " << dest
+                                  << std::endl;
+                transmute(
+                    fs::absolute(infile),
+                    fs::absolute(dest),
+                    compression_level,
+                    compression_threads,
+                    ExtractOptions::from_context(config.context())
+                );
+                return;
             }
-            else
+
+            std::vector<fs::u8path> pkg_files;
+            for (const auto& f : infiles)
             {
-                if (compression_level == -1)
-                {
-                    compression_level = 9;
-                }
-                dest = infile.substr(0, infile.size() - 6) + ".tar.bz2";
+                pkg_files.push_back(fs::absolute(f));
             }
-            Console::stream() << "Transmuting " << fs::absolute(infile) << " to " << dest
-                              << std::endl;
-            transmute(
-                fs::absolute(infile),
-                fs::absolute(dest),
+            const std::size_t n_threads = (jobs > 0) ? jobs : normalize_to_affinity_concurrency();
+            // Without an explicit value, the threads are balanced between the packages
+            const auto result = transmute_batch(
+                pkg_files,
                 compression_level,
-                compression_threads,
+                (compression_threads_option->count() > 0) ? compression_threads : 0,
+                n_threads,
                 ExtractOptions::from_context(config.context())
             );
+
+            for (const auto& [pkg_file, error] : result.failures)
+            {
+                LOG_ERROR << "Could not transmute " << pkg_file << ": " << error;
+            }
+            const double seconds = std::max(result.elapsed.count(), 1e-9);
+            Console::stream() << fmt::format(
+                "Transmuted {} packages in {:.2f}s ({:.1f} packages/s, {:.1f} MB/s, "
+                "{:.1f} MB -> {:.1f} MB)",
+                result.converted,
+                seconds,
+                static_cast<double>(result.converted) / seconds,
+                static_cast<double>(result.input_bytes) / 1e6 / seconds,
+                static_cast<double>(result.input_bytes) / 1e6,
+                static_cast<double>(result.output_bytes) / 1e6
+            ) << std::endl;
+            if (!result.failures.empty())
+            {
+                throw std::runtime_error(
+                    fmt::format("Could not transmute {} packages", result.failures.size())
+                );
+            }
         }
     );
 }
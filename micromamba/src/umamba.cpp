@@ -112,6 +112,12 @@ set_umamba_command(CLI::App* com, mamba::Configuration& config)
     CLI::App* auth_subcom = com->add_subcommand("auth", "Login or logout of a given host");
     set_auth_command(auth_subcom);
 
+    CLI::App* daemon_subcom = com->add_subcommand(
+        "daemon",
+        "Keep channels loaded in memory to serve repoquery, solve and dry-run requests"
+    );
+    set_daemon_command(daemon_subcom, config);
+
     CLI::App* search_subcom = com->add_subcommand(
         "search",
         "Find packages in active environment or channels\n"
@@ -43,6 +43,27 @@ def test_clean_all_removes_nested_package_cache_entries(tmp_home, tmp_root_prefi
     assert not extracted.exists()
 
 
+def test_clean_move_to_trash_nested_package_cache_entries(tmp_home, tmp_root_prefix):
+    pkgs_dir = tmp_home / "pkgs"
+    os.environ["CONDA_PKGS_DIRS"] = str(pkgs_dir)
+
+    channel_dir = pkgs_dir / "https" / "conda.anaconda.org" / "conda-forge" / "linux-64"
+    extracted = channel_dir / "xtensor-0.24.7-h2acdbc0_0"
+    (extracted / "info").mkdir(parents=True, exist_ok=True)
+    (extracted / "info" / "index.json").write_text("{}")
+    # Left over by an interrupted cleaning
+    leftover = pkgs_dir / ".trash" / "xtl-0.7.5-h4bd325d_0.abcdefgh"
+    leftover.mkdir(parents=True, exist_ok=True)
+
+    helpers.clean("--packages", "--move-to-trash", "--no-rc", no_dry_run=True)
+
+    assert not extracted.exists()
+    assert not leftover.exists()
+    # Trashed in the trash of the cache root, not of the channel subdirectory
+    assert not (channel_dir / ".trash").exists()
+    assert list((pkgs_dir / ".trash").iterdir()) == []
+
+
 def test_clean_all_clears_all_cache_kinds(tmp_home, tmp_root_prefix):
     pkgs_dir = tmp_home / "pkgs"
     os.environ["CONDA_PKGS_DIRS"] = str(pkgs_dir)
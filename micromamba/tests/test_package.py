@@ -193,3 +193,10 @@ def test_transmute(cph_test_file: Path, tmp_path: Path):
                             assert not m.name.startswith("info/")
                         assert m.uid == 0
                         assert m.gid == 0
+
+
+def test_transmute_requires_packages():
+    mamba_exe = helpers.get_umamba()
+    res = subprocess.run([mamba_exe, "package", "transmute"], capture_output=True)
+    assert res.returncode != 0
+    assert b"Transmuted" not in res.stdout
@@ -128,3 +128,19 @@ class TestRunVenv:
     def test_classic_specs(self, temp_env_prefix):
         res = umamba_run("-p", temp_env_prefix, "python", "-c", "import sys; print(sys.prefix)")
         assert res.strip() == temp_env_prefix
+
+    @pytest.mark.skipif(platform == "win32", reason="posix specific test")
+    def test_activated_environment(self, temp_env_prefix):
+        res = umamba_run(
+            "-p",
+            temp_env_prefix,
+            "-e",
+            "MAMBA_TEST_VAR=value",
+            "sh",
+            "-c",
+            'echo "$CONDA_PREFIX|$MAMBA_TEST_VAR|$PATH"',
+        )
+        conda_prefix, var, path = res.strip().split("|", 2)
+        assert conda_prefix == temp_env_prefix
+        assert var == "value"
+        assert path.split(":")[0] == os.path.join(temp_env_prefix, "bin")